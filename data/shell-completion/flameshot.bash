@@ -12,9 +12,9 @@ _flameshot() {
 	prev="${COMP_WORDS[COMP_CWORD-1]}"
 	cur="${COMP_WORDS[COMP_CWORD]}"
 	cmd="gui full config launcher screen"
-	screen_opts="--number -n --path -p --clipboard -c --delay -d --region --raw -r --upload -u --pin --help"
-	gui_opts="--path -p --clipboard -c --delay -d --region --last-region --raw -r --print-geometry -g --upload -u --pin --accept-on-select -s --help"
-	full_opts="--path -p --clipboard -c --delay -d --region --raw -r --upload -u --help"
+	screen_opts="--number -n --path -p --clipboard -c --delay -d --region --raw -r --raw-format --scale --max-width --upload -u --pin --help"
+	gui_opts="--path -p --clipboard -c --delay -d --region --last-region --raw -r --raw-format --scale --max-width --print-geometry -g --upload -u --pin --accept-on-select -s --help"
+	full_opts="--path -p --clipboard -c --delay -d --region --raw -r --raw-format --scale --max-width --upload -u --help"
 	config_opts="--autostart -a --filename -f --notifications -n --trayicon -t --showhelp -s --maincolor -m --contrastcolor -k --check"
 
 	case "${prev}" in
@@ -37,6 +37,10 @@ _flameshot() {
 			COMPREPLY=( $(compgen -W "$config_opts --help -h" -- "${cur}") )
 			return 0
 			;;
+		--raw-format)
+			COMPREPLY=( $(compgen -W "png ppm pam farbfeld bgra" -- "${cur}") )
+			return 0
+			;;
 		-f|--filename|-p|--path)
 			_filedir -d
 			return 0
@@ -46,7 +50,7 @@ _flameshot() {
 			COMPREPLY=( $(compgen -W "true false" -- "${cur}") )
 			return 0
 			;;
-		-d|--delay|-h|--help|-c|--clipboard|--version|-v|--number|-n)
+		-d|--delay|--scale|--max-width|-h|--help|-c|--clipboard|--version|-v|--number|-n)
 			return 0
 			;;
 		*)
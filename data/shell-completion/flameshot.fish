@@ -82,6 +82,9 @@ __flameshot_complete gui --long-option "delay"            --short-option "d" --d
 __flameshot_complete gui --long-option "region"                              --description "Screenshot region to select (WxH+X+Y)"             --require-parameter            --arguments "(__flameshot_complete_region gui)"
 __flameshot_complete gui --long-option "last-region"                         --description "Repeat screenshot with previously selected region"                     --no-files
 __flameshot_complete gui --long-option "raw"              --short-option "r" --description "Print raw PNG capture"                                                 --no-files
+__flameshot_complete gui --long-option "raw-format"                          --description "Format of the raw capture"                         --require-parameter --no-files --arguments "png ppm pam farbfeld bgra"
+__flameshot_complete gui --long-option "scale"                               --description "Scale before exporting (percent)"                       --require-parameter --no-files
+__flameshot_complete gui --long-option "max-width"                           --description "Downscale if wider (pixels)"                            --require-parameter --no-files
 __flameshot_complete gui --long-option "print-geometry"   --short-option "g" --description "Print geometry of the selection"                                       --no-files
 __flameshot_complete gui --long-option "upload"           --short-option "u" --description "Upload the screenshot"                                                 --no-files
 __flameshot_complete gui --long-option "pin"                                 --description "Pin the screenshot to the screen"                                      --no-files
@@ -96,6 +99,9 @@ __flameshot_complete screen --long-option "clipboard"   --short-option "c" --des
 __flameshot_complete screen --long-option "delay"       --short-option "d" --description "Delay time in milliseconds"                         --require-parameter --no-files
 __flameshot_complete screen --long-option "region"                          --description "Screenshot region to select (WxH+X+Y)"             --require-parameter --no-files --arguments "(__flameshot_complete_region screen)"
 __flameshot_complete screen --long-option "raw"         --short-option "r" --description "Print raw PNG capture"                                                 --no-files
+__flameshot_complete screen --long-option "raw-format"                     --description "Format of the raw capture"                         --require-parameter --no-files --arguments "png ppm pam farbfeld bgra"
+__flameshot_complete screen --long-option "scale"                          --description "Scale before exporting (percent)"                       --require-parameter --no-files
+__flameshot_complete screen --long-option "max-width"                      --description "Downscale if wider (pixels)"                            --require-parameter --no-files
 __flameshot_complete screen --long-option "upload"      --short-option "u" --description "Upload the screenshot"                                                 --no-files
 __flameshot_complete screen --long-option "pin"                            --description "Pin the screenshot to the screen"                                      --no-files
 __flameshot_complete screen --long-option "help"        --short-option "h" --description "Show the available arguments"                                          --no-files
@@ -107,6 +113,9 @@ __flameshot_complete full --long-option "clipboard"   --short-option "c" --descr
 __flameshot_complete full --long-option "delay"       --short-option "d" --description "Delay time in milliseconds"                        --require-parameter --no-files
 __flameshot_complete full --long-option "region"                         --description "Screenshot region to select (WxH+X+Y)"             --require-parameter --no-files --arguments "(__flameshot_complete_region full)" --keep-order
 __flameshot_complete full --long-option "raw"         --short-option "r" --description "Print raw PNG capture"                                                 --no-files
+__flameshot_complete full --long-option "raw-format"                     --description "Format of the raw capture"                         --require-parameter --no-files --arguments "png ppm pam farbfeld bgra"
+__flameshot_complete full --long-option "scale"                          --description "Scale before exporting (percent)"                       --require-parameter --no-files
+__flameshot_complete full --long-option "max-width"                      --description "Downscale if wider (pixels)"                            --require-parameter --no-files
 __flameshot_complete full --long-option "upload"      --short-option "u" --description "Upload the screenshot"                                                 --no-files
 __flameshot_complete full --long-option "help"        --short-option "h" --description "Show the available arguments"                                          --no-files
 
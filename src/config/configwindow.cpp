@@ -9,6 +9,7 @@
 #include "src/config/shortcutswidget.h"
 #include "src/config/strftimechooserwidget.h"
 #include "src/config/visualseditor.h"
+#include "src/core/metrics.h"
 #include "src/utils/colorutils.h"
 #include "src/utils/confighandler.h"
 #include "src/utils/globalvalues.h"
@@ -22,13 +23,20 @@
 #include <QSizePolicy>
 #include <QTabBar>
 #include <QTextStream>
+#include <QTimer>
 #include <QVBoxLayout>
 
 // ConfigWindow contains the menus where you can configure the application
 
 ConfigWindow::ConfigWindow(QWidget* parent)
   : QWidget(parent)
+  , m_filenameEditor(nullptr)
+  , m_shortcuts(nullptr)
+  , m_generalConfig(nullptr)
+  , m_visuals(nullptr)
 {
+    m_openTimer.start();
+
     // We wrap QTabWidget in a QWidget because of a Qt bug
     auto* layout = new QVBoxLayout(this);
     m_tabWidget = new QTabWidget(this);
@@ -44,67 +52,75 @@ ConfigWindow::ConfigWindow(QWidget* parent)
             this,
             &ConfigWindow::updateChildren);
 
+    // The pages are built when their tab is first shown
+    m_generalConfigTab = addTab(QStringLiteral("config.svg"), tr("General"));
+    m_visualsTab = addTab(QStringLiteral("graphics.svg"), tr("Interface"));
+    m_filenameEditorTab =
+      addTab(QStringLiteral("name_edition.svg"), tr("Filename Editor"));
+    m_shortcutsTab = addTab(QStringLiteral("shortcut.svg"), tr("Shortcuts"));
+
+    connect(m_tabWidget,
+            &QTabWidget::currentChanged,
+            this,
+            &ConfigWindow::buildPage);
+    // Once the window is shown, so that it shows up at once
+    QTimer::singleShot(
+      0, this, [this]() { buildPage(m_tabWidget->currentIndex()); });
+}
+
+QWidget* ConfigWindow::addTab(const QString& icon, const QString& title)
+{
     QColor background = this->palette().window().color();
     bool isDark = ColorUtils::colorIsDark(background);
     QString modifier =
       isDark ? PathInfo::whiteIconPath() : PathInfo::blackIconPath();
 
-    // general
-    m_generalConfig = new GeneralConf();
-    m_generalConfigTab = new QWidget();
-    auto* generalConfigLayout = new QVBoxLayout(m_generalConfigTab);
-    m_generalConfigTab->setLayout(generalConfigLayout);
-    generalConfigLayout->addWidget(m_generalConfig);
-    m_tabWidget->addTab(
-      m_generalConfigTab, QIcon(modifier + "config.svg"), tr("General"));
-
-    // visuals
-    m_visuals = new VisualsEditor();
-    m_visualsTab = new QWidget();
-    auto* visualsLayout = new QVBoxLayout(m_visualsTab);
-    m_visualsTab->setLayout(visualsLayout);
-    visualsLayout->addWidget(m_visuals);
-    m_tabWidget->addTab(
-      m_visualsTab, QIcon(modifier + "graphics.svg"), tr("Interface"));
-
-    // filename
-    m_filenameEditor = new FileNameEditor();
-    m_filenameEditorTab = new QWidget();
-    auto* filenameEditorLayout = new QVBoxLayout(m_filenameEditorTab);
-    m_filenameEditorTab->setLayout(filenameEditorLayout);
-    filenameEditorLayout->addWidget(m_filenameEditor);
-    m_tabWidget->addTab(m_filenameEditorTab,
-                        QIcon(modifier + "name_edition.svg"),
-                        tr("Filename Editor"));
-
-    // shortcuts
-    m_shortcuts = new ShortcutsWidget();
-    m_shortcutsTab = new QWidget();
-    auto* shortcutsLayout = new QVBoxLayout(m_shortcutsTab);
-    m_shortcutsTab->setLayout(shortcutsLayout);
-    shortcutsLayout->addWidget(m_shortcuts);
-    m_tabWidget->addTab(
-      m_shortcutsTab, QIcon(modifier + "shortcut.svg"), tr("Shortcuts"));
-
-    // connect update sigslots
-    connect(this,
-            &ConfigWindow::updateChildren,
-            m_filenameEditor,
-            &FileNameEditor::updateComponents);
-    connect(this,
-            &ConfigWindow::updateChildren,
-            m_visuals,
-            &VisualsEditor::updateComponents);
-    connect(this,
-            &ConfigWindow::updateChildren,
-            m_generalConfig,
-            &GeneralConf::updateComponents);
+    auto* tab = new QWidget();
+    tab->setLayout(new QVBoxLayout(tab));
+    m_tabWidget->addTab(tab, QIcon(modifier + icon), title);
+    return tab;
+}
 
+void ConfigWindow::buildPage(int index)
+{
+    QWidget* tab = m_tabWidget->widget(index);
+    QWidget* page = nullptr;
+    if (tab == m_generalConfigTab && m_generalConfig == nullptr) {
+        m_generalConfig = new GeneralConf();
+        connect(this,
+                &ConfigWindow::updateChildren,
+                m_generalConfig,
+                &GeneralConf::updateComponents);
+        page = m_generalConfig;
+    } else if (tab == m_visualsTab && m_visuals == nullptr) {
+        m_visuals = new VisualsEditor();
+        connect(this,
+                &ConfigWindow::updateChildren,
+                m_visuals,
+                &VisualsEditor::updateComponents);
+        page = m_visuals;
+    } else if (tab == m_filenameEditorTab && m_filenameEditor == nullptr) {
+        m_filenameEditor = new FileNameEditor();
+        connect(this,
+                &ConfigWindow::updateChildren,
+                m_filenameEditor,
+                &FileNameEditor::updateComponents);
+        page = m_filenameEditor;
+    } else if (tab == m_shortcutsTab && m_shortcuts == nullptr) {
+        m_shortcuts = new ShortcutsWidget();
+        page = m_shortcuts;
+    }
+    if (page == nullptr) {
+        return;
+    }
+
+    tab->layout()->addWidget(page);
     // Error indicator (this must come last)
-    initErrorIndicator(m_visualsTab, m_visuals);
-    initErrorIndicator(m_filenameEditorTab, m_filenameEditor);
-    initErrorIndicator(m_generalConfigTab, m_generalConfig);
-    initErrorIndicator(m_shortcutsTab, m_shortcuts);
+    initErrorIndicator(tab, page);
+
+    if (m_openTimer.isValid()) {
+        page->installEventFilter(this);
+    }
 }
 
 void ConfigWindow::keyPressEvent(QKeyEvent* e)
@@ -114,6 +130,16 @@ void ConfigWindow::keyPressEvent(QKeyEvent* e)
     }
 }
 
+bool ConfigWindow::eventFilter(QObject* watched, QEvent* event)
+{
+    if (event->type() == QEvent::Paint && m_openTimer.isValid()) {
+        Metrics::observe(Metrics::SETTINGS_OPEN, m_openTimer.nsecsElapsed());
+        m_openTimer.invalidate();
+        watched->removeEventFilter(this);
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
 void ConfigWindow::initErrorIndicator(QWidget* tab, QWidget* widget)
 {
     auto* label = new QLabel(tab);
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <QElapsedTimer>
 #include <QTabWidget>
 
 class FileNameEditor;
@@ -23,6 +24,7 @@ signals:
 
 protected:
     void keyPressEvent(QKeyEvent*);
+    bool eventFilter(QObject* watched, QEvent* event) override;
 
 private:
     QTabWidget* m_tabWidget;
@@ -39,5 +41,10 @@ private:
     VisualsEditor* m_visuals;
     QWidget* m_visualsTab;
 
+    // Runs from construction until the first page is painted
+    QElapsedTimer m_openTimer;
+
+    QWidget* addTab(const QString& icon, const QString& title);
+    void buildPage(int index);
     void initErrorIndicator(QWidget* tab, QWidget* widget);
 };
@@ -3,12 +3,12 @@
 #include "generalconf.h"
 #include "src/core/flameshot.h"
 #include "src/utils/confighandler.h"
+#include "src/utils/imageencoder.h"
 #include <QCheckBox>
 #include <QComboBox>
 #include <QFile>
 #include <QFileDialog>
 #include <QGroupBox>
-#include <QImageWriter>
 #include <QLabel>
 #include <QLineEdit>
 #include <QMessageBox>
@@ -50,12 +50,14 @@ GeneralConf::GeneralConf(QWidget* parent)
     initShowHelp();
     initShowSidePanelButton();
     initUseJpgForClipboard();
+    initSavePalettePng();
     initCopyOnDoubleClick();
     initSaveAfterCopy();
     initCopyPathAfterSave();
     initAntialiasingPinZoom();
     initUndoLimit();
     initInsecurePixelate();
+    initSuggestRedactions();
 #ifdef ENABLE_IMGUR
     initCopyAndCloseAfterUpload();
     initUploadWithoutConfirmation();
@@ -89,6 +91,7 @@ void GeneralConf::_updateComponents(bool allowEmptySavePath)
     m_copyPathAfterSave->setChecked(config.copyPathAfterSave());
     m_antialiasingPinZoom->setChecked(config.antialiasingPinZoom());
     m_useJpgForClipboard->setChecked(config.useJpgForClipboard());
+    m_savePalettePng->setChecked(config.savePalettePng());
     m_copyOnDoubleClick->setChecked(config.copyOnDoubleClick());
 #ifdef ENABLE_IMGUR
     m_uploadWithoutConfirmation->setChecked(config.uploadWithoutConfirmation());
@@ -106,6 +109,7 @@ void GeneralConf::_updateComponents(bool allowEmptySavePath)
     m_squareMagnifier->setChecked(config.squareMagnifier());
     m_saveLastRegion->setChecked(config.saveLastRegion());
     m_reverseArrow->setChecked(config.reverseArrow());
+    m_suggestRedactions->setChecked(config.suggestRedactions());
 
 #if !defined(Q_OS_WIN)
     m_autoCloseIdleDaemon->setChecked(config.autoCloseIdleDaemon());
@@ -461,7 +465,6 @@ void GeneralConf::initShowStartupLaunchMessage()
 {
     m_showStartupLaunchMessage =
       new QCheckBox(tr("Show welcome message on launch"), this);
-    ConfigHandler config;
     m_showStartupLaunchMessage->setToolTip(
       tr("Show the welcome message box in the middle of the screen while "
          "taking a screenshot"));
@@ -475,7 +478,6 @@ void GeneralConf::initShowStartupLaunchMessage()
 void GeneralConf::initShowQuitPrompt()
 {
     m_showQuitPrompt = new QCheckBox(tr("Ask before quit capture"), this);
-    ConfigHandler config;
     m_showQuitPrompt->setToolTip(
       tr("Show the confirmation prompt before ESC quit"));
     m_scrollAreaLayout->addWidget(m_showQuitPrompt);
@@ -542,7 +544,7 @@ void GeneralConf::initSaveAfterCopy()
 
     auto* pathLayout = new QHBoxLayout();
 
-    QString path = ConfigHandler().savePath();
+    QString path = m_config.savePath();
     m_savePath = new QLineEdit(path, this);
     m_savePath->setDisabled(true);
     QString foreground = this->palette().windowText().color().name();
@@ -572,14 +574,10 @@ void GeneralConf::initSaveAfterCopy()
       new QLabel(tr("Preferred save file extension:")));
     m_setSaveAsFileExtension = new QComboBox(this);
 
-    QStringList imageFormatList;
-    for (const auto& mimeType : QImageWriter::supportedImageFormats())
-        imageFormatList.append(mimeType);
-
-    m_setSaveAsFileExtension->addItems(imageFormatList);
+    m_setSaveAsFileExtension->addItems(ImageEncoder::supportedFormats());
 
     int currentIndex =
-      m_setSaveAsFileExtension->findText(ConfigHandler().saveAsFileExtension());
+      m_setSaveAsFileExtension->findText(m_config.saveAsFileExtension());
     m_setSaveAsFileExtension->setCurrentIndex(currentIndex);
 
     connect(m_setSaveAsFileExtension,
@@ -631,7 +629,7 @@ void GeneralConf::initUploadClientSecret()
     QString foreground = this->palette().windowText().color().name();
     m_uploadClientKey->setStyleSheet(
       QStringLiteral("color: %1").arg(foreground));
-    m_uploadClientKey->setText(ConfigHandler().uploadClientSecret());
+    m_uploadClientKey->setText(m_config.uploadClientSecret());
     connect(m_uploadClientKey,
             &QLineEdit::editingFinished,
             this,
@@ -697,6 +695,19 @@ void GeneralConf::initUseJpgForClipboard()
     m_scrollAreaLayout->addWidget(m_useJpgForClipboard);
 }
 
+void GeneralConf::initSavePalettePng()
+{
+    m_savePalettePng =
+      new QCheckBox(tr("Use palette PNG for captures with few colors"), this);
+    m_savePalettePng->setToolTip(
+      tr("Captures with at most 256 colors are saved as lossless 8-bit "
+         "PNGs, which are several times smaller"));
+    m_scrollAreaLayout->addWidget(m_savePalettePng);
+    connect(m_savePalettePng, &QCheckBox::clicked, [](bool checked) {
+        ConfigHandler().setSavePalettePng(checked);
+    });
+}
+
 void GeneralConf::saveAfterCopyChanged(bool checked)
 {
     ConfigHandler().setSaveAfterCopy(checked);
@@ -799,8 +810,7 @@ void GeneralConf::initShowSelectionGeometry()
 {
     auto* tobox = new QHBoxLayout();
 
-    int timeout =
-      ConfigHandler().value("showSelectionGeometryHideTime").toInt();
+    int timeout = m_config.value("showSelectionGeometryHideTime").toInt();
     m_xywhTimeout = new QSpinBox();
     m_xywhTimeout->setRange(0, INT_MAX);
     m_xywhTimeout->setToolTip(
@@ -837,7 +847,7 @@ void GeneralConf::initShowSelectionGeometry()
     m_selectGeometryLocation->addItem(tr("Center"), GeneralConf::xywh_center);
 
     // pick up int from config and use findData
-    int pos = ConfigHandler().value("showSelectionGeometry").toInt();
+    int pos = m_config.value("showSelectionGeometry").toInt();
     m_selectGeometryLocation->setCurrentIndex(
       m_selectGeometryLocation->findData(pos));
 
@@ -856,7 +866,7 @@ void GeneralConf::initJpegQuality()
 {
     auto* tobox = new QHBoxLayout();
 
-    int quality = ConfigHandler().value("jpegQuality").toInt();
+    int quality = m_config.value("jpegQuality").toInt();
     m_jpegQuality = new QSpinBox();
     m_jpegQuality->setRange(0, 100);
     m_jpegQuality->setToolTip(tr("Quality range of 0-100; Higher number is "
@@ -887,7 +897,7 @@ void GeneralConf::initInsecurePixelate()
     m_insecurePixelate = new QCheckBox(tr("Insecure Pixelate"), this);
     m_insecurePixelate->setToolTip(
       tr("Draw the pixelation effect in an insecure but more asethetic way."));
-    m_insecurePixelate->setChecked(ConfigHandler().insecurePixelate());
+    m_insecurePixelate->setChecked(m_config.insecurePixelate());
     m_scrollAreaLayout->addWidget(m_insecurePixelate);
 
     connect(m_insecurePixelate,
@@ -896,6 +906,22 @@ void GeneralConf::initInsecurePixelate()
             &GeneralConf::setInsecurePixelate);
 }
 
+void GeneralConf::initSuggestRedactions()
+{
+    m_suggestRedactions =
+      new QCheckBox(tr("Suggest text areas to pixelate"), this);
+    m_suggestRedactions->setToolTip(
+      tr("Look for text in the capture. With the pixelate tool, a click on a "
+         "highlighted area pixelates all of it."));
+    m_suggestRedactions->setChecked(m_config.suggestRedactions());
+    m_scrollAreaLayout->addWidget(m_suggestRedactions);
+
+    connect(m_suggestRedactions,
+            &QCheckBox::clicked,
+            this,
+            &GeneralConf::setSuggestRedactions);
+}
+
 void GeneralConf::setSelGeoHideTime(int v)
 {
     ConfigHandler().setValue("showSelectionGeometryHideTime", v);
@@ -935,4 +961,9 @@ void GeneralConf::setReverseArrow(bool checked)
 void GeneralConf::setInsecurePixelate(bool checked)
 {
     ConfigHandler().setInsecurePixelate(checked);
+}
+
+void GeneralConf::setSuggestRedactions(bool checked)
+{
+    ConfigHandler().setSuggestRedactions(checked);
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include "src/utils/confighandler.h"
 #include <QScrollArea>
 #include <QWidget>
 
@@ -62,6 +63,7 @@ private slots:
     void setJpegQuality(int v);
     void setReverseArrow(bool checked);
     void setInsecurePixelate(bool checked);
+    void setSuggestRedactions(bool checked);
 
 private:
     const QString chooseFolder(const QString& currentPath = "");
@@ -94,6 +96,7 @@ private:
     void initUndoLimit();
     void initUploadWithoutConfirmation();
     void initUseJpgForClipboard();
+    void initSavePalettePng();
     void initUploadHistoryMax();
     void initUploadClientSecret();
     void initSaveLastRegion();
@@ -101,6 +104,7 @@ private:
     void initJpegQuality();
     void initReverseArrow();
     void initInsecurePixelate();
+    void initSuggestRedactions();
 
     void _updateComponents(bool allowEmptySavePath);
 
@@ -137,6 +141,7 @@ private:
     QCheckBox* m_screenshotPathFixedCheck;
     QCheckBox* m_historyConfirmationToDelete;
     QCheckBox* m_useJpgForClipboard;
+    QCheckBox* m_savePalettePng;
     QSpinBox* m_uploadHistoryMax;
     QSpinBox* m_undoLimit;
     QComboBox* m_setSaveAsFileExtension;
@@ -150,4 +155,8 @@ private:
     QSpinBox* m_jpegQuality;
     QCheckBox* m_reverseArrow;
     QCheckBox* m_insecurePixelate;
+    QCheckBox* m_suggestRedactions;
+
+    // Read by the init functions while the page is built
+    ConfigHandler m_config;
 };
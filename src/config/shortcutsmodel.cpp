@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "shortcutsmodel.h"
+#include <QFont>
+
+ShortcutsModel::ShortcutsModel(QObject* parent)
+  : QAbstractTableModel(parent)
+{}
+
+void ShortcutsModel::setShortcuts(const QList<QStringList>& shortcuts)
+{
+    beginResetModel();
+    m_shortcuts = shortcuts;
+    endResetModel();
+}
+
+const QStringList& ShortcutsModel::shortcut(int row) const
+{
+    return m_shortcuts.at(row);
+}
+
+int ShortcutsModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_shortcuts.size();
+}
+
+int ShortcutsModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : 2;
+}
+
+QVariant ShortcutsModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid()) {
+        return QVariant();
+    }
+    const QStringList& shortcut = m_shortcuts.at(index.row());
+    switch (role) {
+        case Qt::DisplayRole:
+            // Column 0 shows the description, column 1 the key sequence
+            return shortcut.at(index.column() + 1);
+        case Qt::TextAlignmentRole:
+            if (index.column() == 1) {
+                return int(Qt::AlignCenter);
+            }
+            break;
+        case Qt::FontRole:
+            if (index.column() == 1 && shortcut.at(0).isEmpty()) {
+                QFont font;
+                font.setBold(true);
+                return font;
+            }
+            break;
+        default:
+            break;
+    }
+    return QVariant();
+}
+
+QVariant ShortcutsModel::headerData(int section,
+                                    Qt::Orientation orientation,
+                                    int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    return section == 0 ? tr("Description") : tr("Key");
+}
+
+Qt::ItemFlags ShortcutsModel::flags(const QModelIndex& index) const
+{
+    if (!index.isValid()) {
+        return Qt::NoItemFlags;
+    }
+    // Non-changeable shortcuts have an empty name
+    if (index.column() == 1 && m_shortcuts.at(index.row()).at(0).isEmpty()) {
+        return Qt::NoItemFlags;
+    }
+    return Qt::ItemIsEnabled;
+}
@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QStringList>
+
+/**
+ * @brief Table of the shortcuts shown by ShortcutsWidget.
+ *
+ * Each row is a list of the shortcut name, its description and its key
+ * sequence. Rows with an empty name are not editable and are shown disabled.
+ */
+class ShortcutsModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit ShortcutsModel(QObject* parent = nullptr);
+
+    void setShortcuts(const QList<QStringList>& shortcuts);
+    const QStringList& shortcut(int row) const;
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index,
+                  int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section,
+                        Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+
+private:
+    QList<QStringList> m_shortcuts;
+};
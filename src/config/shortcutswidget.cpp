@@ -4,6 +4,7 @@
 #include "shortcutswidget.h"
 #include "capturetool.h"
 #include "setshortcutwidget.h"
+#include "shortcutsmodel.h"
 #include "src/core/qguiappcurrentscreen.h"
 #include "src/utils/globalvalues.h"
 #include "toolfactory.h"
@@ -15,7 +16,7 @@
 #include <QRect>
 #include <QScreen>
 #include <QStringList>
-#include <QTableWidget>
+#include <QTableView>
 #include <QVBoxLayout>
 #include <QVector>
 
@@ -44,22 +45,20 @@ ShortcutsWidget::ShortcutsWidget(QWidget* parent)
 
 void ShortcutsWidget::initInfoTable()
 {
-    m_table = new QTableWidget(this);
+    m_model = new ShortcutsModel(this);
+    m_table = new QTableView(this);
+    m_table->setModel(m_model);
     m_table->setToolTip(tr("Available shortcuts in the screen capture mode."));
 
     m_layout->addWidget(m_table);
 
-    m_table->setColumnCount(2);
     m_table->setSelectionMode(QAbstractItemView::NoSelection);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
     m_table->setFocusPolicy(Qt::NoFocus);
     m_table->verticalHeader()->hide();
 
-    // header creation
-    QStringList names;
-    names << tr("Description") << tr("Key");
-    m_table->setHorizontalHeaderLabels(names);
     connect(m_table,
-            &QTableWidget::cellClicked,
+            &QTableView::clicked,
             this,
             &ShortcutsWidget::onShortcutCellClicked);
 
@@ -78,52 +77,23 @@ void ShortcutsWidget::initInfoTable()
 void ShortcutsWidget::populateInfoTable()
 {
     loadShortcuts();
-    m_table->setRowCount(m_shortcuts.size());
-
-    // add content
-    for (int i = 0; i < m_shortcuts.size(); ++i) {
-        const auto current_shortcut = m_shortcuts.at(i);
-        const auto identifier = current_shortcut.at(0);
-        const auto description = current_shortcut.at(1);
-        const auto key_sequence = current_shortcut.at(2);
-        m_table->setItem(i, 0, new QTableWidgetItem(description));
-
 #if defined(Q_OS_MACOS)
-        auto* item = new QTableWidgetItem(nativeOSHotKeyText(key_sequence));
-#else
-        QTableWidgetItem* item = new QTableWidgetItem(key_sequence);
-#endif
-        item->setTextAlignment(Qt::AlignCenter);
-        m_table->setItem(i, 1, item);
-
-        if (identifier.isEmpty()) {
-            QFont font;
-            font.setBold(true);
-            item->setFont(font);
-            item->setFlags(item->flags() ^ Qt::ItemIsEnabled);
-            m_table->item(i, 1)->setFont(font);
-        }
-    }
-
-    // Read-only table items
-    for (int x = 0; x < m_table->rowCount(); ++x) {
-        for (int y = 0; y < m_table->columnCount(); ++y) {
-            QTableWidgetItem* item = m_table->item(x, y);
-            item->setFlags(item->flags() ^ Qt::ItemIsEditable);
-        }
+    for (QStringList& shortcut : m_shortcuts) {
+        shortcut[2] = nativeOSHotKeyText(shortcut.at(2));
     }
+#endif
+    m_model->setShortcuts(m_shortcuts);
 }
 
-void ShortcutsWidget::onShortcutCellClicked(int row, int col)
+void ShortcutsWidget::onShortcutCellClicked(const QModelIndex& index)
 {
-    if (col == 1) {
+    if (index.column() == 1) {
         // Ignore non-changable shortcuts
-        if (Qt::ItemIsEnabled !=
-            (Qt::ItemIsEnabled & m_table->item(row, col)->flags())) {
+        if (!(m_model->flags(index) & Qt::ItemIsEnabled)) {
             return;
         }
 
-        QString shortcutName = m_shortcuts.at(row).at(0);
+        QString shortcutName = m_model->shortcut(index.row()).at(0);
         auto* setShortcutDialog = new SetShortcutDialog(nullptr, shortcutName);
         if (0 != setShortcutDialog->exec()) {
             QKeySequence shortcutValue = setShortcutDialog->shortcut();
@@ -181,6 +151,8 @@ void ShortcutsWidget::loadShortcuts()
     appendShortcut("TYPE_SYM_RESIZE_DOWN",
                    tr("Symmetrically decrease height by 2px"));
     appendShortcut("TYPE_SELECT_ALL", tr("Select entire screen"));
+    appendShortcut("TYPE_ADD_REGION",
+                   tr("Keep the selection and select another region"));
     appendShortcut("TYPE_MOVE_LEFT", tr("Move selection left 1px"));
     appendShortcut("TYPE_MOVE_RIGHT", tr("Move selection right 1px"));
     appendShortcut("TYPE_MOVE_UP", tr("Move selection up 1px"));
@@ -223,7 +195,7 @@ void ShortcutsWidget::loadShortcuts()
 void ShortcutsWidget::appendShortcut(const QString& shortcutName,
                                      const QString& description)
 {
-    QString shortcut = ConfigHandler().shortcut(shortcutName);
+    QString shortcut = m_config.shortcut(shortcutName);
     m_shortcuts << (QStringList()
                     << shortcutName
                     << QObject::tr(description.toStdString().c_str())
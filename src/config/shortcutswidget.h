@@ -10,7 +10,9 @@
 #include <QWidget>
 
 class SetShortcutDialog;
-class QTableWidget;
+class ShortcutsModel;
+class QModelIndex;
+class QTableView;
 class QVBoxLayout;
 
 class ShortcutsWidget : public QWidget
@@ -27,14 +29,15 @@ private:
 
 private slots:
     void populateInfoTable();
-    void onShortcutCellClicked(int, int);
+    void onShortcutCellClicked(const QModelIndex& index);
 
 private:
 #if (defined(Q_OS_MAC) || defined(Q_OS_MACOS))
     QString m_res;
 #endif
     ConfigHandler m_config;
-    QTableWidget* m_table;
+    QTableView* m_table;
+    ShortcutsModel* m_model;
     QVBoxLayout* m_layout;
     QList<QStringList> m_shortcuts;
 
@@ -74,5 +74,7 @@ QMap<QString, QString> StrftimeChooserWidget::m_buttonData{
 #endif
     { QT_TR_NOOP("Full Date (%Y-%m-%d)"), "%F" },
     { QT_TR_NOOP("Full Date (%d-%m-%Y)"), "%d-%m-%Y" },
+    { QT_TR_NOOP("Content Hash"), "%{hash}" },
+    { QT_TR_NOOP("Region Number"), "%{index}" },
 
 };
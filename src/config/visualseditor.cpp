@@ -14,6 +14,7 @@
 
 VisualsEditor::VisualsEditor(QWidget* parent)
   : QWidget(parent)
+  , m_colorpickerEditor(nullptr)
 {
     m_layout = new QVBoxLayout();
     setLayout(m_layout);
@@ -71,11 +72,17 @@ void VisualsEditor::initWidgets()
     colorEditorLayout->addWidget(m_colorEditor);
     m_tabWidget->addTab(m_colorEditorTab, tr("UI Color Editor"));
 
-    m_colorpickerEditor = new ColorPickerEditor();
+    // The color picker editor is built when its tab is first shown
     m_colorpickerEditorTab = new QWidget();
-    auto* colorpickerEditorLayout = new QVBoxLayout(m_colorpickerEditorTab);
-    colorpickerEditorLayout->addWidget(m_colorpickerEditor);
+    new QVBoxLayout(m_colorpickerEditorTab);
     m_tabWidget->addTab(m_colorpickerEditorTab, tr("Colorpicker Editor"));
+    connect(m_tabWidget, &QTabWidget::currentChanged, this, [this](int index) {
+        if (m_tabWidget->widget(index) == m_colorpickerEditorTab &&
+            m_colorpickerEditor == nullptr) {
+            m_colorpickerEditor = new ColorPickerEditor();
+            m_colorpickerEditorTab->layout()->addWidget(m_colorpickerEditor);
+        }
+    });
 
     initOpacitySlider();
 
@@ -10,11 +10,20 @@
 #include <stdexcept>
 #include <utility>
 
+namespace {
+uint nextRequestId()
+{
+    static uint lastId = 0;
+    return ++lastId;
+}
+} // unnamed namespace
+
 CaptureRequest::CaptureRequest(CaptureRequest::CaptureMode mode,
                                const uint delay,
                                QVariant data,
                                CaptureRequest::ExportTask tasks)
-  : m_mode(mode)
+  : m_id(nextRequestId())
+  , m_mode(mode)
   , m_delay(delay)
   , m_tasks(tasks)
   , m_data(std::move(data))
@@ -27,6 +36,19 @@ CaptureRequest::CaptureRequest(CaptureRequest::CaptureMode mode,
     }
 }
 
+void CaptureRequest::setStaticID(uint id)
+{
+    m_id = id;
+}
+
+/**
+ * @brief Identifies the request within the process that created it.
+ */
+uint CaptureRequest::id() const
+{
+    return m_id;
+}
+
 CaptureRequest::CaptureMode CaptureRequest::captureMode() const
 {
     return m_mode;
@@ -57,6 +79,29 @@ QRect CaptureRequest::initialSelection() const
     return m_initialSelection;
 }
 
+/**
+ * @brief Format of the capture printed by the PRINT_RAW task.
+ */
+RawImageWriter::Format CaptureRequest::rawFormat() const
+{
+    return m_rawFormat;
+}
+
+/**
+ * @brief Scale of the exported capture in percent, the `exportScale` option
+ * unless set for this request.
+ */
+int CaptureRequest::exportScale() const
+{
+    return m_exportScale >= 0 ? m_exportScale : ConfigHandler().exportScale();
+}
+
+int CaptureRequest::exportMaxWidth() const
+{
+    return m_exportMaxWidth >= 0 ? m_exportMaxWidth
+                                 : ConfigHandler().exportMaxWidth();
+}
+
 void CaptureRequest::addTask(CaptureRequest::ExportTask task)
 {
     if (task == SAVE) {
@@ -82,7 +127,57 @@ void CaptureRequest::addPinTask(const QRect& pinWindowGeometry)
     m_pinWindowGeometry = pinWindowGeometry;
 }
 
+void CaptureRequest::setDelay(uint delay)
+{
+    m_delay = delay;
+}
+
 void CaptureRequest::setInitialSelection(const QRect& selection)
 {
     m_initialSelection = selection;
 }
+
+void CaptureRequest::setRawFormat(RawImageWriter::Format format)
+{
+    m_rawFormat = format;
+}
+
+void CaptureRequest::setExportScale(int percent)
+{
+    m_exportScale = percent;
+}
+
+void CaptureRequest::setExportMaxWidth(int width)
+{
+    m_exportMaxWidth = width;
+}
+
+/**
+ * @brief Serialize the request, so it can be handed over to the daemon.
+ *
+ * The id is not part of the serialized data, the receiving process assigns
+ * its own.
+ */
+QDataStream& operator<<(QDataStream& stream, const CaptureRequest& req)
+{
+    stream << static_cast<qint32>(req.m_mode) << req.m_delay << req.m_path
+           << static_cast<qint32>(req.m_tasks) << req.m_data
+           << req.m_pinWindowGeometry << req.m_initialSelection
+           << static_cast<qint32>(req.m_rawFormat) << req.m_exportScale
+           << req.m_exportMaxWidth;
+    return stream;
+}
+
+QDataStream& operator>>(QDataStream& stream, CaptureRequest& req)
+{
+    qint32 mode = 0;
+    qint32 tasks = 0;
+    qint32 rawFormat = RawImageWriter::PNG;
+    stream >> mode >> req.m_delay >> req.m_path >> tasks >> req.m_data >>
+      req.m_pinWindowGeometry >> req.m_initialSelection >> rawFormat >>
+      req.m_exportScale >> req.m_exportMaxWidth;
+    req.m_mode = static_cast<CaptureRequest::CaptureMode>(mode);
+    req.m_tasks = static_cast<CaptureRequest::ExportTask>(tasks);
+    req.m_rawFormat = static_cast<RawImageWriter::Format>(rawFormat);
+    return stream;
+}
@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include "src/utils/rawimagewriter.h"
+#include <QDataStream>
 #include <QPixmap>
 #include <QString>
 #include <QVariant>
@@ -27,6 +29,8 @@ public:
         PIN = 16,
         UPLOAD = 32,
         ACCEPT_ON_SELECT = 64,
+        // Grab the selection again while its content is scrolled
+        SCROLL = 128,
     };
 
     CaptureRequest(CaptureMode mode,
@@ -43,20 +47,36 @@ public:
     CaptureMode captureMode() const;
     ExportTask tasks() const;
     QRect initialSelection() const;
+    RawImageWriter::Format rawFormat() const;
+    int exportScale() const;
+    int exportMaxWidth() const;
 
     void addTask(ExportTask task);
     void removeTask(ExportTask task);
     void addSaveTask(const QString& path = QString());
     void addPinTask(const QRect& pinWindowGeometry);
+    void setDelay(uint delay);
     void setInitialSelection(const QRect& selection);
+    void setRawFormat(RawImageWriter::Format format);
+    void setExportScale(int percent);
+    void setExportMaxWidth(int width);
+
+    friend QDataStream& operator<<(QDataStream& stream,
+                                   const CaptureRequest& req);
+    friend QDataStream& operator>>(QDataStream& stream, CaptureRequest& req);
 
 private:
+    uint m_id;
     CaptureMode m_mode;
     uint m_delay;
     QString m_path;
     ExportTask m_tasks;
     QVariant m_data;
     QRect m_pinWindowGeometry, m_initialSelection;
+    RawImageWriter::Format m_rawFormat = RawImageWriter::PNG;
+    // -1 until set on the command line, the config applies then
+    int m_exportScale = -1;
+    int m_exportMaxWidth = -1;
 
     CaptureRequest() {}
 };
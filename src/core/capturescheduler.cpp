@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "capturescheduler.h"
+#include <QTimer>
+
+namespace {
+// Requests beyond this are rejected, something is flooding us
+constexpr int MAX_QUEUED_REQUESTS = 32;
+// Time for the compositor to remove the closed capture window from the
+// screen, before a batch request grabs it
+constexpr int WINDOW_CLOSE_DELAY_MS = 200;
+} // unnamed namespace
+
+CaptureScheduler::CaptureScheduler(QObject* parent)
+  : QObject(parent)
+  , m_interactiveBusy(false)
+  , m_dispatchScheduled(false)
+{}
+
+/**
+ * @brief Queue a request, it is dispatched once its delay has passed and its
+ * turn has come.
+ * @return false if the queue is full and the request was dropped.
+ */
+bool CaptureScheduler::enqueue(const CaptureRequest& req)
+{
+    if (m_stats.queued >= MAX_QUEUED_REQUESTS) {
+        ++m_stats.rejected;
+        return false;
+    }
+    ++m_stats.queued;
+    m_stats.peakQueued = qMax(m_stats.peakQueued, m_stats.queued);
+
+    if (req.delay() > 0) {
+        QTimer::singleShot(
+          req.delay(), this, [this, req]() { makeReady(req); });
+    } else {
+        makeReady(req);
+    }
+    return true;
+}
+
+/**
+ * @brief Tell whether the capture window is open, interactive requests are
+ * held back while it is.
+ */
+void CaptureScheduler::setInteractiveBusy(bool busy)
+{
+    m_interactiveBusy = busy;
+    if (!busy) {
+        m_interactiveClosed.start();
+        if (!m_interactive.isEmpty() || !m_batch.isEmpty()) {
+            scheduleDispatch();
+        }
+    }
+}
+
+CaptureScheduler::Stats CaptureScheduler::stats() const
+{
+    return m_stats;
+}
+
+void CaptureScheduler::makeReady(const CaptureRequest& req)
+{
+    Entry entry{ req, QElapsedTimer() };
+    entry.readySince.start();
+    if (isInteractive(req)) {
+        m_interactive.enqueue(entry);
+    } else {
+        m_batch.enqueue(entry);
+    }
+    scheduleDispatch();
+}
+
+void CaptureScheduler::scheduleDispatch(int delayMs)
+{
+    if (m_dispatchScheduled) {
+        return;
+    }
+    // Dispatch from the event loop, one request per iteration, so that the
+    // caller of enqueue() returns first and the UI stays responsive
+    m_dispatchScheduled = true;
+    QTimer::singleShot(delayMs, this, &CaptureScheduler::dispatchNext);
+}
+
+void CaptureScheduler::dispatchNext()
+{
+    m_dispatchScheduled = false;
+
+    QQueue<Entry>* queue = nullptr;
+    if (!m_interactiveBusy && !m_interactive.isEmpty()) {
+        queue = &m_interactive;
+    } else if (!m_batch.isEmpty()) {
+        // Only wait for a window that just closed, an open one doesn't hold
+        // back the requests that don't need it
+        const qint64 remainingMs =
+          !m_interactiveBusy && m_interactiveClosed.isValid()
+            ? WINDOW_CLOSE_DELAY_MS - m_interactiveClosed.elapsed()
+            : 0;
+        if (remainingMs > 0) {
+            scheduleDispatch(int(remainingMs));
+            return;
+        }
+        queue = &m_batch;
+    } else {
+        // Interactive requests are dispatched again when the window closes
+        return;
+    }
+    const Entry entry = queue->dequeue();
+
+    const qint64 waitMs = entry.readySince.elapsed();
+    --m_stats.queued;
+    ++m_stats.dispatched;
+    m_stats.lastWaitMs = waitMs;
+    m_stats.maxWaitMs = qMax(m_stats.maxWaitMs, waitMs);
+    m_stats.totalWaitMs += waitMs;
+
+    emit dispatch(entry.request);
+
+    if (!m_batch.isEmpty() ||
+        (!m_interactiveBusy && !m_interactive.isEmpty())) {
+        scheduleDispatch();
+    }
+}
+
+bool CaptureScheduler::isInteractive(const CaptureRequest& req)
+{
+    return req.captureMode() == CaptureRequest::GRAPHICAL_MODE;
+}
@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "src/core/capturerequest.h"
+#include <QElapsedTimer>
+#include <QObject>
+#include <QQueue>
+
+/**
+ * @brief Orders capture requests instead of letting them race each other.
+ *
+ * Requests wait for their delay and are then queued by priority. Interactive
+ * (GUI) requests go first but only one of them can be open at a time, the
+ * others wait for the capture window to close. Batch requests (full and
+ * screen captures) don't need the window and run while it is open, the
+ * window is then part of their grab like any other. Right after it closed
+ * they wait a moment, until the compositor removed it from the screen.
+ */
+class CaptureScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Stats
+    {
+        // Requests waiting for their delay or for their turn
+        int queued = 0;
+        int peakQueued = 0;
+        quint64 dispatched = 0;
+        quint64 rejected = 0;
+        // Time between the end of the delay and the dispatch
+        qint64 lastWaitMs = 0;
+        qint64 maxWaitMs = 0;
+        qint64 totalWaitMs = 0;
+    };
+
+    explicit CaptureScheduler(QObject* parent = nullptr);
+
+    bool enqueue(const CaptureRequest& req);
+    void setInteractiveBusy(bool busy);
+    Stats stats() const;
+
+signals:
+    void dispatch(const CaptureRequest& req);
+
+private:
+    struct Entry
+    {
+        CaptureRequest request;
+        QElapsedTimer readySince;
+    };
+
+    void makeReady(const CaptureRequest& req);
+    void scheduleDispatch(int delayMs = 0);
+    void dispatchNext();
+    static bool isInteractive(const CaptureRequest& req);
+
+    QQueue<Entry> m_interactive;
+    QQueue<Entry> m_batch;
+    bool m_interactiveBusy;
+    // Since the capture window closed
+    QElapsedTimer m_interactiveClosed;
+    bool m_dispatchScheduled;
+    Stats m_stats;
+};
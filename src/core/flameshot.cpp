@@ -8,6 +8,7 @@
 #endif
 
 #include "abstractlogger.h"
+#include "metrics.h"
 #include "screenshotsaver.h"
 #include "src/config/configresolver.h"
 #include "src/config/configwindow.h"
@@ -21,12 +22,14 @@
 #endif
 
 #include "src/utils/confighandler.h"
+#include "src/utils/rawimagewriter.h"
+#include "src/utils/resampler.h"
 #include "src/utils/screengrabber.h"
 #include "src/widgets/capture/capturewidget.h"
 #include "src/widgets/capturelauncher.h"
 #include "src/widgets/infowindow.h"
+#include "src/widgets/scrollcapturewidget.h"
 #include <QApplication>
-#include <QBuffer>
 #include <QDebug>
 #include <QDesktopServices>
 #include <QFile>
@@ -40,8 +43,39 @@
 #include <QScreen>
 #endif
 
+namespace {
+
+/**
+ * @brief Resize stage of the export, before any of the tasks encodes the
+ * capture.
+ * @param scale In percent, 0 scales back to the logical size (1x).
+ * @param maxWidth Captures wider than this are downscaled, 0 for no limit.
+ */
+QPixmap scaleForExport(const QPixmap& capture, int scale, int maxWidth)
+{
+    const qreal dpr = capture.devicePixelRatio();
+    qreal factor = scale == 0 ? 1.0 / dpr : scale / 100.0;
+    if (maxWidth > 0 && capture.width() * factor > maxWidth) {
+        factor = qreal(maxWidth) / capture.width();
+    }
+    const QSize size =
+      (QSizeF(capture.size()) * factor).toSize().expandedTo(QSize(1, 1));
+    if (size == capture.size()) {
+        return capture;
+    }
+
+    QPixmap scaled =
+      QPixmap::fromImage(Resampler::resize(capture.toImage(), size));
+    // Keep the logical size, pins stay as large as the selection
+    scaled.setDevicePixelRatio(dpr * size.width() / capture.width());
+    return scaled;
+}
+
+} // unnamed namespace
+
 Flameshot::Flameshot()
   : m_haveExternalWidget(false)
+  , m_scheduler(new CaptureScheduler(this))
   , m_captureWindow(nullptr)
 #if defined(Q_OS_MACOS)
   , m_HotkeyScreenshotCapture(nullptr)
@@ -51,6 +85,11 @@ Flameshot::Flameshot()
     QString StyleSheet = CaptureButton::globalStyleSheet();
     qApp->setStyleSheet(StyleSheet);
 
+    connect(m_scheduler,
+            &CaptureScheduler::dispatch,
+            this,
+            &Flameshot::startCapture);
+
 #if defined(Q_OS_MACOS)
     // Try to take a test screenshot, MacOS will request a "Screen Recording"
     // permissions on the first run. Otherwise it will be hidden under the
@@ -85,6 +124,7 @@ Flameshot* Flameshot::instance()
 CaptureWidget* Flameshot::gui(const CaptureRequest& req)
 {
     if (!resolveAnyConfigErrors()) {
+        reportCaptureFailed(req);
         return nullptr;
     }
 
@@ -117,10 +157,19 @@ CaptureWidget* Flameshot::gui(const CaptureRequest& req)
         if (0 == timeout) {
             QMessageBox::warning(
               nullptr, tr("Error"), tr("Unable to close active modal widgets"));
+            reportCaptureFailed(req);
             return nullptr;
         }
 
         m_captureWindow = new CaptureWidget(req);
+        // Queued interactive requests wait until this window is gone
+        m_scheduler->setInteractiveBusy(true);
+        connect(m_captureWindow, &QObject::destroyed, m_scheduler, [this]() {
+            m_scheduler->setInteractiveBusy(false);
+            if (FlameshotDaemon::instance() != nullptr) {
+                FlameshotDaemon::instance()->reclaimWhenIdle();
+            }
+        });
 
 #ifdef Q_OS_WIN
         m_captureWindow->show();
@@ -135,7 +184,15 @@ CaptureWidget* Flameshot::gui(const CaptureRequest& req)
 #endif
         return m_captureWindow;
     } else {
-        emit captureFailed();
+        // Take the capture once the current one is finished, its delay has
+        // already passed
+        CaptureRequest request = req;
+        request.setDelay(0);
+        if (!m_scheduler->enqueue(request)) {
+            AbstractLogger::warning() << tr("Too many pending captures");
+            Metrics::error(Metrics::QUEUE_FULL);
+            reportCaptureFailed(req);
+        }
         return nullptr;
     }
 }
@@ -143,6 +200,7 @@ CaptureWidget* Flameshot::gui(const CaptureRequest& req)
 void Flameshot::screen(CaptureRequest req, const int screenNumber)
 {
     if (!resolveAnyConfigErrors()) {
+        reportCaptureFailed(req);
         return;
     }
 
@@ -155,12 +213,16 @@ void Flameshot::screen(CaptureRequest req, const int screenNumber)
     } else if (screenNumber >= qApp->screens().count()) {
         AbstractLogger() << QObject::tr(
           "Requested screen exceeds screen count");
-        emit captureFailed();
+        reportCaptureFailed(req);
         return;
     } else {
         screen = qApp->screens()[screenNumber];
     }
-    QPixmap p(ScreenGrabber().grabScreen(screen, ok));
+    QPixmap p;
+    {
+        Metrics::Timer timer(Metrics::GRAB);
+        p = ScreenGrabber().grabScreen(screen, ok);
+    }
     if (ok) {
         QRect geometry = ScreenGrabber().screenGeometry(screen);
         QRect region = req.initialSelection();
@@ -178,18 +240,23 @@ void Flameshot::screen(CaptureRequest req, const int screenNumber)
         }
         exportCapture(p, geometry, req);
     } else {
-        emit captureFailed();
+        reportCaptureFailed(req);
     }
 }
 
 void Flameshot::full(const CaptureRequest& req)
 {
     if (!resolveAnyConfigErrors()) {
+        reportCaptureFailed(req);
         return;
     }
 
     bool ok = true;
-    QPixmap p(ScreenGrabber().grabEntireDesktop(ok));
+    QPixmap p;
+    {
+        Metrics::Timer timer(Metrics::GRAB);
+        p = ScreenGrabber().grabEntireDesktop(ok);
+    }
     QRect region = req.initialSelection();
     if (!region.isNull()) {
         p = p.copy(region);
@@ -198,7 +265,7 @@ void Flameshot::full(const CaptureRequest& req)
         QRect selection; // `flameshot full` does not support --selection
         exportCapture(p, selection, req);
     } else {
-        emit captureFailed();
+        reportCaptureFailed(req);
     }
 }
 
@@ -338,33 +405,39 @@ bool Flameshot::resolveAnyConfigErrors()
 void Flameshot::requestCapture(const CaptureRequest& request)
 {
     if (!resolveAnyConfigErrors()) {
+        reportCaptureFailed(request);
         return;
     }
 
-    switch (request.captureMode()) {
+    if (!m_scheduler->enqueue(request)) {
+        AbstractLogger::warning() << tr("Too many pending captures");
+        Metrics::error(Metrics::QUEUE_FULL);
+        reportCaptureFailed(request);
+    }
+}
+
+/**
+ * @brief Take the capture of a request the scheduler decided to run.
+ */
+void Flameshot::startCapture(const CaptureRequest& req)
+{
+    switch (req.captureMode()) {
         case CaptureRequest::FULLSCREEN_MODE:
-            QTimer::singleShot(request.delay(),
-                               [this, request] { full(request); });
+            full(req);
             break;
-        case CaptureRequest::SCREEN_MODE: {
-            int&& number = request.data().toInt();
-            QTimer::singleShot(request.delay(), [this, request, number]() {
-                screen(request, number);
-            });
+        case CaptureRequest::SCREEN_MODE:
+            screen(req, req.data().toInt());
             break;
-        }
-        case CaptureRequest::GRAPHICAL_MODE: {
-            QTimer::singleShot(
-              request.delay(), this, [this, request]() { gui(request); });
+        case CaptureRequest::GRAPHICAL_MODE:
+            gui(req);
             break;
-        }
         default:
-            emit captureFailed();
+            reportCaptureFailed(req);
             break;
     }
 }
 
-void Flameshot::exportCapture(const QPixmap& capture,
+void Flameshot::exportCapture(const QPixmap& grabbed,
                               QRect& selection,
                               const CaptureRequest& req)
 {
@@ -372,21 +445,38 @@ void Flameshot::exportCapture(const QPixmap& capture,
     int tasks = req.tasks(), mode = req.captureMode();
     QString path = req.path();
 
+    if (tasks & CR::SCROLL) {
+        // The other tasks are run on the stitched capture
+        startScrollCapture(selection, req);
+        return;
+    }
+
+    Metrics::captureExported(req.captureMode());
+    const QPixmap capture =
+      scaleForExport(grabbed, req.exportScale(), req.exportMaxWidth());
+
+    // Requests forwarded by a subcommand print to the subcommand's stdout
+    QIODevice* output = m_requestOutputs.value(req.id(), nullptr);
+    QFile stdoutFile;
+    if (output == nullptr && (tasks & (CR::PRINT_GEOMETRY | CR::PRINT_RAW))) {
+        stdoutFile.open(stdout, QIODevice::WriteOnly);
+        output = &stdoutFile;
+    }
+
     if (tasks & CR::PRINT_GEOMETRY) {
-        QTextStream(stdout)
+        QTextStream(output)
           << selection.width() << "x" << selection.height() << "+"
           << selection.x() << "+" << selection.y() << "\n";
     }
 
     if (tasks & CR::PRINT_RAW) {
-        QByteArray byteArray;
-        QBuffer buffer(&byteArray);
-        capture.save(&buffer, "PNG");
-        if (QFile file; file.open(stdout, QIODevice::WriteOnly)) {
-            file.write(byteArray);
-            file.close();
+        if (!RawImageWriter::write(
+              output, capture.toImage(), req.rawFormat())) {
+            AbstractLogger::error() << tr("Unable to print the raw capture.");
+            Metrics::error(Metrics::PRINT_FAILED);
         }
     }
+    stdoutFile.close();
 
     if (tasks & CR::SAVE) {
         if (req.path().isEmpty()) {
@@ -413,6 +503,9 @@ void Flameshot::exportCapture(const QPixmap& capture,
         if (!ConfigHandler().uploadWithoutConfirmation()) {
             auto* dialog = new ImgUploadDialog();
             if (dialog->exec() == QDialog::Rejected) {
+                // The upload the request asked for never happened
+                m_requestOutputs.remove(req.id());
+                emit requestFinished(req.id(), false);
                 return;
             }
         }
@@ -438,6 +531,88 @@ void Flameshot::exportCapture(const QPixmap& capture,
     if (!(tasks & CR::UPLOAD)) {
         emit captureTaken(capture);
     }
+    m_requestOutputs.remove(req.id());
+    emit requestFinished(req.id(), true);
+}
+
+/**
+ * @brief Export the regions of a multi-selection, all cut from the same
+ * annotated grab.
+ *
+ * With the save task every region is saved, in parallel. The other tasks
+ * work on a single capture and run on the first region.
+ * @param composite The whole grab with its annotations
+ * @param regions In pixels of `composite`
+ * @param selection Geometry of the first region on the screen
+ */
+void Flameshot::exportRegions(const QPixmap& composite,
+                              const QList<QRect>& regions,
+                              QRect& selection,
+                              const CaptureRequest& req)
+{
+    if (regions.isEmpty()) {
+        reportCaptureFailed(req);
+        return;
+    }
+
+    if (req.tasks() & CaptureRequest::SAVE) {
+        QList<QImage> captures;
+        for (const QRect& region : regions) {
+            captures.append(scaleForExport(composite.copy(region),
+                                           req.exportScale(),
+                                           req.exportMaxWidth())
+                              .toImage());
+        }
+        saveRegionsToFilesystem(captures, req.path());
+    }
+
+    CaptureRequest request = req;
+    request.removeTask(CaptureRequest::SAVE);
+    exportCapture(composite.copy(regions.first()), selection, request);
+}
+
+/**
+ * @brief Print the raw capture and geometry of the given request to `output`
+ * instead of stdout. The device is not owned and must stay valid until
+ * `requestFinished` is emitted for the request.
+ */
+void Flameshot::setRequestOutput(uint requestId, QIODevice* output)
+{
+    m_requestOutputs.insert(requestId, output);
+}
+
+CaptureScheduler::Stats Flameshot::captureQueueStats() const
+{
+    return m_scheduler->stats();
+}
+
+void Flameshot::startScrollCapture(const QRect& region,
+                                   const CaptureRequest& req)
+{
+    CaptureRequest request = req;
+    request.removeTask(CaptureRequest::SCROLL);
+    auto* widget = new ScrollCaptureWidget(region);
+    connect(widget,
+            &ScrollCaptureWidget::finished,
+            this,
+            [this, region, request](const QPixmap& capture) {
+                QRect selection(region.topLeft(),
+                                capture.deviceIndependentSize().toSize());
+                exportCapture(capture, selection, request);
+            });
+    connect(widget, &ScrollCaptureWidget::canceled, this, [this, request]() {
+        reportCaptureFailed(request);
+    });
+    widget->show();
+    widget->activateWindow();
+}
+
+void Flameshot::reportCaptureFailed(const CaptureRequest& req)
+{
+    Metrics::captureFailed(req.captureMode());
+    m_requestOutputs.remove(req.id());
+    emit captureFailed();
+    emit requestFinished(req.id(), false);
 }
 
 void Flameshot::setExternalWidget(bool b)
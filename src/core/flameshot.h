@@ -4,6 +4,8 @@
 #pragma once
 
 #include "src/core/capturerequest.h"
+#include "src/core/capturescheduler.h"
+#include <QHash>
 #include <QObject>
 #include <QPointer>
 #include <QVersionNumber>
@@ -12,6 +14,7 @@ class CaptureWidget;
 class ConfigWindow;
 class InfoWindow;
 class CaptureLauncher;
+class QIODevice;
 #ifdef ENABLE_IMGUR
 class UploadHistory;
 #endif
@@ -66,24 +69,38 @@ public:
     static Origin origin();
     void setExternalWidget(bool b);
     bool haveExternalWidget();
+    void setRequestOutput(uint requestId, QIODevice* output);
+    void reportCaptureFailed(const CaptureRequest& req);
+    CaptureScheduler::Stats captureQueueStats() const;
 
 signals:
     void captureTaken(QPixmap p);
     void captureFailed();
+    // Emitted once for every request, after its export or failure
+    void requestFinished(uint requestId, bool success);
 
 public slots:
     void requestCapture(const CaptureRequest& request);
     void exportCapture(const QPixmap& p,
                        QRect& selection,
                        const CaptureRequest& req);
+    void exportRegions(const QPixmap& composite,
+                       const QList<QRect>& regions,
+                       QRect& selection,
+                       const CaptureRequest& req);
 
 private:
     Flameshot();
     bool resolveAnyConfigErrors();
+    void startCapture(const CaptureRequest& req);
+    void startScrollCapture(const QRect& region, const CaptureRequest& req);
 
     // class members
     static Origin m_origin;
     bool m_haveExternalWidget;
+    // Where to print raw captures and geometries of forwarded requests
+    QHash<uint, QIODevice*> m_requestOutputs;
+    CaptureScheduler* m_scheduler;
 
     QPointer<CaptureWidget> m_captureWindow;
     QPointer<InfoWindow> m_infoWindow;
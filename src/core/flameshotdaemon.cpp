@@ -3,20 +3,63 @@
 #include "abstractlogger.h"
 #include "confighandler.h"
 #include "flameshot.h"
+#include "metrics.h"
+#include "metricsserver.h"
 #include "pinwidget.h"
 #include "screenshotsaver.h"
+#include "src/tools/iconatlas.h"
+#include "src/utils/bufferpool.h"
 #include "src/utils/globalvalues.h"
+#include "src/utils/monitortopology.h"
+#include "src/utils/qoi.h"
 #include "src/widgets/capture/capturewidget.h"
 #include "src/widgets/trayicon.h"
 #include <QApplication>
 #include <QClipboard>
+#include <QDataStream>
 #include <QIODevice>
 #include <QPixmap>
+#include <QPixmapCache>
 #include <QRect>
+#include <QTimer>
 
 #if !(defined(Q_OS_MACOS) || defined(Q_OS_WIN))
+#include "capturerequest.h"
 #include <QDBusConnection>
+#include <QDBusConnectionInterface>
 #include <QDBusMessage>
+#include <QDBusServiceWatcher>
+#include <QDBusUnixFileDescriptor>
+#include <QEventLoop>
+#include <QFile>
+#include <unistd.h>
+
+/**
+ * @brief Waits in a subcommand for the daemon to finish a forwarded capture.
+ */
+class ForwardedCaptureWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    uint requestId = 0;
+    bool finished = false;
+    bool success = false;
+
+public slots:
+    void captureFinished(uint id, bool ok)
+    {
+        if (id != requestId) {
+            return;
+        }
+        finished = true;
+        success = ok;
+        emit done();
+    }
+
+signals:
+    void done();
+};
 #endif
 
 #if !defined(DISABLE_UPDATE_CHECKER)
@@ -39,6 +82,35 @@
 #include "src/core/globalshortcutfilter.h"
 #endif
 
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace {
+
+// Wait after the last capture or pin closed before reclaiming memory
+const int RECLAIM_DELAY_MS = 5000;
+
+// Captures sent to the daemon are QOI encoded rather than PNG, as QDataStream
+// does for a QPixmap. The bytes never leave the machine, so the much faster
+// encoder is worth more than the few percent PNG would save.
+void writeCapture(QDataStream& stream, const QPixmap& capture)
+{
+    stream << Qoi::encode(capture.toImage()) << capture.devicePixelRatio();
+}
+
+QPixmap readCapture(QDataStream& stream)
+{
+    QByteArray data;
+    qreal devicePixelRatio = 1.0;
+    stream >> data >> devicePixelRatio;
+    QPixmap capture = QPixmap::fromImage(Qoi::decode(data));
+    capture.setDevicePixelRatio(devicePixelRatio);
+    return capture;
+}
+
+} // unnamed namespace
+
 /**
  * @brief A way of accessing the flameshot daemon both from the daemon itself,
  * and from subcommands.
@@ -70,12 +142,21 @@ FlameshotDaemon::FlameshotDaemon()
   , m_hostingClipboard(false)
   , m_clipboardSignalBlocked(false)
   , m_trayIcon(nullptr)
+  , m_metricsServer(nullptr)
+  , m_reclaimTimer(new QTimer(this))
 #if !defined(DISABLE_UPDATE_CHECKER)
   , m_appLatestVersion(QStringLiteral(APP_VERSION).replace("v", ""))
   , m_showManualCheckAppUpdateStatus(false)
   , m_networkCheckUpdates(nullptr)
 #endif
 {
+    m_reclaimTimer->setSingleShot(true);
+    m_reclaimTimer->setInterval(RECLAIM_DELAY_MS);
+    connect(m_reclaimTimer,
+            &QTimer::timeout,
+            this,
+            &FlameshotDaemon::reclaimMemory);
+
     connect(
       QApplication::clipboard(), &QClipboard::dataChanged, this, [this]() {
           if (!m_hostingClipboard || m_clipboardSignalBlocked) {
@@ -104,6 +185,19 @@ FlameshotDaemon::FlameshotDaemon()
         getLatestAvailableVersion();
     }
 #endif
+
+#if !(defined(Q_OS_MACOS) || defined(Q_OS_WIN))
+    connect(Flameshot::instance(),
+            &Flameshot::requestFinished,
+            this,
+            &FlameshotDaemon::finishForwardedCapture);
+#endif
+    // Captures without the editor never open a window whose close would
+    // schedule the reclaim
+    connect(Flameshot::instance(),
+            &Flameshot::requestFinished,
+            this,
+            &FlameshotDaemon::reclaimWhenIdle);
 }
 
 void FlameshotDaemon::start()
@@ -113,6 +207,17 @@ void FlameshotDaemon::start()
         // Tray icon needs FlameshotDaemon::instance() to be non-null
         m_instance->initTrayIcon();
         qApp->setQuitOnLastWindowClosed(false);
+        // Compute the monitor layout and rasterize the tool icons now so the
+        // first capture does not pay for it
+        for (const auto& output :
+             MonitorTopology::instance()->snapshot().outputs) {
+            IconAtlas::instance()->warmUp(output.devicePixelRatio);
+        }
+        const QString metricsSocket = ConfigHandler().metricsSocket();
+        if (!metricsSocket.isEmpty()) {
+            m_instance->m_metricsServer = new MetricsServer(m_instance);
+            m_instance->m_metricsServer->listen(metricsSocket);
+        }
     }
 }
 
@@ -129,10 +234,13 @@ void FlameshotDaemon::createPin(const QPixmap& capture, QRect geometry)
 #if defined(USE_KDSINGLEAPPLICATION) &&                                        \
   (defined(Q_OS_MACOS) || defined(Q_OS_WIN))
     auto kdsa = KDSingleApplication(QStringLiteral("org.flameshot.Flameshot"));
-    stream << QStringLiteral("attachPin") << capture << geometry;
+    stream << QStringLiteral("attachPin");
+    writeCapture(stream, capture);
+    stream << geometry;
     kdsa.sendMessage(data);
 #else
-    stream << capture << geometry;
+    writeCapture(stream, capture);
+    stream << geometry;
     QDBusMessage m = createMethodCall(QStringLiteral("attachPin"));
     m << data;
     call(m);
@@ -159,10 +267,11 @@ void FlameshotDaemon::copyToClipboard(const QPixmap& capture)
 #if defined(Q_OS_WIN)
     auto kdsa = KDSingleApplication(QStringLiteral("org.flameshot.Flameshot"));
 #endif
-    stream << QStringLiteral("attachScreenshotToClipboard") << capture;
+    stream << QStringLiteral("attachScreenshotToClipboard");
+    writeCapture(stream, capture);
     kdsa.sendMessage(data);
 #else
-    stream << capture;
+    writeCapture(stream, capture);
     QDBusMessage m =
       createMethodCall(QStringLiteral("attachScreenshotToClipboard"));
 
@@ -200,6 +309,72 @@ void FlameshotDaemon::copyToClipboard(const QString& text,
 #endif
 }
 
+#if !(defined(Q_OS_MACOS) || defined(Q_OS_WIN))
+/**
+ * @brief Let the running daemon take the capture and wait until it is done.
+ *
+ * The daemon already runs a QApplication with everything loaded, so this
+ * spares the subcommand the startup of the GUI. The daemon writes raw
+ * captures and geometries straight to the stdout of this process, which is
+ * sent along with the request.
+ * @param exitCode Set to the exit code the subcommand should return.
+ * @return false if no daemon could take the request, in which case the
+ * capture has to be taken by this process.
+ */
+bool FlameshotDaemon::forwardCapture(const CaptureRequest& req, int& exitCode)
+{
+    QDBusConnection sessionBus = QDBusConnection::sessionBus();
+    const QString service = QStringLiteral("org.flameshot.Flameshot");
+    if (!sessionBus.isConnected() ||
+        !sessionBus.interface()->isServiceRegistered(service) ||
+        !(sessionBus.connectionCapabilities() &
+          QDBusConnection::UnixFileDescriptorPassing)) {
+        return false;
+    }
+
+    // Subscribe before sending the request, so the signal can't be missed
+    ForwardedCaptureWatcher watcher;
+    sessionBus.connect(service,
+                       QStringLiteral("/"),
+                       QStringLiteral("org.flameshot.Flameshot"),
+                       QStringLiteral("captureFinished"),
+                       &watcher,
+                       SLOT(captureFinished(uint, bool)));
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << req;
+    QDBusMessage m = createMethodCall(QStringLiteral("requestCapture"));
+    m << data << QVariant::fromValue(QDBusUnixFileDescriptor(STDOUT_FILENO));
+    const QDBusMessage reply = sessionBus.call(m);
+    if (reply.type() != QDBusMessage::ReplyMessage ||
+        reply.arguments().isEmpty()) {
+        // E.g. a daemon of an older version that doesn't know the method
+        return false;
+    }
+    watcher.requestId = reply.arguments().constFirst().toUInt();
+
+    QEventLoop loop;
+    QDBusServiceWatcher serviceWatcher(
+      service, sessionBus, QDBusServiceWatcher::WatchForUnregistration);
+    QObject::connect(
+      &watcher, &ForwardedCaptureWatcher::done, &loop, &QEventLoop::quit);
+    // Don't wait forever if the daemon goes away in the meantime
+    QObject::connect(&serviceWatcher,
+                     &QDBusServiceWatcher::serviceUnregistered,
+                     &loop,
+                     &QEventLoop::quit);
+    loop.exec();
+
+    if (!watcher.finished) {
+        exitCode = E_GENERAL;
+    } else {
+        exitCode = watcher.success ? E_OK : E_ABORTED;
+    }
+    return true;
+}
+#endif
+
 /**
  * @brief Is this instance of flameshot hosting any windows as a daemon?
  */
@@ -208,6 +383,26 @@ bool FlameshotDaemon::isThisInstanceHostingWidgets()
     return instance() && !instance()->m_widgets.isEmpty();
 }
 
+int FlameshotDaemon::pinCount() const
+{
+    int count = 0;
+    for (QWidget* widget : m_widgets) {
+        count += qobject_cast<PinWidget*>(widget) != nullptr ? 1 : 0;
+    }
+    return count;
+}
+
+qint64 FlameshotDaemon::pinMemory() const
+{
+    qint64 bytes = 0;
+    for (QWidget* widget : m_widgets) {
+        if (auto* pin = qobject_cast<PinWidget*>(widget)) {
+            bytes += pin->pixmapBytes();
+        }
+    }
+    return bytes;
+}
+
 void FlameshotDaemon::sendTrayNotification(const QString& text,
                                            const QString& title,
                                            const int timeout)
@@ -221,7 +416,8 @@ void FlameshotDaemon::sendTrayNotification(const QString& text,
 #if !defined(DISABLE_UPDATE_CHECKER)
 void FlameshotDaemon::showUpdateNotificationIfAvailable(CaptureWidget* widget)
 {
-    if (!m_appLatestUrl.isEmpty() &&
+    // The capture may have been queued instead of opening a window
+    if (widget != nullptr && !m_appLatestUrl.isEmpty() &&
         ConfigHandler().ignoreUpdateToVersion().compare(m_appLatestVersion) <
           0) {
         widget->showAppUpdateNotification(m_appLatestVersion, m_appLatestUrl);
@@ -300,6 +496,44 @@ FlameshotDaemon* FlameshotDaemon::instance()
     return m_instance;
 }
 
+/**
+ * @brief Return the memory of a capture session to the system once the daemon
+ * has been idle for a few seconds. Called when a request finishes and when
+ * the editor or a pin closes, a later call restarts the wait.
+ */
+void FlameshotDaemon::reclaimWhenIdle()
+{
+    m_reclaimTimer->start();
+}
+
+void FlameshotDaemon::reclaimMemory()
+{
+    if (!m_widgets.isEmpty()) {
+        return;
+    }
+    for (QWidget* widget : QApplication::topLevelWidgets()) {
+        if (qobject_cast<CaptureWidget*>(widget) != nullptr) {
+            return;
+        }
+    }
+
+    const qint64 before = Metrics::residentMemory();
+    QPixmapCache::clear();
+    IconAtlas::instance()->releaseIcons();
+    BufferPool::instance()->trim();
+#if defined(__GLIBC__)
+    // Freed desktop buffers stay in the heap arenas until they are trimmed
+    malloc_trim(0);
+#endif
+    const qint64 after = Metrics::residentMemory();
+    if (before >= 0 && after >= 0) {
+        AbstractLogger::info(AbstractLogger::Stderr | AbstractLogger::LogFile)
+          << tr("Idle memory reclaimed, resident memory %1 MiB -> %2 MiB")
+               .arg(before / 1048576.0, 0, 'f', 1)
+               .arg(after / 1048576.0, 0, 'f', 1);
+    }
+}
+
 /**
  * @brief Quit the daemon if it has nothing to do and the 'persist' flag is not
  * set.
@@ -323,6 +557,7 @@ void FlameshotDaemon::attachPin(const QPixmap& pixmap, QRect geometry)
     connect(pinWidget, &QObject::destroyed, this, [=, this]() {
         m_widgets.removeOne(pinWidget);
         quitIfIdle();
+        reclaimWhenIdle();
     });
 
     pinWidget->show();
@@ -337,7 +572,10 @@ void FlameshotDaemon::attachScreenshotToClipboard(const QPixmap& pixmap)
     // This variable is necessary because the signal doesn't get blocked on
     // windows for some reason
     m_clipboardSignalBlocked = true;
-    saveToClipboard(pixmap);
+    {
+        Metrics::Timer timer(Metrics::CLIPBOARD);
+        saveToClipboard(pixmap);
+    }
     clipboard->blockSignals(false);
 }
 
@@ -346,10 +584,8 @@ void FlameshotDaemon::attachScreenshotToClipboard(const QPixmap& pixmap)
 void FlameshotDaemon::attachPin(const QByteArray& data)
 {
     QDataStream stream(data);
-    QPixmap pixmap;
+    QPixmap pixmap = readCapture(stream);
     QRect geometry;
-
-    stream >> pixmap;
     stream >> geometry;
 
     attachPin(pixmap, geometry);
@@ -358,8 +594,7 @@ void FlameshotDaemon::attachPin(const QByteArray& data)
 void FlameshotDaemon::attachScreenshotToClipboard(const QByteArray& screenshot)
 {
     QDataStream stream(screenshot);
-    QPixmap p;
-    stream >> p;
+    QPixmap p = readCapture(stream);
 
     attachScreenshotToClipboard(p);
 }
@@ -455,6 +690,38 @@ void FlameshotDaemon::handleReplyCheckUpdates(QNetworkReply* reply)
 #endif
 
 #if !(defined(Q_OS_MACOS) || defined(Q_OS_WIN))
+uint FlameshotDaemon::requestCapture(const QByteArray& data, int outputFd)
+{
+    QDataStream stream(data);
+    CaptureRequest req(CaptureRequest::GRAPHICAL_MODE);
+    stream >> req;
+
+    auto* output = new QFile();
+    if (outputFd >= 0) {
+        output->open(
+          dup(outputFd), QIODevice::WriteOnly, QFileDevice::AutoCloseHandle);
+    }
+    m_forwardedCaptures.insert(req.id(), output);
+    Flameshot::instance()->setRequestOutput(req.id(), output);
+
+    // Reply to the subcommand first, it needs the id to recognize the signal
+    // telling that the capture is finished
+    QTimer::singleShot(
+      0, this, [req]() { Flameshot::instance()->requestCapture(req); });
+    return req.id();
+}
+
+void FlameshotDaemon::finishForwardedCapture(uint requestId, bool success)
+{
+    QFile* output = m_forwardedCaptures.take(requestId);
+    if (output == nullptr) {
+        // Not a request from a subcommand
+        return;
+    }
+    delete output;
+    emit captureFinished(requestId, success);
+}
+
 QDBusMessage FlameshotDaemon::createMethodCall(const QString& method)
 {
     QDBusMessage m =
@@ -497,9 +764,9 @@ void FlameshotDaemon::messageReceivedFromSecondaryInstance(
     // qDebug() << "Method:" << methodCall;
 
     if (methodCall == QStringLiteral("attachPin")) {
-        QPixmap capture;
+        QPixmap capture = readCapture(stream);
         QRect geometry;
-        stream >> capture >> geometry;
+        stream >> geometry;
         // qDebug() << "Pixmap:" << capture;
         // qDebug() << "Geometry:" << geometry;
         if (!capture.isNull()) {
@@ -509,8 +776,7 @@ void FlameshotDaemon::messageReceivedFromSecondaryInstance(
                           "pixmap is empty!";
         }
     } else if (methodCall == QStringLiteral("attachScreenshotToClipboard")) {
-        QPixmap capture;
-        stream >> capture;
+        QPixmap capture = readCapture(stream);
         // qDebug() << "Pixmap:" << capture;
         if (!capture.isNull()) {
             FlameshotDaemon::instance()->attachScreenshotToClipboard(capture);
@@ -540,3 +806,7 @@ void FlameshotDaemon::messageReceivedFromSecondaryInstance(
 
 // STATIC ATTRIBUTES
 FlameshotDaemon* FlameshotDaemon::m_instance = nullptr;
+
+#if !(defined(Q_OS_MACOS) || defined(Q_OS_WIN))
+#include "flameshotdaemon.moc"
+#endif
@@ -4,15 +4,20 @@
 #include <QObject>
 
 #if !(defined(Q_OS_MACOS) || defined(Q_OS_WIN))
+#include <QHash>
 #include <QtDBus/QDBusAbstractAdaptor>
 #endif
 
+class CaptureRequest;
+class QFile;
 class QPixmap;
 class QRect;
 class QDBusMessage;
 class QDBusConnection;
 class TrayIcon;
 class CaptureWidget;
+class MetricsServer;
+class QTimer;
 
 #if !defined(DISABLE_UPDATE_CHECKER)
 class QNetworkAccessManager;
@@ -31,6 +36,14 @@ public:
     static void copyToClipboard(const QString& text,
                                 const QString& notification = "");
     static bool isThisInstanceHostingWidgets();
+#if !(defined(Q_OS_MACOS) || defined(Q_OS_WIN))
+    static bool forwardCapture(const CaptureRequest& req, int& exitCode);
+#endif
+
+    void reclaimWhenIdle();
+
+    int pinCount() const;
+    qint64 pinMemory() const;
 
     void sendTrayNotification(
       const QString& text,
@@ -58,9 +71,15 @@ signals:
     void newVersionAvailable(QVersionNumber version);
 #endif
 
+#if !(defined(Q_OS_MACOS) || defined(Q_OS_WIN))
+signals:
+    void captureFinished(uint requestId, bool success);
+#endif
+
 private:
     FlameshotDaemon();
     void quitIfIdle();
+    void reclaimMemory();
     void attachPin(const QPixmap& pixmap, QRect geometry);
     void attachScreenshotToClipboard(const QPixmap& pixmap);
 
@@ -73,6 +92,9 @@ private:
     void enableTrayIcon(bool enable);
 
 #if !(defined(Q_OS_MACOS) || defined(Q_OS_WIN))
+    uint requestCapture(const QByteArray& data, int outputFd);
+    void finishForwardedCapture(uint requestId, bool success);
+
     static QDBusMessage createMethodCall(const QString& method);
     static void checkDBusConnection(const QDBusConnection& connection);
     static void call(const QDBusMessage& m);
@@ -83,6 +105,8 @@ private:
     bool m_clipboardSignalBlocked;
     QList<QWidget*> m_widgets;
     TrayIcon* m_trayIcon;
+    MetricsServer* m_metricsServer;
+    QTimer* m_reclaimTimer;
 
 #if !defined(DISABLE_UPDATE_CHECKER)
     QString m_appLatestUrl;
@@ -94,6 +118,9 @@ private:
     static FlameshotDaemon* m_instance;
 
 #if !(defined(Q_OS_MACOS) || defined(Q_OS_WIN))
+    // Requests forwarded by subcommands, with their stdout
+    QHash<uint, QFile*> m_forwardedCaptures;
+
     friend class FlameshotDBusAdapter;
 #endif
 };
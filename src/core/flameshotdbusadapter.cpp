@@ -2,11 +2,17 @@
 // SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
 
 #include "flameshotdbusadapter.h"
+#include "src/core/flameshot.h"
 #include "src/core/flameshotdaemon.h"
 
 FlameshotDBusAdapter::FlameshotDBusAdapter(QObject* parent)
   : QDBusAbstractAdaptor(parent)
-{}
+{
+    connect(FlameshotDaemon::instance(),
+            &FlameshotDaemon::captureFinished,
+            this,
+            &FlameshotDBusAdapter::captureFinished);
+}
 
 FlameshotDBusAdapter::~FlameshotDBusAdapter() = default;
 
@@ -25,3 +31,27 @@ void FlameshotDBusAdapter::attachPin(const QByteArray& data)
 {
     FlameshotDaemon::instance()->attachPin(data);
 }
+
+uint FlameshotDBusAdapter::requestCapture(const QByteArray& request,
+                                          const QDBusUnixFileDescriptor& output)
+{
+    return FlameshotDaemon::instance()->requestCapture(
+      request, output.isValid() ? output.fileDescriptor() : -1);
+}
+
+QVariantMap FlameshotDBusAdapter::captureQueueStats()
+{
+    const CaptureScheduler::Stats stats =
+      Flameshot::instance()->captureQueueStats();
+    const qint64 avgWaitMs =
+      stats.dispatched > 0
+        ? stats.totalWaitMs / static_cast<qint64>(stats.dispatched)
+        : 0;
+    return { { "queued", stats.queued },
+             { "peakQueued", stats.peakQueued },
+             { "dispatched", stats.dispatched },
+             { "rejected", stats.rejected },
+             { "lastWaitMs", stats.lastWaitMs },
+             { "maxWaitMs", stats.maxWaitMs },
+             { "avgWaitMs", avgWaitMs } };
+}
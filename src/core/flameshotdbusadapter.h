@@ -3,7 +3,9 @@
 
 #pragma once
 
+#include <QVariantMap>
 #include <QtDBus/QDBusAbstractAdaptor>
+#include <QtDBus/QDBusUnixFileDescriptor>
 
 class FlameshotDBusAdapter : public QDBusAbstractAdaptor
 {
@@ -19,4 +21,10 @@ public slots:
     Q_NOREPLY void attachTextToClipboard(const QString& text,
                                          const QString& notification);
     Q_NOREPLY void attachPin(const QByteArray& data);
+    uint requestCapture(const QByteArray& request,
+                        const QDBusUnixFileDescriptor& output);
+    QVariantMap captureQueueStats();
+
+signals:
+    void captureFinished(uint requestId, bool success);
 };
@@ -0,0 +1,238 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "metrics.h"
+#include <QFile>
+#include <atomic>
+
+#if defined(Q_OS_LINUX)
+#include <unistd.h>
+#endif
+
+namespace {
+
+const int MODE_COUNT = 3;
+
+// Upper bounds of the latency buckets, in nanoseconds. The last bucket, +Inf,
+// is implicit.
+const qint64 BUCKET_BOUNDS[] = { 1000000,   2500000,   5000000,    10000000,
+                                 25000000,  50000000,  100000000,  250000000,
+                                 500000000, 1000000000, 2500000000, 5000000000,
+                                 10000000000 };
+const char* const BUCKET_LABELS[] = { "0.001", "0.0025", "0.005", "0.01",
+                                      "0.025", "0.05",   "0.1",   "0.25",
+                                      "0.5",   "1",      "2.5",   "5",
+                                      "10" };
+const int BUCKET_COUNT = sizeof(BUCKET_BOUNDS) / sizeof(BUCKET_BOUNDS[0]);
+
+const char* const MODE_NAMES[MODE_COUNT] = { "full", "gui", "screen" };
+const char* const STAGE_NAMES[Metrics::STAGE_COUNT] = {
+    "grab", "encode", "write", "clipboard", "settings_open"
+};
+const char* const BACKEND_NAMES[Metrics::BACKEND_COUNT] = {
+    "qt", "portal", "grim", "wlr_screencopy"
+};
+const char* const ERROR_NAMES[Metrics::ERROR_COUNT] = { "grab",
+                                                        "save",
+                                                        "print",
+                                                        "queue_full" };
+
+using Counter = std::atomic<quint64>;
+
+struct Histogram
+{
+    // Not cumulative, summed up when rendered
+    Counter buckets[BUCKET_COUNT + 1];
+    Counter sumNsecs;
+};
+
+// Zero-initialized, as they have static storage
+Counter capturesExported[MODE_COUNT];
+Counter capturesFailed[MODE_COUNT];
+Counter grabs[Metrics::BACKEND_COUNT][2];
+Counter errors[Metrics::ERROR_COUNT];
+Histogram histograms[Metrics::STAGE_COUNT];
+
+inline void increment(Counter& counter, quint64 value = 1)
+{
+    counter.fetch_add(value, std::memory_order_relaxed);
+}
+
+inline quint64 load(const Counter& counter)
+{
+    return counter.load(std::memory_order_relaxed);
+}
+
+inline int modeIndex(CaptureRequest::CaptureMode mode)
+{
+    return qBound(0, int(mode), MODE_COUNT - 1);
+}
+
+void appendHeader(QByteArray& out,
+                  const char* name,
+                  const char* type,
+                  const char* help)
+{
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+void appendSample(QByteArray& out,
+                  const char* name,
+                  const QByteArray& labels,
+                  quint64 value)
+{
+    out += name;
+    if (!labels.isEmpty()) {
+        out += '{' + labels + '}';
+    }
+    out += ' ' + QByteArray::number(value) + '\n';
+}
+
+QByteArray label(const char* name, const char* value)
+{
+    return QByteArray(name) + "=\"" + value + '"';
+}
+
+} // unnamed namespace
+
+namespace Metrics {
+
+void captureExported(CaptureRequest::CaptureMode mode)
+{
+    increment(capturesExported[modeIndex(mode)]);
+}
+
+void captureFailed(CaptureRequest::CaptureMode mode)
+{
+    increment(capturesFailed[modeIndex(mode)]);
+}
+
+void grabbed(Backend backend, bool ok)
+{
+    increment(grabs[backend][ok ? 0 : 1]);
+    if (!ok) {
+        increment(errors[GRAB_FAILED]);
+    }
+}
+
+void error(Error error)
+{
+    increment(errors[error]);
+}
+
+void observe(Stage stage, qint64 nsecs)
+{
+    int bucket = 0;
+    while (bucket < BUCKET_COUNT && nsecs > BUCKET_BOUNDS[bucket]) {
+        ++bucket;
+    }
+    Histogram& histogram = histograms[stage];
+    increment(histogram.buckets[bucket]);
+    increment(histogram.sumNsecs, quint64(qMax(qint64(0), nsecs)));
+}
+
+qint64 residentMemory()
+{
+#if defined(Q_OS_LINUX)
+    // Second field of statm, in pages
+    QFile statm(QStringLiteral("/proc/self/statm"));
+    if (!statm.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    const QList<QByteArray> fields = statm.readAll().split(' ');
+    if (fields.size() < 2) {
+        return -1;
+    }
+    return fields[1].toLongLong() * sysconf(_SC_PAGESIZE);
+#else
+    return -1;
+#endif
+}
+
+QByteArray render()
+{
+    QByteArray out;
+
+    appendHeader(out,
+                 "flameshot_captures_total",
+                 "counter",
+                 "Captures exported, by capture mode.");
+    for (int m = 0; m < MODE_COUNT; ++m) {
+        appendSample(out,
+                     "flameshot_captures_total",
+                     label("mode", MODE_NAMES[m]),
+                     load(capturesExported[m]));
+    }
+    appendHeader(out,
+                 "flameshot_capture_failures_total",
+                 "counter",
+                 "Captures aborted or failed, by capture mode.");
+    for (int m = 0; m < MODE_COUNT; ++m) {
+        appendSample(out,
+                     "flameshot_capture_failures_total",
+                     label("mode", MODE_NAMES[m]),
+                     load(capturesFailed[m]));
+    }
+
+    appendHeader(out,
+                 "flameshot_grabs_total",
+                 "counter",
+                 "Screen grabs, by backend and result.");
+    for (int b = 0; b < BACKEND_COUNT; ++b) {
+        for (int r = 0; r < 2; ++r) {
+            appendSample(out,
+                         "flameshot_grabs_total",
+                         label("backend", BACKEND_NAMES[b]) + ',' +
+                           label("result", r == 0 ? "ok" : "error"),
+                         load(grabs[b][r]));
+        }
+    }
+
+    appendHeader(out,
+                 "flameshot_errors_total",
+                 "counter",
+                 "Errors, by kind.");
+    for (int e = 0; e < ERROR_COUNT; ++e) {
+        appendSample(out,
+                     "flameshot_errors_total",
+                     label("kind", ERROR_NAMES[e]),
+                     load(errors[e]));
+    }
+
+    appendHeader(out,
+                 "flameshot_stage_duration_seconds",
+                 "histogram",
+                 "Duration of the stages of a capture, and of opening the "
+                 "configuration window.");
+    for (int s = 0; s < STAGE_COUNT; ++s) {
+        const Histogram& histogram = histograms[s];
+        const QByteArray stage = label("stage", STAGE_NAMES[s]);
+        quint64 cumulative = 0;
+        for (int b = 0; b <= BUCKET_COUNT; ++b) {
+            cumulative += load(histogram.buckets[b]);
+            const char* le = b < BUCKET_COUNT ? BUCKET_LABELS[b] : "+Inf";
+            appendSample(out,
+                         "flameshot_stage_duration_seconds_bucket",
+                         stage + ',' + label("le", le),
+                         cumulative);
+        }
+        out += "flameshot_stage_duration_seconds_sum{" + stage + "} " +
+               QByteArray::number(load(histogram.sumNsecs) / 1e9, 'g', 9) +
+               '\n';
+        // The counters keep changing while this runs, the count is taken
+        // from the buckets so that it matches the +Inf bucket
+        appendSample(
+          out, "flameshot_stage_duration_seconds_count", stage, cumulative);
+    }
+    return out;
+}
+
+} // namespace Metrics
@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "src/core/capturerequest.h"
+#include <QByteArray>
+#include <QElapsedTimer>
+
+/**
+ * @brief Counters and latency histograms of the capture pipeline, served by
+ * MetricsServer in the Prometheus text format.
+ *
+ * Updates are relaxed atomic increments with fixed buckets, no locks and no
+ * allocations, so they can be called from any thread and on every capture.
+ */
+namespace Metrics {
+
+enum Stage
+{
+    // Taking the screenshot
+    GRAB,
+    // Encoding a capture to an image format, streamed to its destination
+    ENCODE,
+    // Saving a capture to a file, encoding included
+    WRITE,
+    // Handing a capture over to the clipboard
+    CLIPBOARD,
+    // Opening the configuration window, until its first page is painted
+    SETTINGS_OPEN,
+    STAGE_COUNT
+};
+
+enum Backend
+{
+    // QScreen::grabWindow, on X11, Windows and macOS
+    QT,
+    PORTAL,
+    GRIM,
+    WLR_SCREENCOPY,
+    BACKEND_COUNT
+};
+
+enum Error
+{
+    GRAB_FAILED,
+    SAVE_FAILED,
+    PRINT_FAILED,
+    QUEUE_FULL,
+    ERROR_COUNT
+};
+
+void captureExported(CaptureRequest::CaptureMode mode);
+void captureFailed(CaptureRequest::CaptureMode mode);
+void grabbed(Backend backend, bool ok);
+void error(Error error);
+void observe(Stage stage, qint64 nsecs);
+
+// Observes the duration of a stage, from construction to destruction
+class Timer
+{
+public:
+    explicit Timer(Stage stage)
+      : m_stage(stage)
+    {
+        m_timer.start();
+    }
+    ~Timer() { observe(m_stage, m_timer.nsecsElapsed()); }
+
+    Timer(const Timer&) = delete;
+    Timer& operator=(const Timer&) = delete;
+
+private:
+    Stage m_stage;
+    QElapsedTimer m_timer;
+};
+
+// Resident set size of the process in bytes, -1 where it is not known
+qint64 residentMemory();
+
+// The counters and histograms in the Prometheus text format
+QByteArray render();
+
+} // namespace Metrics
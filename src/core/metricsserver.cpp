@@ -0,0 +1,191 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "metricsserver.h"
+#include "abstractlogger.h"
+#include "flameshot.h"
+#include "flameshotdaemon.h"
+#include "metrics.h"
+#include "src/utils/history.h"
+#include <QDir>
+#include <QFile>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QTimer>
+
+#if defined(Q_OS_UNIX)
+#include <sys/stat.h>
+#endif
+
+namespace {
+
+// Clients that don't send a request within this time get the bare text
+const int REQUEST_TIMEOUT_MS = 500;
+// A daemon still serving the socket answers well within this time
+const int PROBE_TIMEOUT_MS = 200;
+
+// A socket file left behind by a daemon that crashed. A file that is not a
+// socket, or a socket another daemon still listens on, is left alone.
+bool isStaleSocket(const QString& path)
+{
+#if defined(Q_OS_UNIX)
+    struct stat info;
+    if (lstat(QFile::encodeName(path).constData(), &info) != 0 ||
+        !S_ISSOCK(info.st_mode)) {
+        return false;
+    }
+    QLocalSocket probe;
+    probe.connectToServer(path);
+    return !probe.waitForConnected(PROBE_TIMEOUT_MS);
+#else
+    // Named pipes leave nothing behind
+    Q_UNUSED(path)
+    return false;
+#endif
+}
+
+void appendGauge(QByteArray& out,
+                 const char* name,
+                 const char* help,
+                 qint64 value,
+                 const char* type = "gauge")
+{
+    out += QByteArray("# HELP ") + name + ' ' + help + '\n';
+    out += QByteArray("# TYPE ") + name + ' ' + type + '\n';
+    out += QByteArray(name) + ' ' + QByteArray::number(value) + '\n';
+}
+
+} // unnamed namespace
+
+MetricsServer::MetricsServer(QObject* parent)
+  : QObject(parent)
+  , m_server(new QLocalServer(this))
+{
+    // Only the user running the daemon can read the metrics
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(m_server,
+            &QLocalServer::newConnection,
+            this,
+            &MetricsServer::handleConnection);
+}
+
+bool MetricsServer::listen(const QString& path)
+{
+    if (isStaleSocket(path)) {
+        QLocalServer::removeServer(path);
+    }
+    if (!m_server->listen(path)) {
+        AbstractLogger::error(AbstractLogger::Stderr)
+          << tr("Unable to serve metrics on %1: %2")
+               .arg(path, m_server->errorString());
+        return false;
+    }
+    return true;
+}
+
+QByteArray MetricsServer::render()
+{
+    QByteArray out = Metrics::render();
+
+    const CaptureScheduler::Stats queue =
+      Flameshot::instance()->captureQueueStats();
+    appendGauge(out,
+                "flameshot_capture_queue_depth",
+                "Capture requests waiting for their delay or their turn.",
+                queue.queued);
+    appendGauge(out,
+                "flameshot_capture_queue_peak_depth",
+                "Largest number of waiting capture requests.",
+                queue.peakQueued);
+    appendGauge(out,
+                "flameshot_capture_queue_dispatched_total",
+                "Capture requests taken from the queue.",
+                qint64(queue.dispatched),
+                "counter");
+    appendGauge(out,
+                "flameshot_capture_queue_rejected_total",
+                "Capture requests rejected because the queue was full.",
+                qint64(queue.rejected),
+                "counter");
+    appendGauge(out,
+                "flameshot_capture_queue_max_wait_milliseconds",
+                "Longest wait of a ready request before its dispatch.",
+                queue.maxWaitMs);
+
+    FlameshotDaemon* daemon = FlameshotDaemon::instance();
+    appendGauge(out,
+                "flameshot_pins",
+                "Captures pinned to the screen.",
+                daemon != nullptr ? daemon->pinCount() : 0);
+    appendGauge(out,
+                "flameshot_pins_bytes",
+                "Memory taken by the pixels of the pinned captures.",
+                daemon != nullptr ? daemon->pinMemory() : 0);
+
+    QDir historyDir(History().path());
+    const QFileInfoList entries = historyDir.entryInfoList(QDir::Files);
+    qint64 historyBytes = 0;
+    for (const QFileInfo& entry : entries) {
+        historyBytes += entry.size();
+    }
+    appendGauge(out,
+                "flameshot_history_entries",
+                "Captures in the upload history cache.",
+                entries.size());
+    appendGauge(out,
+                "flameshot_history_bytes",
+                "Size of the upload history cache on disk.",
+                historyBytes);
+
+    const qint64 resident = Metrics::residentMemory();
+    if (resident >= 0) {
+        appendGauge(out,
+                    "process_resident_memory_bytes",
+                    "Resident memory size in bytes.",
+                    resident);
+    }
+    return out;
+}
+
+void MetricsServer::handleConnection()
+{
+    while (QLocalSocket* socket = m_server->nextPendingConnection()) {
+        connect(socket,
+                &QLocalSocket::disconnected,
+                socket,
+                &QLocalSocket::deleteLater);
+        // HTTP clients send their request first
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() {
+            if (socket->bytesAvailable() > 0 &&
+                socket->peek(4096).contains("\r\n\r\n")) {
+                respond(socket);
+            }
+        });
+        QTimer::singleShot(REQUEST_TIMEOUT_MS, socket, [this, socket]() {
+            respond(socket);
+        });
+    }
+}
+
+void MetricsServer::respond(QLocalSocket* socket)
+{
+    if (socket->property("answered").toBool()) {
+        return;
+    }
+    socket->setProperty("answered", true);
+
+    const QByteArray body = render();
+    const QByteArray request = socket->readAll();
+    if (request.startsWith("GET ")) {
+        socket->write("HTTP/1.0 200 OK\r\n"
+                      "Content-Type: text/plain; version=0.0.4\r\n"
+                      "Content-Length: " +
+                      QByteArray::number(body.size()) + "\r\n\r\n");
+    } else if (!request.isEmpty()) {
+        socket->write("HTTP/1.0 400 Bad Request\r\n\r\n");
+        socket->disconnectFromServer();
+        return;
+    }
+    socket->write(body);
+    socket->disconnectFromServer();
+}
@@ -0,0 +1,34 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QObject>
+
+class QLocalServer;
+class QLocalSocket;
+
+/**
+ * @brief Serves the metrics of the daemon on a local socket, opt-in through
+ * the metricsSocket option.
+ *
+ * A client sending an HTTP GET request gets an HTTP response, so Prometheus
+ * can scrape the socket directly (or `curl --unix-socket`). Clients that send
+ * nothing get the bare text after a short wait, e.g. `socat - UNIX:<path>`.
+ */
+class MetricsServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MetricsServer(QObject* parent = nullptr);
+
+    bool listen(const QString& path);
+    // Metrics::render() and the gauges of the daemon
+    static QByteArray render();
+
+private:
+    void handleConnection();
+    void respond(QLocalSocket* socket);
+
+    QLocalServer* m_server;
+};
@@ -19,10 +19,12 @@
 #include "src/utils/confighandler.h"
 #include "src/utils/filenamehandler.h"
 #include "src/utils/pathinfo.h"
+#include "src/utils/rawimagewriter.h"
 #include "src/utils/valuehandler.h"
 #include <QApplication>
 #include <QDir>
 #include <QLibraryInfo>
+#include <QtPlugin>
 #include <QSharedMemory>
 #include <QTimer>
 #include <QTranslator>
@@ -32,10 +34,16 @@
 #include <QDBusMessage>
 #include <desktopinfo.h>
 #endif
+#if defined(FLAMESHOT_RENDER_CHECK)
+#include "src/tools/rendercheck.h"
+#endif
 
 // Required for saving button list QList<CaptureTool::Type>
 Q_DECLARE_METATYPE(QList<int>)
 
+// QOI image format, see src/utils/qoihandler.h
+Q_IMPORT_PLUGIN(QoiPlugin)
+
 #if defined(USE_KDSINGLEAPPLICATION) && defined(Q_OS_UNIX)
 static int setup_unix_signal_handlers()
 {
@@ -61,6 +69,16 @@ static int setup_unix_signal_handlers()
 }
 #endif
 
+void logCaptureAborted()
+{
+    AbstractLogger::Target logTarget = static_cast<AbstractLogger::Target>(
+      ConfigHandler().showAbortNotification()
+        ? AbstractLogger::Target::Default
+        : AbstractLogger::Target::Default &
+            ~AbstractLogger::Target::Notification);
+    AbstractLogger::info(logTarget) << "Screenshot aborted.";
+}
+
 int requestCaptureAndWait(const CaptureRequest& req)
 {
     Flameshot* flameshot = Flameshot::instance();
@@ -79,17 +97,21 @@ int requestCaptureAndWait(const CaptureRequest& req)
 #endif
     });
     QObject::connect(flameshot, &Flameshot::captureFailed, []() {
-        AbstractLogger::Target logTarget = static_cast<AbstractLogger::Target>(
-          ConfigHandler().showAbortNotification()
-            ? AbstractLogger::Target::Default
-            : AbstractLogger::Target::Default &
-                ~AbstractLogger::Target::Notification);
-        AbstractLogger::info(logTarget) << "Screenshot aborted.";
+        logCaptureAborted();
         qApp->exit(E_ABORTED);
     });
     return qApp->exec();
 }
 
+RawImageWriter::Format rawFormat(const QString& name)
+{
+    RawImageWriter::Format format = RawImageWriter::PNG;
+    if (!name.isEmpty()) {
+        RawImageWriter::parseFormat(name, format);
+    }
+    return format;
+}
+
 QSharedMemory* guiMutexLock()
 {
     QString key = "org.flameshot.Flameshot-" APP_VERSION;
@@ -255,6 +277,17 @@ int main(int argc, char* argv[])
         return qApp->exec();
     }
 
+#if defined(FLAMESHOT_RENDER_CHECK)
+    // Check of the tool renderers, see tests/tool_render.sh
+    if (argc >= 3 && qstrcmp(argv[1], "render-check") == 0) {
+        QApplication app(argc, argv);
+        const bool update = argc >= 4 && qstrcmp(argv[3], "--update") == 0;
+        const int failures =
+          RenderCheck::run(QString::fromLocal8Bit(argv[2]), update);
+        return failures > 0 ? 1 : 0;
+    }
+#endif
+
     /*--------------|
      * CLI parsing  |
      * ------------*/
@@ -335,6 +368,22 @@ int main(int argc, char* argv[])
       QStringLiteral("color-code"));
     CommandOption rawImageOption({ "r", "raw" },
                                  QObject::tr("Print raw PNG capture"));
+    CommandOption rawFormatOption(
+      "raw-format",
+      QObject::tr("Format of the raw capture, implies --raw") + ": " +
+        RawImageWriter::formatNames().join(", ") + ",\n" +
+        QObject::tr("default: png"),
+      QStringLiteral("format"));
+    CommandOption scaleOption(
+      "scale",
+      QObject::tr("Scale the capture before exporting it, in percent") +
+        ",\n" +
+        QObject::tr("0 scales HiDPI captures back to 1x, default: 100"),
+      QObject::tr("percent"));
+    CommandOption maxWidthOption(
+      "max-width",
+      QObject::tr("Downscale the capture before exporting it if it is wider"),
+      QObject::tr("pixels"));
     CommandOption selectionOption(
       { "g", "print-geometry" },
       QObject::tr("Print geometry of the selection in the format WxH+X+Y. Does "
@@ -389,6 +438,29 @@ int main(int argc, char* argv[])
         }
     };
 
+    const QString scaleErr =
+      QObject::tr("Invalid scale, it must be a percentage from 0 to 400");
+    auto scaleChecker = [](const QString& value) -> bool {
+        bool ok;
+        int percent = value.toInt(&ok);
+        return ok && percent >= 0 && percent <= 400;
+    };
+    const QString maxWidthErr =
+      QObject::tr("Invalid width, it must be a number greater than 0");
+    auto maxWidthChecker = [](const QString& value) -> bool {
+        bool ok;
+        int width = value.toInt(&ok);
+        return ok && width > 0;
+    };
+
+    const QString rawFormatErr =
+      QObject::tr("Invalid raw format, it must be one of: ") +
+      RawImageWriter::formatNames().join(", ");
+    auto rawFormatChecker = [](const QString& value) -> bool {
+        RawImageWriter::Format format;
+        return RawImageWriter::parseFormat(value, format);
+    };
+
     const QString booleanErr =
       QObject::tr("Invalid value, it must be defined as 'true' or 'false'");
     auto booleanChecker = [](const QString& value) -> bool {
@@ -407,6 +479,9 @@ int main(int argc, char* argv[])
     notificationOption.addChecker(booleanChecker, booleanErr);
     showHelpOption.addChecker(booleanChecker, booleanErr);
     screenNumberOption.addChecker(numericChecker, numberErr);
+    rawFormatOption.addChecker(rawFormatChecker, rawFormatErr);
+    scaleOption.addChecker(scaleChecker, scaleErr);
+    maxWidthOption.addChecker(maxWidthChecker, maxWidthErr);
 
     // Relationships
     parser.AddArgument(guiArgument);
@@ -422,6 +497,9 @@ int main(int argc, char* argv[])
                         regionOption,
                         useLastRegionOption,
                         rawImageOption,
+                        rawFormatOption,
+                        scaleOption,
+                        maxWidthOption,
                         selectionOption,
                         uploadOption,
                         pinOption,
@@ -433,6 +511,9 @@ int main(int argc, char* argv[])
                         delayOption,
                         regionOption,
                         rawImageOption,
+                        rawFormatOption,
+                        scaleOption,
+                        maxWidthOption,
                         uploadOption,
                         pinOption },
                       screenArgument);
@@ -441,6 +522,9 @@ int main(int argc, char* argv[])
                         delayOption,
                         regionOption,
                         rawImageOption,
+                        rawFormatOption,
+                        scaleOption,
+                        maxWidthOption,
                         uploadOption },
                       fullArgument);
     parser.AddOptions({ autostartOption,
@@ -467,22 +551,6 @@ int main(int argc, char* argv[])
         flameshot->launcher();
         qApp->exec();
     } else if (parser.isSet(guiArgument)) { // GUI
-        reinitializeAsQApplication(argc, argv, translator, qtTranslator);
-
-        // Prevent multiple instances of 'flameshot gui' from running if not
-        // configured to do so.
-        if (!ConfigHandler().allowMultipleGuiInstances()) {
-            auto* mutex = guiMutexLock();
-            if (!mutex) {
-                return 1;
-            }
-            QObject::connect(
-              qApp, &QCoreApplication::aboutToQuit, qApp, [mutex]() {
-                  mutex->detach();
-                  delete mutex;
-              });
-        }
-
         // Option values
         QString path = parser.value(pathOption);
         if (!path.isEmpty()) {
@@ -492,7 +560,8 @@ int main(int argc, char* argv[])
         QString region = parser.value(regionOption);
         bool useLastRegion = parser.isSet(useLastRegionOption);
         bool clipboard = parser.isSet(clipboardOption);
-        bool raw = parser.isSet(rawImageOption);
+        bool raw =
+          parser.isSet(rawImageOption) || parser.isSet(rawFormatOption);
         bool printGeometry = parser.isSet(selectionOption);
         bool pin = parser.isSet(pinOption);
         bool upload = parser.isSet(uploadOption);
@@ -509,6 +578,13 @@ int main(int argc, char* argv[])
         }
         if (raw) {
             req.addTask(CaptureRequest::PRINT_RAW);
+            req.setRawFormat(rawFormat(parser.value(rawFormatOption)));
+        }
+        if (parser.isSet(scaleOption)) {
+            req.setExportScale(parser.value(scaleOption).toInt());
+        }
+        if (parser.isSet(maxWidthOption)) {
+            req.setExportMaxWidth(parser.value(maxWidthOption).toInt());
         }
         if (!path.isEmpty()) {
             req.addSaveTask(path);
@@ -529,6 +605,33 @@ int main(int argc, char* argv[])
                 req.addSaveTask();
             }
         }
+
+#if !(defined(Q_OS_MACOS) || defined(Q_OS_WIN))
+        // A running daemon is already warmed up, let it take the capture
+        int exitCode = E_OK;
+        if (FlameshotDaemon::forwardCapture(req, exitCode)) {
+            if (exitCode == E_ABORTED) {
+                logCaptureAborted();
+            }
+            return exitCode;
+        }
+#endif
+
+        reinitializeAsQApplication(argc, argv, translator, qtTranslator);
+
+        // Prevent multiple instances of 'flameshot gui' from running if not
+        // configured to do so.
+        if (!ConfigHandler().allowMultipleGuiInstances()) {
+            auto* mutex = guiMutexLock();
+            if (!mutex) {
+                return 1;
+            }
+            QObject::connect(
+              qApp, &QCoreApplication::aboutToQuit, qApp, [mutex]() {
+                  mutex->detach();
+                  delete mutex;
+              });
+        }
         return requestCaptureAndWait(req);
     } else if (parser.isSet(fullArgument)) { // FULL
         reinitializeAsQApplication(argc, argv, translator, qtTranslator);
@@ -541,7 +644,8 @@ int main(int argc, char* argv[])
         int delay = parser.value(delayOption).toInt();
         QString region = parser.value(regionOption);
         bool clipboard = parser.isSet(clipboardOption);
-        bool raw = parser.isSet(rawImageOption);
+        bool raw =
+          parser.isSet(rawImageOption) || parser.isSet(rawFormatOption);
         bool upload = parser.isSet(uploadOption);
         // Not a valid command
 
@@ -557,6 +661,13 @@ int main(int argc, char* argv[])
         }
         if (raw) {
             req.addTask(CaptureRequest::PRINT_RAW);
+            req.setRawFormat(rawFormat(parser.value(rawFormatOption)));
+        }
+        if (parser.isSet(scaleOption)) {
+            req.setExportScale(parser.value(scaleOption).toInt());
+        }
+        if (parser.isSet(maxWidthOption)) {
+            req.setExportMaxWidth(parser.value(maxWidthOption).toInt());
         }
         if (upload) {
             req.addTask(CaptureRequest::UPLOAD);
@@ -579,7 +690,8 @@ int main(int argc, char* argv[])
         int delay = parser.value(delayOption).toInt();
         QString region = parser.value(regionOption);
         bool clipboard = parser.isSet(clipboardOption);
-        bool raw = parser.isSet(rawImageOption);
+        bool raw =
+          parser.isSet(rawImageOption) || parser.isSet(rawFormatOption);
         bool pin = parser.isSet(pinOption);
         bool upload = parser.isSet(uploadOption);
 
@@ -599,6 +711,13 @@ int main(int argc, char* argv[])
         }
         if (raw) {
             req.addTask(CaptureRequest::PRINT_RAW);
+            req.setRawFormat(rawFormat(parser.value(rawFormatOption)));
+        }
+        if (parser.isSet(scaleOption)) {
+            req.setExportScale(parser.value(scaleOption).toInt());
+        }
+        if (parser.isSet(maxWidthOption)) {
+            req.setExportMaxWidth(parser.value(maxWidthOption).toInt());
         }
         if (!path.isEmpty()) {
             req.addSaveTask(path);
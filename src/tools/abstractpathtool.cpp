@@ -2,7 +2,7 @@
 // SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
 
 #include "abstractpathtool.h"
-#include <cmath>
+#include "src/tools/annotationrenderer.h"
 
 AbstractPathTool::AbstractPathTool(QObject* parent)
   : CaptureTool(parent)
@@ -53,35 +53,31 @@ QRect AbstractPathTool::mousePreviewRect(const CaptureContext& context) const
 
 QRect AbstractPathTool::boundingRect() const
 {
-    if (m_points.isEmpty()) {
-        return {};
-    }
-    int min_x = m_points.at(0).x();
-    int min_y = m_points.at(0).y();
-    int max_x = m_points.at(0).x();
-    int max_y = m_points.at(0).y();
-    for (auto point : m_points) {
-        if (point.x() < min_x) {
-            min_x = point.x();
-        }
-        if (point.y() < min_y) {
-            min_y = point.y();
-        }
-        if (point.x() > max_x) {
-            max_x = point.x();
-        }
-        if (point.y() > max_y) {
-            max_y = point.y();
-        }
+    return AnnotationRenderer::boundingRect(*annotation());
+}
+
+std::optional<Annotation> AbstractPathTool::annotation() const
+{
+    PathAnnotation path;
+    path.points = m_points;
+    path.color = m_color;
+    path.thickness = m_thickness;
+    return path;
+}
+
+void AbstractPathTool::setAnnotation(const Annotation& annotation)
+{
+    if (const auto* path = std::get_if<PathAnnotation>(&annotation)) {
+        m_points = path->points;
+        m_color = path->color;
+        m_thickness = path->thickness;
+        m_pathArea = AnnotationRenderer::boundingRect(annotation);
     }
+}
 
-    int offset =
-      m_thickness <= 1 ? 1 : static_cast<int>(round(m_thickness * 0.7 + 0.5));
-    return QRect(min_x - offset,
-                 min_y - offset,
-                 std::abs(min_x - max_x) + offset * 2,
-                 std::abs(min_y - max_y) + offset * 2)
-      .normalized();
+void AbstractPathTool::process(QPainter& painter, const QPixmap& pixmap)
+{
+    AnnotationRenderer::render(painter, pixmap, *annotation());
 }
 
 void AbstractPathTool::drawEnd(const QPoint& p)
@@ -17,6 +17,9 @@ public:
     bool showMousePreview() const override;
     QRect mousePreviewRect(const CaptureContext& context) const override;
     QRect boundingRect() const override;
+    std::optional<Annotation> annotation() const override;
+    void setAnnotation(const Annotation& annotation) override;
+    void process(QPainter& painter, const QPixmap& pixmap) override;
     void move(const QPoint& mousePos) override;
     const QPoint* pos() override;
     int size() const override { return m_thickness; };
@@ -2,6 +2,8 @@
 // SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
 
 #include "abstracttwopointtool.h"
+#include "src/tools/annotationrenderer.h"
+#include "src/utils/confighandler.h"
 #include <QCursor>
 #include <QScreen>
 #include <cmath>
@@ -45,6 +47,7 @@ void AbstractTwoPointTool::copyParams(const AbstractTwoPointTool* from,
     to->m_padding = from->m_padding;
     to->m_supportsOrthogonalAdj = from->m_supportsOrthogonalAdj;
     to->m_supportsDiagonalAdj = from->m_supportsDiagonalAdj;
+    to->m_shape = from->m_shape;
 }
 
 bool AbstractTwoPointTool::isValid() const
@@ -80,15 +83,45 @@ QRect AbstractTwoPointTool::boundingRect() const
     if (!isValid()) {
         return {};
     }
-    int offset =
-      m_thickness <= 1 ? 1 : static_cast<int>(round(m_thickness * 0.7 + 0.5));
-    QRect rect =
-      QRect(std::min(m_points.first.x(), m_points.second.x()) - offset,
-            std::min(m_points.first.y(), m_points.second.y()) - offset,
-            std::abs(m_points.first.x() - m_points.second.x()) + offset * 2,
-            std::abs(m_points.first.y() - m_points.second.y()) + offset * 2);
-
-    return rect.normalized();
+    return AnnotationRenderer::boundingRect(*annotation());
+}
+
+std::optional<Annotation> AbstractTwoPointTool::annotation() const
+{
+    TwoPointAnnotation shape;
+    shape.shape = m_shape;
+    shape.first = m_points.first;
+    shape.second = m_points.second;
+    shape.color = m_color;
+    shape.thickness = m_thickness;
+    if (m_shape == TwoPointAnnotation::ARROW) {
+        shape.reversed = ConfigHandler().reverseArrow();
+    } else if (m_shape == TwoPointAnnotation::PIXELATE) {
+        shape.insecure = ConfigHandler().insecurePixelate();
+    }
+    return shape;
+}
+
+void AbstractTwoPointTool::setAnnotation(const Annotation& annotation)
+{
+    if (const auto* shape = std::get_if<TwoPointAnnotation>(&annotation)) {
+        m_points.first = shape->first;
+        m_points.second = shape->second;
+        m_color = shape->color;
+        m_thickness = shape->thickness;
+    }
+}
+
+void AbstractTwoPointTool::process(QPainter& painter, const QPixmap& pixmap)
+{
+    AnnotationRenderer::render(painter, pixmap, *annotation());
+}
+
+void AbstractTwoPointTool::drawSearchArea(QPainter& painter,
+                                          const QPixmap& pixmap)
+{
+    Q_UNUSED(pixmap)
+    AnnotationRenderer::renderSearchArea(painter, *annotation());
 }
 
 void AbstractTwoPointTool::drawEnd(const QPoint& p)
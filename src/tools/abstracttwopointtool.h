@@ -17,10 +17,14 @@ public:
     bool showMousePreview() const override;
     QRect mousePreviewRect(const CaptureContext& context) const override;
     QRect boundingRect() const override;
+    std::optional<Annotation> annotation() const override;
+    void setAnnotation(const Annotation& annotation) override;
+    void process(QPainter& painter, const QPixmap& pixmap) override;
+    void drawSearchArea(QPainter& painter, const QPixmap& pixmap) override;
     void move(const QPoint& pos) override;
     const QPoint* pos() override;
     int size() const override { return m_thickness; };
-    const QColor& color() { return m_color; };
+    const QColor& color() const { return m_color; };
     const QPair<QPoint, QPoint> points() const { return m_points; };
     void paintMousePreview(QPainter& painter,
                            const CaptureContext& context) override;
@@ -51,4 +55,6 @@ protected:
     // use m_padding to extend the area of the backup
     bool m_supportsOrthogonalAdj = false;
     bool m_supportsDiagonalAdj = false;
+    // What the subclass draws between the two points
+    TwoPointAnnotation::Shape m_shape = TwoPointAnnotation::LINE;
 };
@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QColor>
+#include <QFont>
+#include <QPoint>
+#include <QString>
+#include <QVector>
+#include <variant>
+
+// Plain values describing what has been drawn on a capture. They hold no
+// behavior, see AnnotationRenderer for drawing and hit testing them. The
+// CaptureTool subclasses only edit them.
+
+// Freehand path (pencil)
+struct PathAnnotation
+{
+    QVector<QPoint> points;
+    QColor color;
+    int thickness = 1;
+};
+
+// Element spanned by the points where a drag started and ended
+struct TwoPointAnnotation
+{
+    enum Shape
+    {
+        LINE,
+        ARROW,
+        RECTANGLE,
+        SELECTION,
+        CIRCLE,
+        MARKER,
+        PIXELATE,
+        INVERT
+    };
+
+    Shape shape = LINE;
+    QPoint first;
+    QPoint second;
+    QColor color;
+    int thickness = 1;
+    // Settings read on the GUI thread, the annotation may be drawn on another
+    // one. Arrow: head at `first` instead of `second`.
+    bool reversed = false;
+    // Pixelate: blur the area instead of filling it from its fringe
+    bool insecure = false;
+};
+
+// Numbered bubble, with a pointer when the drag left the bubble
+struct CircleCountAnnotation
+{
+    QPoint center;
+    QPoint pointer;
+    QColor color;
+    int thickness = 1;
+    int count = 0;
+};
+
+struct TextAnnotation
+{
+    QString text;
+    QFont font;
+    QColor color;
+    Qt::AlignmentFlag alignment = Qt::AlignLeft;
+    QPoint topLeft;
+    int size = 1;
+    // The text widget shows the text while it is edited
+    bool editing = false;
+};
+
+using Annotation = std::variant<PathAnnotation,
+                                TwoPointAnnotation,
+                                CircleCountAnnotation,
+                                TextAnnotation>;
@@ -0,0 +1,929 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "annotationrenderer.h"
+#include "src/utils/blendkernels.h"
+#include "src/utils/colorutils.h"
+#include <QCoreApplication>
+#include <QFontMetrics>
+#include <QImage>
+#include <QLineF>
+#include <QPainter>
+#include <QPainterPath>
+#include <QPair>
+#include <QPixmap>
+#include <QTransform>
+#include <QVector>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+
+namespace {
+
+const int ArrowWidth = 10;
+const int ArrowHeight = 18;
+
+const qreal MARKER_OPACITY = 0.35;
+// Of each of the box blurs of the insecure blur, in logical pixels
+const int BLUR_RADIUS = 6;
+const int BLUR_PASSES = 3;
+
+const int CIRCLECOUNT_PADDING = 2;
+const int CIRCLECOUNT_THICKNESS_OFFSET = 15;
+
+// Margin between the text and its bounding rect
+const int TEXT_MARGIN = 5;
+const int MAX_LABEL_LENGTH = 24;
+
+// The capture drawn so far, that effects read their input from. It is an
+// image when the capture is composed outside of the GUI thread.
+class Background
+{
+public:
+    explicit Background(const QPixmap& pixmap)
+      : m_pixmap(&pixmap)
+    {}
+    explicit Background(const QImage& image)
+      : m_image(&image)
+    {}
+
+    QRect rect() const
+    {
+        return m_image != nullptr ? m_image->rect() : m_pixmap->rect();
+    }
+
+    qreal devicePixelRatio() const
+    {
+        return m_image != nullptr ? m_image->devicePixelRatio()
+                                  : m_pixmap->devicePixelRatio();
+    }
+
+    QImage copy(const QRect& rect) const
+    {
+        return m_image != nullptr ? m_image->copy(rect)
+                                  : m_pixmap->copy(rect).toImage();
+    }
+
+private:
+    const QPixmap* m_pixmap = nullptr;
+    const QImage* m_image = nullptr;
+};
+
+// The image the painter draws on, when the blend kernels can write its pixels
+// directly instead of going through the painter
+QImage* blendTarget(QPainter& painter)
+{
+    QPaintDevice* device = painter.device();
+    if (device == nullptr || device->devType() != QInternal::Image ||
+        painter.hasClipping() || painter.opacity() < 1.0 ||
+        painter.compositionMode() != QPainter::CompositionMode_SourceOver) {
+        return nullptr;
+    }
+    auto* image = static_cast<QImage*>(device);
+    if (!BlendKernels::canBlend(*image) || !image->isDetached()) {
+        return nullptr;
+    }
+    return image;
+}
+
+// Box blur of `count` pixels `stride` apart, the pixels past the ends repeat
+// the ones at the ends
+void blurLine(QRgb* pixels, int count, int stride, int radius, QRgb* line)
+{
+    for (int i = 0; i < count; ++i) {
+        line[i] = pixels[i * stride];
+    }
+    const int window = radius * 2 + 1;
+    int red = 0, green = 0, blue = 0, alpha = 0;
+    for (int i = -radius; i <= radius; ++i) {
+        const QRgb pixel = line[qBound(0, i, count - 1)];
+        red += qRed(pixel);
+        green += qGreen(pixel);
+        blue += qBlue(pixel);
+        alpha += qAlpha(pixel);
+    }
+    for (int i = 0; i < count; ++i) {
+        pixels[i * stride] =
+          qRgba(red / window, green / window, blue / window, alpha / window);
+        const QRgb out = line[qMax(0, i - radius)];
+        const QRgb in = line[qMin(count - 1, i + radius + 1)];
+        red += qRed(in) - qRed(out);
+        green += qGreen(in) - qGreen(out);
+        blue += qBlue(in) - qBlue(out);
+        alpha += qAlpha(in) - qAlpha(out);
+    }
+}
+
+// Close to a gaussian blur: repeated box blurs across and down. Works on the
+// image alone, it runs on the compositor threads where QtWidgets can't.
+void blur(QImage& image, int radius)
+{
+    image = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    if (image.isNull()) {
+        return;
+    }
+    const int width = image.width();
+    const int height = image.height();
+    const int stride = int(image.bytesPerLine() / sizeof(QRgb));
+    auto* pixels = reinterpret_cast<QRgb*>(image.bits());
+    QVector<QRgb> line(qMax(width, height));
+    for (int pass = 0; pass < BLUR_PASSES; ++pass) {
+        for (int y = 0; y < height; ++y) {
+            blurLine(pixels + y * stride, width, 1, radius, line.data());
+        }
+        for (int x = 0; x < width; ++x) {
+            blurLine(pixels + x, height, stride, radius, line.data());
+        }
+    }
+}
+
+QPainterPath getArrowHead(QPoint p1, QPoint p2, const int thickness)
+{
+    QLineF base(p1, p2);
+    // Create the vector for the position of the base  of the arrowhead
+    QLineF temp(QPoint(0, 0), p2 - p1);
+    int val = ArrowHeight + thickness * 4;
+    if (base.length() < (val - thickness * 2)) {
+        val = static_cast<int>(base.length() + thickness * 2);
+    }
+    temp.setLength(base.length() + thickness * 2 - val);
+    // Move across the line up to the head
+    QPointF bottomTranslation(temp.p2());
+
+    // Rotate base of the arrowhead
+    base.setLength(ArrowWidth + thickness * 2);
+    base.setAngle(base.angle() + 90);
+    // Move to the correct point
+    QPointF temp2 = p1 - base.p2();
+    // Center it
+    QPointF centerTranslation((temp2.x() / 2), (temp2.y() / 2));
+
+    base.translate(bottomTranslation);
+    base.translate(centerTranslation);
+
+    QPainterPath path;
+    path.moveTo(p2);
+    path.lineTo(base.p1());
+    path.lineTo(base.p2());
+    path.lineTo(p2);
+    return path;
+}
+
+// gets a shorter line to prevent overlap in the point of the arrow
+QLine getShorterLine(QPoint p1, QPoint p2, const int thickness)
+{
+    QLineF l(p1, p2);
+    int val = ArrowHeight + thickness * 4;
+    if (l.length() < (val - thickness * 2)) {
+        // here should be 0, but then we lose "angle", so this is hack, but
+        // looks not very bad
+        val = thickness / 4;
+        l.setLength(val);
+    } else {
+        l.setLength(l.length() + thickness * 2 - val);
+    }
+    return l.toLine();
+}
+
+// Head and tail of an arrow, in the direction the user configured
+QPair<QPoint, QPoint> arrowEnds(const TwoPointAnnotation& arrow)
+{
+    if (arrow.reversed) {
+        return { arrow.second, arrow.first };
+    }
+    return { arrow.first, arrow.second };
+}
+
+int penOffset(int thickness)
+{
+    return thickness <= 1 ? 1 : static_cast<int>(round(thickness * 0.7 + 0.5));
+}
+
+QRect textArea(const TextAnnotation& text)
+{
+    QFontMetrics fm(text.font);
+    QSize size(fm.boundingRect(QRect(), 0, text.text).size());
+    size += QSize(TEXT_MARGIN * 2, TEXT_MARGIN * 2);
+    return { text.topLeft, size };
+}
+
+// Bounding rects
+
+QRect boundingRectOf(const PathAnnotation& path)
+{
+    if (path.points.isEmpty()) {
+        return {};
+    }
+    int min_x = path.points.at(0).x();
+    int min_y = path.points.at(0).y();
+    int max_x = path.points.at(0).x();
+    int max_y = path.points.at(0).y();
+    for (auto point : path.points) {
+        min_x = std::min(min_x, point.x());
+        min_y = std::min(min_y, point.y());
+        max_x = std::max(max_x, point.x());
+        max_y = std::max(max_y, point.y());
+    }
+
+    int offset = penOffset(path.thickness);
+    return QRect(min_x - offset,
+                 min_y - offset,
+                 std::abs(min_x - max_x) + offset * 2,
+                 std::abs(min_y - max_y) + offset * 2)
+      .normalized();
+}
+
+QRect arrowBoundingRect(const TwoPointAnnotation& arrow)
+{
+    const int size = arrow.thickness;
+    int offset = size <= 1 ? 1 : static_cast<int>(round(size / 2 + 0.5));
+    auto [head, tail] = arrowEnds(arrow);
+    QPainterPath arrowPath = getArrowHead(head, tail, size);
+
+    // get min and max arrow pos
+    int min_x = arrow.first.x();
+    int min_y = arrow.first.y();
+    int max_x = arrow.first.x();
+    int max_y = arrow.first.y();
+    for (int i = 0; i < arrowPath.elementCount(); i++) {
+        QPointF pt = arrowPath.elementAt(i);
+        min_x = std::min(min_x, static_cast<int>(pt.x()));
+        min_y = std::min(min_y, static_cast<int>(pt.y()));
+        max_x = std::max(max_x, static_cast<int>(pt.x()));
+        max_y = std::max(max_y, static_cast<int>(pt.y()));
+    }
+
+    // get min and max line pos
+    int line_pos_min_x =
+      std::min(std::min(arrow.first.x(), arrow.second.x()), min_x);
+    int line_pos_min_y =
+      std::min(std::min(arrow.first.y(), arrow.second.y()), min_y);
+    int line_pos_max_x =
+      std::max(std::max(arrow.first.x(), arrow.second.x()), max_x);
+    int line_pos_max_y =
+      std::max(std::max(arrow.first.y(), arrow.second.y()), max_y);
+
+    QRect rect = QRect(line_pos_min_x - offset,
+                       line_pos_min_y - offset,
+                       line_pos_max_x - line_pos_min_x + offset * 2,
+                       line_pos_max_y - line_pos_min_y + offset * 2);
+
+    return rect.normalized();
+}
+
+QRect boundingRectOf(const TwoPointAnnotation& shape)
+{
+    switch (shape.shape) {
+        case TwoPointAnnotation::PIXELATE:
+        case TwoPointAnnotation::INVERT:
+            return QRect(shape.first, shape.second).normalized();
+        default:
+            break;
+    }
+    if (shape.first == shape.second) {
+        return {};
+    }
+    if (shape.shape == TwoPointAnnotation::ARROW) {
+        return arrowBoundingRect(shape);
+    }
+    int offset = penOffset(shape.thickness);
+    QRect rect =
+      QRect(std::min(shape.first.x(), shape.second.x()) - offset,
+            std::min(shape.first.y(), shape.second.y()) - offset,
+            std::abs(shape.first.x() - shape.second.x()) + offset * 2,
+            std::abs(shape.first.y() - shape.second.y()) + offset * 2);
+    return rect.normalized();
+}
+
+QRect boundingRectOf(const CircleCountAnnotation& circle)
+{
+    int bubble_size =
+      circle.thickness + CIRCLECOUNT_THICKNESS_OFFSET + CIRCLECOUNT_PADDING;
+    int line_pos_min_x =
+      std::min(circle.center.x() - bubble_size, circle.pointer.x());
+    int line_pos_min_y =
+      std::min(circle.center.y() - bubble_size, circle.pointer.y());
+    int line_pos_max_x =
+      std::max(circle.center.x() + bubble_size, circle.pointer.x());
+    int line_pos_max_y =
+      std::max(circle.center.y() + bubble_size, circle.pointer.y());
+
+    return { line_pos_min_x,
+             line_pos_min_y,
+             line_pos_max_x - line_pos_min_x,
+             line_pos_max_y - line_pos_min_y };
+}
+
+QRect boundingRectOf(const TextAnnotation& text)
+{
+    return textArea(text);
+}
+
+// Renderers
+
+void renderOne(QPainter& painter,
+               const Background& background,
+               const PathAnnotation& path)
+{
+    Q_UNUSED(background)
+    painter.setPen(QPen(path.color, path.thickness));
+    painter.drawPolyline(path.points.data(), path.points.size());
+}
+
+void renderArrow(QPainter& painter, const TwoPointAnnotation& arrow)
+{
+    auto [head, tail] = arrowEnds(arrow);
+    painter.setPen(QPen(arrow.color, arrow.thickness));
+    painter.drawLine(getShorterLine(head, tail, arrow.thickness));
+    painter.fillPath(getArrowHead(head, tail, arrow.thickness),
+                     QBrush(arrow.color));
+}
+
+void renderRectangle(QPainter& painter, const TwoPointAnnotation& rectangle)
+{
+    const int size = rectangle.thickness;
+    const QPoint& first = rectangle.first;
+    const QPoint& second = rectangle.second;
+    QPen orig_pen = painter.pen();
+    QBrush orig_brush = painter.brush();
+    painter.setPen(QPen(
+      rectangle.color, size, Qt::SolidLine, Qt::SquareCap, Qt::RoundJoin));
+    painter.setBrush(QBrush(rectangle.color));
+    if (size == 0) {
+        painter.drawRect(QRect(first, second));
+    } else {
+        QPainterPath path;
+        int offset = size <= 1 ? 1 : static_cast<int>(round(size / 2 + 0.5));
+        path.addRoundedRect(
+          QRectF(std::min(first.x(), second.x()) - offset,
+                 std::min(first.y(), second.y()) - offset,
+                 std::abs(first.x() - second.x()) + offset * 2,
+                 std::abs(first.y() - second.y()) + offset * 2),
+          size,
+          size);
+        painter.fillPath(path, rectangle.color);
+    }
+    painter.setPen(orig_pen);
+    painter.setBrush(orig_brush);
+}
+
+void renderMarker(QPainter& painter, const TwoPointAnnotation& marker)
+{
+    QImage* target = blendTarget(painter);
+    if (target != nullptr) {
+        // The stroke is drawn opaque into a mask and multiplied row by row.
+        // The antialiasing coverage is in the alpha of the mask, which gives
+        // the same result as the painter applying it to the opacity.
+        const qreal reach = marker.thickness + 1;
+        const QRect area =
+          painter.deviceTransform()
+            .mapRect(QRectF(marker.first, marker.second)
+                       .normalized()
+                       .adjusted(-reach, -reach, reach, reach))
+            .toAlignedRect()
+            .intersected(target->rect());
+        if (area.isEmpty()) {
+            return;
+        }
+        QImage mask(area.size(), QImage::Format_ARGB32_Premultiplied);
+        mask.fill(Qt::transparent);
+        QPainter maskPainter(&mask);
+        maskPainter.setRenderHints(painter.renderHints());
+        maskPainter.setTransform(
+          painter.deviceTransform() *
+          QTransform::fromTranslate(-area.x(), -area.y()));
+        maskPainter.setPen(QPen(marker.color, marker.thickness));
+        maskPainter.drawLine(marker.first, marker.second);
+        maskPainter.end();
+
+        const int opacity = qRound(MARKER_OPACITY * 255);
+        for (int y = 0; y < area.height(); ++y) {
+            auto* line = reinterpret_cast<quint32*>(
+                           target->scanLine(area.y() + y)) +
+                         area.x();
+            BlendKernels::multiply(
+              line,
+              reinterpret_cast<const quint32*>(mask.constScanLine(y)),
+              area.width(),
+              opacity);
+        }
+        return;
+    }
+
+    auto compositionMode = painter.compositionMode();
+    qreal opacity = painter.opacity();
+    auto pen = painter.pen();
+    painter.setCompositionMode(QPainter::CompositionMode_Multiply);
+    painter.setOpacity(MARKER_OPACITY);
+    painter.setPen(QPen(marker.color, marker.thickness));
+    painter.drawLine(marker.first, marker.second);
+    painter.setPen(pen);
+    painter.setOpacity(opacity);
+    painter.setCompositionMode(compositionMode);
+}
+
+/**
+ * Since pixelation does not protect the contents of the pixelated area
+ * (see e.g. https://github.com/bishopfox/unredacter),
+ * _pseudo-pixelation_ is used:
+ *
+ * Only colors from the fringe of the selected area are used to generate
+ * a pixelation-like effect. The interior of the selected area is not used
+ * as an input at all and hence can not be recovered.
+ *
+ */
+void renderPixelate(QPainter& painter,
+                    const Background& background,
+                    const TwoPointAnnotation& pixelate)
+{
+    const int size = pixelate.thickness;
+    QRect selection = boundingRectOf(pixelate).intersected(background.rect());
+    auto pixelRatio = background.devicePixelRatio();
+    QRect selectionScaled = QRect(selection.topLeft() * pixelRatio,
+                                  selection.bottomRight() * pixelRatio);
+
+    const auto width =
+      static_cast<int>(selection.width() * (0.5 / qMax(1, size + 1)));
+    const auto height =
+      static_cast<int>(selection.height() * (0.5 / qMax(1, size + 1)));
+    const auto effectSize = QSize(qMax(width, 1), qMax(height, 1));
+
+    if (pixelate.insecure) {
+        if (size <= 1) {
+            QImage blurred = background.copy(selectionScaled);
+            blur(blurred, qMax(1, qRound(BLUR_RADIUS * pixelRatio)));
+            painter.drawImage(selection, blurred);
+        } else {
+            QImage pixelated = background.copy(selectionScaled);
+            pixelated = pixelated.scaled(
+              effectSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+            pixelated = pixelated.scaled(selection.width(), selection.height());
+            painter.drawImage(selection, pixelated);
+        }
+    } else {
+        // the PRNG is only used for visual effects and NOT part of the security
+        // boundary
+        std::mt19937 prng(42);
+
+        // noise for the sampling process to avoid only sampling from a small
+        // subset of the fringe
+        std::normal_distribution<float> sampling_noise(0, 5 * size + 1);
+
+        // additional noise that will be added on top of the effect to avoid
+        // generating a monochromatic box when the fringe is monochromatic
+        std::normal_distribution<float> noise(0, 0.1f);
+
+        QPoint const offset_top(0, selectionScaled.topLeft().y() == 0 ? 0 : -1);
+        QPoint const offset_bottom(0,
+                                   selectionScaled.bottomLeft().y() ==
+                                       background.rect().bottomLeft().y()
+                                     ? 0
+                                     : 1);
+        QPoint const offset_left(selectionScaled.topLeft().x() == 0 ? 0 : -1,
+                                 0);
+        QPoint const offset_right(
+          selectionScaled.topRight().x() == background.rect().topRight().x()
+            ? 0
+            : 1,
+          0);
+
+        // only values from the fringe will be used to compute the
+        // pseudo-pixelation
+        std::array<QImage, 4> fringe = {
+            // top fringe
+            background.copy(QRect(selectionScaled.topLeft() + offset_top,
+                                  selectionScaled.topRight() + offset_top)),
+            // bottom fringe
+            background.copy(
+              QRect(selectionScaled.bottomLeft() + offset_bottom,
+                    selectionScaled.bottomRight() + offset_bottom)),
+            // left fringe
+            background.copy(QRect(selectionScaled.topLeft() + offset_left,
+                                  selectionScaled.bottomLeft() + offset_left)),
+            // right fringe
+            background.copy(
+              QRect(selectionScaled.topRight() + offset_right,
+                    selectionScaled.bottomRight() + offset_right))
+        };
+
+        // Image where the pseudo-pixelation is calculated.
+        // This will later be scaled to cover the selected area.
+        QImage pixelated = QImage(effectSize, QImage::Format_RGB32);
+
+        // For every pixel of the effect, we consider four projections
+        // to the fringe and sample a pixel from there.
+        // Then a horizontal and vertical interpolation are calculated.
+        std::array<std::array<float, 3>, 4> samples;
+        for (int x = 0; x < width; ++x) {
+            for (int y = 0; y < height; ++y) {
+                float n = noise(prng);
+
+                // relative horizontal resp. vertical position
+                float const horizontal = x / (float)width;
+                float const vertical = y / (float)height;
+
+                for (int i = 0; i < 4; ++i) {
+                    QColor const c = fringe[i].pixel(
+                      std::clamp(
+                        static_cast<int>(horizontal * fringe[i].width() +
+                                         sampling_noise(prng)),
+                        0,
+                        fringe[i].width() - 1),
+                      std::clamp(
+                        static_cast<int>(vertical * fringe[i].height() +
+                                         sampling_noise(prng)),
+                        0,
+                        fringe[i].height() - 1));
+                    samples[i][0] = c.redF();
+                    samples[i][1] = c.greenF();
+                    samples[i][2] = c.blueF();
+                }
+
+                // weights of the horizontal resp. vertical interpolation
+                float const weight_h = (qMin(x, width - x) / width) -
+                                       (qMin(y, height - y) / height) + 0.5;
+                float const weight_v = 1 - weight_h;
+
+                // compute the weighted sum of the vertical and horizontal
+                // interpolations
+                std::array<int, 3> rgb = { 0, 0, 0 };
+                for (int i = 0; i < 3; ++i) {
+                    float c =
+                      // horizontal interpolation
+                      weight_h * ((1 - horizontal) * samples[2][i] +
+                                  horizontal * samples[3][i])
+                      // vertical interpolation
+                      + weight_v * ((1 - vertical) * samples[0][i] +
+                                    vertical * samples[1][i])
+                      // additional noise
+                      + n;
+                    rgb[i] = static_cast<int>(0xff * c);
+                    rgb[i] = std::clamp(rgb[i], 0, 0xff);
+                }
+
+                QRgb const value = qRgb(rgb[0], rgb[1], rgb[2]);
+                pixelated.setPixel(x, y, value);
+            }
+        }
+
+        pixelated = pixelated.scaled(selection.width(),
+                                     selection.height(),
+                                     Qt::IgnoreAspectRatio,
+                                     Qt::FastTransformation);
+        painter.drawImage(selection, pixelated);
+    }
+}
+
+void renderInvert(QPainter& painter,
+                  const Background& background,
+                  const TwoPointAnnotation& invert)
+{
+    QRect selection = boundingRectOf(invert).intersected(background.rect());
+    auto pixelRatio = background.devicePixelRatio();
+    QRect selectionScaled = QRect(selection.topLeft() * pixelRatio,
+                                  selection.bottomRight() * pixelRatio);
+
+    // Invert selection
+    QImage img = background.copy(selectionScaled);
+    img.invertPixels();
+
+    painter.drawImage(selection, img);
+}
+
+void renderOne(QPainter& painter,
+               const Background& background,
+               const TwoPointAnnotation& shape)
+{
+    switch (shape.shape) {
+        case TwoPointAnnotation::LINE:
+            painter.setPen(QPen(shape.color, shape.thickness));
+            painter.drawLine(shape.first, shape.second);
+            break;
+        case TwoPointAnnotation::ARROW:
+            renderArrow(painter, shape);
+            break;
+        case TwoPointAnnotation::RECTANGLE:
+            renderRectangle(painter, shape);
+            break;
+        case TwoPointAnnotation::SELECTION:
+            painter.setPen(QPen(shape.color,
+                                shape.thickness,
+                                Qt::SolidLine,
+                                Qt::SquareCap,
+                                Qt::MiterJoin));
+            painter.drawRect(QRect(shape.first, shape.second));
+            break;
+        case TwoPointAnnotation::CIRCLE:
+            painter.setPen(QPen(shape.color, shape.thickness));
+            painter.drawEllipse(QRect(shape.first, shape.second));
+            break;
+        case TwoPointAnnotation::MARKER:
+            renderMarker(painter, shape);
+            break;
+        case TwoPointAnnotation::PIXELATE:
+            renderPixelate(painter, background, shape);
+            break;
+        case TwoPointAnnotation::INVERT:
+            renderInvert(painter, background, shape);
+            break;
+    }
+}
+
+void renderOne(QPainter& painter,
+               const Background& background,
+               const CircleCountAnnotation& circle)
+{
+    Q_UNUSED(background)
+    // save current pen, brush, and font state
+    auto orig_pen = painter.pen();
+    auto orig_brush = painter.brush();
+    auto orig_font = painter.font();
+
+    const QColor& color = circle.color;
+    QColor contrastColor =
+      ColorUtils::colorIsDark(color) ? Qt::white : Qt::black;
+    QColor antiContrastColor =
+      ColorUtils::colorIsDark(color) ? Qt::black : Qt::white;
+
+    int bubble_size = circle.thickness + CIRCLECOUNT_THICKNESS_OFFSET;
+
+    QLineF line(circle.center, circle.pointer);
+    // if the mouse is outside of the bubble, draw the pointer
+    if (line.length() > bubble_size) {
+        painter.setPen(QPen(color, 0));
+        painter.setBrush(color);
+
+        int middleX = circle.center.x();
+        int middleY = circle.center.y();
+
+        QLineF normal = line.normalVector();
+        normal.setLength(bubble_size);
+        QPoint p1 = normal.p2().toPoint();
+        QPoint p2(middleX - (p1.x() - middleX), middleY - (p1.y() - middleY));
+        QPainterPath path;
+        path.moveTo(circle.center);
+        path.lineTo(p1);
+        path.lineTo(circle.pointer);
+        path.lineTo(p2);
+        path.lineTo(circle.center);
+        painter.drawPath(path);
+    }
+
+    painter.setPen(contrastColor);
+    painter.setBrush(antiContrastColor);
+    painter.drawEllipse(circle.center,
+                        bubble_size + CIRCLECOUNT_PADDING,
+                        bubble_size + CIRCLECOUNT_PADDING);
+    painter.setBrush(color);
+    painter.drawEllipse(circle.center, bubble_size, bubble_size);
+    QRect textRect = QRect(circle.center.x() - bubble_size / 2,
+                           circle.center.y() - bubble_size / 2,
+                           bubble_size,
+                           bubble_size);
+    auto new_font = orig_font;
+    auto fontSize = bubble_size;
+    new_font.setPixelSize(fontSize);
+    new_font.setBold(true);
+    painter.setFont(new_font);
+
+    const QString number = QString::number(circle.count);
+    // Draw bounding circle
+    QRect bRect = painter.boundingRect(textRect, Qt::AlignCenter, number);
+
+    // Calculate font size
+    while (bRect.width() > textRect.width()) {
+        fontSize--;
+        if (fontSize == 0) {
+            break;
+        }
+        new_font.setPixelSize(fontSize);
+        painter.setFont(new_font);
+
+        bRect = painter.boundingRect(textRect, Qt::AlignCenter, number);
+    }
+
+    // Draw text
+    painter.setPen(contrastColor);
+    painter.drawText(textRect, Qt::AlignCenter, number);
+
+    // restore original font, brush, and pen
+    painter.setFont(orig_font);
+    painter.setBrush(orig_brush);
+    painter.setPen(orig_pen);
+}
+
+void renderOne(QPainter& painter,
+               const Background& background,
+               const TextAnnotation& text)
+{
+    Q_UNUSED(background)
+    if (text.text.isEmpty() || text.editing) {
+        return;
+    }
+    QFont orig_font = painter.font();
+    QPen orig_pen = painter.pen();
+    painter.setFont(text.font);
+    painter.setPen(text.color);
+    painter.drawText(textArea(text) + QMargins(-TEXT_MARGIN,
+                                               -TEXT_MARGIN,
+                                               TEXT_MARGIN,
+                                               TEXT_MARGIN),
+                     text.alignment,
+                     text.text);
+    painter.setFont(orig_font);
+    painter.setPen(orig_pen);
+}
+
+// Labels
+
+QString toolName(const char* context, const char* name)
+{
+    return QCoreApplication::translate(context, name);
+}
+
+QString labelOf(const PathAnnotation& path)
+{
+    Q_UNUSED(path)
+    return toolName("PencilTool", "Pencil");
+}
+
+QString labelOf(const TwoPointAnnotation& shape)
+{
+    switch (shape.shape) {
+        case TwoPointAnnotation::LINE:
+            return toolName("LineTool", "Line");
+        case TwoPointAnnotation::ARROW:
+            return toolName("ArrowTool", "Arrow");
+        case TwoPointAnnotation::RECTANGLE:
+            return toolName("RectangleTool", "Rectangle");
+        case TwoPointAnnotation::SELECTION:
+            return toolName("SelectionTool", "Rectangular Selection");
+        case TwoPointAnnotation::CIRCLE:
+            return toolName("CircleTool", "Circle");
+        case TwoPointAnnotation::MARKER:
+            return toolName("MarkerTool", "Marker");
+        case TwoPointAnnotation::PIXELATE:
+            return toolName("PixelateTool", "Pixelate");
+        case TwoPointAnnotation::INVERT:
+            return toolName("InvertTool", "Invert");
+    }
+    return {};
+}
+
+QString labelOf(const CircleCountAnnotation& circle)
+{
+    return QStringLiteral("%1 - %2")
+      .arg(toolName("CircleCountTool", "Circle Counter"))
+      .arg(circle.count);
+}
+
+QString labelOf(const TextAnnotation& text)
+{
+    const QString name = toolName("TextTool", "Text");
+    if (text.text.isEmpty()) {
+        return name;
+    }
+    QString label = QStringLiteral("%1 - %2").arg(name, text.text.trimmed());
+    label = label.split("\n").at(0);
+    if (label.length() > MAX_LABEL_LENGTH) {
+        label.truncate(MAX_LABEL_LENGTH);
+        label += "…";
+    }
+    return label;
+}
+
+} // unnamed namespace
+
+namespace AnnotationRenderer {
+
+void render(QPainter& painter,
+            const QPixmap& background,
+            const Annotation& annotation)
+{
+    const Background input(background);
+    std::visit([&](const auto& value) { renderOne(painter, input, value); },
+               annotation);
+}
+
+void render(QPainter& painter,
+            const QImage& background,
+            const Annotation& annotation)
+{
+    const Background input(background);
+    std::visit([&](const auto& value) { renderOne(painter, input, value); },
+               annotation);
+}
+
+bool renderInPlace(QImage& canvas, const Annotation& annotation)
+{
+    // An opaque selection is inverted straight in the pixels, the other
+    // effects paint from a copy of their input
+    const auto* shape = std::get_if<TwoPointAnnotation>(&annotation);
+    if (shape == nullptr || shape->shape != TwoPointAnnotation::INVERT ||
+        canvas.format() != QImage::Format_RGB32) {
+        return false;
+    }
+    const QRect selection = boundingRectOf(*shape).intersected(canvas.rect());
+    const qreal pixelRatio = canvas.devicePixelRatio();
+    BlendKernels::invert(canvas,
+                         QRect(selection.topLeft() * pixelRatio,
+                               selection.bottomRight() * pixelRatio));
+    return true;
+}
+
+bool readsBackground(const Annotation& annotation)
+{
+    const auto* shape = std::get_if<TwoPointAnnotation>(&annotation);
+    return shape != nullptr && (shape->shape == TwoPointAnnotation::PIXELATE ||
+                                shape->shape == TwoPointAnnotation::INVERT);
+}
+
+void renderSearchArea(QPainter& painter, const Annotation& annotation)
+{
+    // Effects are selected anywhere in their area, whatever they show
+    if (readsBackground(annotation)) {
+        painter.fillRect(boundingRect(annotation), QBrush(Qt::black));
+        return;
+    }
+    render(painter, QPixmap(), annotation);
+}
+
+QRect boundingRect(const Annotation& annotation)
+{
+    return std::visit([](const auto& value) { return boundingRectOf(value); },
+                      annotation);
+}
+
+/**
+ * @brief Tell whether the annotation draws anything at most `radius` pixels
+ * away from `pos`.
+ */
+bool hitTest(const Annotation& annotation, const QPoint& pos, int radius)
+{
+    const QRect area(
+      pos.x() - radius, pos.y() - radius, radius * 2 + 1, radius * 2 + 1);
+    // Antialiasing may spill a pixel out of the bounding rect
+    if (!boundingRect(annotation).adjusted(-1, -1, 1, 1).intersects(area)) {
+        return false;
+    }
+
+    // Only draw the few pixels around the position
+    QImage image(area.size(), QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    QPainter painter(&image);
+    painter.translate(-area.topLeft());
+    renderSearchArea(painter, annotation);
+    painter.end();
+
+    for (int y = 0; y < image.height(); ++y) {
+        const auto* line =
+          reinterpret_cast<const QRgb*>(image.constScanLine(y));
+        for (int x = 0; x < image.width(); ++x) {
+            if (line[x] != 0) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+CaptureTool::Type toolType(const Annotation& annotation)
+{
+    if (std::holds_alternative<PathAnnotation>(annotation)) {
+        return CaptureTool::TYPE_PENCIL;
+    }
+    if (std::holds_alternative<CircleCountAnnotation>(annotation)) {
+        return CaptureTool::TYPE_CIRCLECOUNT;
+    }
+    if (std::holds_alternative<TextAnnotation>(annotation)) {
+        return CaptureTool::TYPE_TEXT;
+    }
+    switch (std::get<TwoPointAnnotation>(annotation).shape) {
+        case TwoPointAnnotation::LINE:
+            return CaptureTool::TYPE_DRAWER;
+        case TwoPointAnnotation::ARROW:
+            return CaptureTool::TYPE_ARROW;
+        case TwoPointAnnotation::RECTANGLE:
+            return CaptureTool::TYPE_RECTANGLE;
+        case TwoPointAnnotation::SELECTION:
+            return CaptureTool::TYPE_SELECTION;
+        case TwoPointAnnotation::CIRCLE:
+            return CaptureTool::TYPE_CIRCLE;
+        case TwoPointAnnotation::MARKER:
+            return CaptureTool::TYPE_MARKER;
+        case TwoPointAnnotation::PIXELATE:
+            return CaptureTool::TYPE_PIXELATE;
+        case TwoPointAnnotation::INVERT:
+            return CaptureTool::TYPE_INVERT;
+    }
+    return CaptureTool::NONE;
+}
+
+QString label(const Annotation& annotation)
+{
+    return std::visit([](const auto& value) { return labelOf(value); },
+                      annotation);
+}
+
+} // namespace AnnotationRenderer
@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "src/tools/annotation.h"
+#include "src/tools/capturetool.h"
+#include <QRect>
+#include <QString>
+
+class QImage;
+class QPainter;
+class QPixmap;
+
+// Stateless functions drawing and inspecting annotations, shared by the
+// editing tools and the composition of the capture.
+namespace AnnotationRenderer {
+
+// `background` is the capture drawn so far, effects read their input from it.
+// It must not be the device the painter draws on, or the effects would read
+// pixels that are being written.
+void render(QPainter& painter,
+            const QPixmap& background,
+            const Annotation& annotation);
+void render(QPainter& painter,
+            const QImage& background,
+            const Annotation& annotation);
+// Effects that only change the pixels under them are applied straight to
+// `canvas`, without a painter or a copy of the background. Returns false if
+// the annotation has to be drawn with render().
+bool renderInPlace(QImage& canvas, const Annotation& annotation);
+// Effects (pixelate, invert) draw from what is under them, they can't be
+// drawn in parts without the rest of the capture
+bool readsBackground(const Annotation& annotation);
+// Draw the area that selects the annotation when clicked
+void renderSearchArea(QPainter& painter, const Annotation& annotation);
+QRect boundingRect(const Annotation& annotation);
+bool hitTest(const Annotation& annotation, const QPoint& pos, int radius);
+
+CaptureTool::Type toolType(const Annotation& annotation);
+// Short text describing the annotation in the layer list
+QString label(const Annotation& annotation);
+
+} // namespace AnnotationRenderer
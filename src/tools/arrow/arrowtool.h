@@ -4,8 +4,6 @@
 #pragma once
 
 #include "src/tools/abstracttwopointtool.h"
-#include <QPainter>
-#include <QPainterPath>
 
 class ArrowTool : public AbstractTwoPointTool
 {
@@ -16,18 +14,12 @@ public:
     QIcon icon(const QColor& background, bool inEditor) const override;
     QString name() const override;
     QString description() const override;
-    QRect boundingRect() const override;
 
     CaptureTool* copy(QObject* parent = nullptr) override;
-    void process(QPainter& painter, const QPixmap& pixmap) override;
 
 protected:
-    void copyParams(const ArrowTool* from, ArrowTool* to);
     CaptureTool::Type type() const override;
 
 public slots:
     void pressed(CaptureContext& context) override;
-
-private:
-    QPainterPath m_arrowPath;
 };
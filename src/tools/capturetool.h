@@ -3,11 +3,13 @@
 
 #pragma once
 
+#include "src/tools/annotation.h"
 #include "src/tools/capturecontext.h"
 #include "src/utils/colorutils.h"
 #include "src/utils/pathinfo.h"
 #include <QIcon>
 #include <QPainter>
+#include <optional>
 
 class CaptureTool : public QObject
 {
@@ -50,6 +52,7 @@ public:
         TYPE_INVERT = 22,
         TYPE_ACCEPT = 23,
         TYPE_CANCEL = 24,
+        TYPE_SCROLLCAPTURE = 25,
     };
     Q_ENUM(Type);
 
@@ -130,7 +133,7 @@ public:
     virtual CaptureTool* copy(QObject* parent = nullptr) = 0;
 
     virtual void setEditMode(bool b) { m_editMode = b; };
-    virtual bool editMode() { return m_editMode; };
+    virtual bool editMode() const { return m_editMode; };
 
     // return true if object was change after editMode
     virtual bool isChanged() { return true; };
@@ -140,6 +143,17 @@ public:
     virtual void setCount(int count) { m_count = count; };
     virtual int count() const { return m_count; };
 
+    // The annotation drawn by the tool, tools that don't draw have none
+    virtual std::optional<Annotation> annotation() const
+    {
+        return std::nullopt;
+    };
+    // Load an existing annotation to edit it with the tool
+    virtual void setAnnotation(const Annotation& annotation)
+    {
+        Q_UNUSED(annotation)
+    };
+
     // Called every time the tool has to draw
     virtual void process(QPainter& painter, const QPixmap& pixmap) = 0;
     virtual void drawSearchArea(QPainter& painter, const QPixmap& pixmap)
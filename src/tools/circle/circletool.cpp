@@ -7,6 +7,7 @@
 CircleTool::CircleTool(QObject* parent)
   : AbstractTwoPointTool(parent)
 {
+    m_shape = TwoPointAnnotation::CIRCLE;
     m_supportsDiagonalAdj = true;
 }
 
@@ -37,13 +38,6 @@ CaptureTool* CircleTool::copy(QObject* parent)
     return tool;
 }
 
-void CircleTool::process(QPainter& painter, const QPixmap& pixmap)
-{
-    Q_UNUSED(pixmap)
-    painter.setPen(QPen(color(), size()));
-    painter.drawEllipse(QRect(points().first, points().second));
-}
-
 void CircleTool::pressed(CaptureContext& context)
 {
     Q_UNUSED(context)
@@ -16,12 +16,12 @@ public:
     QString description() const override;
     QString info() override;
     bool isValid() const override;
+    std::optional<Annotation> annotation() const override;
+    void setAnnotation(const Annotation& annotation) override;
 
     QRect mousePreviewRect(const CaptureContext& context) const override;
-    QRect boundingRect() const override;
 
     CaptureTool* copy(QObject* parent = nullptr) override;
-    void process(QPainter& painter, const QPixmap& pixmap) override;
     void paintMousePreview(QPainter& painter,
                            const CaptureContext& context) override;
 
@@ -34,6 +34,5 @@ public slots:
     void pressed(CaptureContext& context) override;
 
 private:
-    QString m_tempString;
     bool m_valid;
 };
@@ -0,0 +1,176 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "iconatlas.h"
+#include "src/tools/toolfactory.h"
+#include "src/utils/colorutils.h"
+#include "src/utils/globalvalues.h"
+#include <QApplication>
+#include <QPainter>
+#include <QPixmap>
+#include <QPointer>
+#include <QStyle>
+#include <cmath>
+
+namespace {
+int dprKey(qreal devicePixelRatio)
+{
+    return qRound(devicePixelRatio * 100);
+}
+} // unnamed namespace
+
+bool IconAtlas::Key::operator==(const Key& other) const
+{
+    return type == other.type && whiteIcon == other.whiteIcon &&
+           size == other.size && dpr == other.dpr;
+}
+
+size_t qHash(const IconAtlas::Key& key, size_t seed)
+{
+    return qHashMulti(seed, key.type, key.whiteIcon, key.size, key.dpr);
+}
+
+IconAtlas::IconAtlas(QObject* parent)
+  : QObject(parent)
+{}
+
+IconAtlas* IconAtlas::instance()
+{
+    // Owned by the application, so that the pixmaps of its icons are freed
+    // before qApp instead of after it
+    static QPointer<IconAtlas> atlas;
+    if (atlas.isNull()) {
+        atlas = new IconAtlas(qApp);
+    }
+    return atlas;
+}
+
+int IconAtlas::buttonIconSize()
+{
+    return qRound(GlobalValues::buttonBaseSize() * 0.6);
+}
+
+int IconAtlas::panelIconSize()
+{
+    return QApplication::style()->pixelMetric(QStyle::PM_SmallIconSize);
+}
+
+/**
+ * @brief Rasterize the icons used by a capture widget shown on a screen with
+ * the given scale factor, so the first capture does not have to.
+ */
+void IconAtlas::warmUp(qreal devicePixelRatio)
+{
+    const int dpr = dprKey(devicePixelRatio);
+    if (!hasRow(true, buttonIconSize(), dpr)) {
+        addRow(true, buttonIconSize(), dpr);
+    }
+    if (!hasRow(false, buttonIconSize(), dpr)) {
+        addRow(false, buttonIconSize(), dpr);
+    }
+    // The layer list is always drawn on a light background
+    if (!hasRow(false, panelIconSize(), dpr)) {
+        addRow(false, panelIconSize(), dpr);
+    }
+}
+
+QIcon IconAtlas::icon(const CaptureTool* tool,
+                      const QColor& background,
+                      int size,
+                      qreal devicePixelRatio)
+{
+    QIcon shared = icon(tool->type(), background, size, devicePixelRatio);
+    if (shared.isNull()) {
+        // Not one of the toolbar tools, nothing to share
+        return tool->icon(background, true);
+    }
+    return shared;
+}
+
+QIcon IconAtlas::icon(CaptureTool::Type type,
+                      const QColor& background,
+                      int size,
+                      qreal devicePixelRatio)
+{
+    const Key key{ type,
+                   ColorUtils::colorIsDark(background),
+                   size,
+                   dprKey(devicePixelRatio) };
+    auto cached = m_icons.constFind(key);
+    if (cached != m_icons.constEnd()) {
+        return *cached;
+    }
+
+    if (!hasRow(key.whiteIcon, key.size, key.dpr)) {
+        addRow(key.whiteIcon, key.size, key.dpr);
+    }
+    auto rect = m_rects.constFind(key);
+    if (rect == m_rects.constEnd()) {
+        return {};
+    }
+
+    QPixmap pixmap = QPixmap::fromImage(m_atlas.copy(*rect));
+    pixmap.setDevicePixelRatio(key.dpr / 100.0);
+    QIcon icon(pixmap);
+    m_icons.insert(key, icon);
+    return icon;
+}
+
+void IconAtlas::releaseIcons()
+{
+    m_icons.clear();
+}
+
+bool IconAtlas::hasRow(bool whiteIcon, int size, int dpr) const
+{
+    const QList<CaptureTool::Type>& types =
+      CaptureToolButton::getIterableButtonTypes();
+    return !types.isEmpty() &&
+           m_rects.contains(Key{ types.first(), whiteIcon, size, dpr });
+}
+
+/**
+ * @brief Append a row holding the icons of all tools for one variant to the
+ * atlas.
+ */
+void IconAtlas::addRow(bool whiteIcon, int size, int dpr)
+{
+    const QList<CaptureTool::Type>& types =
+      CaptureToolButton::getIterableButtonTypes();
+    const qreal ratio = dpr / 100.0;
+    const int cell = static_cast<int>(std::ceil(size * ratio));
+    // Any background giving the wanted icon color does
+    const QColor background = whiteIcon ? Qt::black : Qt::white;
+
+    const int top = m_atlas.height();
+    QImage atlas(qMax(m_atlas.width(), cell * static_cast<int>(types.size())),
+                 top + cell,
+                 QImage::Format_ARGB32_Premultiplied);
+    atlas.fill(Qt::transparent);
+
+    QPainter painter(&atlas);
+    if (!m_atlas.isNull()) {
+        painter.drawImage(0, 0, m_atlas);
+    }
+    ToolFactory factory;
+    for (int i = 0; i < types.size(); ++i) {
+        CaptureTool* tool = factory.CreateTool(types[i]);
+        if (tool == nullptr) {
+            continue;
+        }
+        const QRect rect(i * cell, top, cell, cell);
+        QPixmap pixmap =
+          tool->icon(background, true).pixmap(QSize(size, size), ratio);
+        // The icon engine may return a smaller pixmap to keep the aspect ratio
+        const QSize drawn =
+          pixmap.size().scaled(rect.size(), Qt::KeepAspectRatio);
+        QRect target(QPoint(), drawn);
+        target.moveCenter(rect.center());
+        painter.drawPixmap(target, pixmap);
+        m_rects.insert(Key{ types[i], whiteIcon, size, dpr }, rect);
+        delete tool;
+    }
+    painter.end();
+
+    m_atlas = atlas;
+}
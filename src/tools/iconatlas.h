@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "src/tools/capturetool.h"
+#include <QHash>
+#include <QIcon>
+#include <QImage>
+#include <QObject>
+#include <QRect>
+
+/**
+ * @brief Tool icons rasterized once and shared by every capture session.
+ *
+ * Loading and rasterizing the tool SVGs is the most expensive part of
+ * building the buttons of a capture widget. The atlas renders the icons of all
+ * tools into a single image, one row per (color variant, size, device pixel
+ * ratio), and hands out icons cut from it. Rows are added on demand, e.g.
+ * when a screen with a new scale factor shows up.
+ */
+class IconAtlas : public QObject
+{
+    Q_OBJECT
+
+public:
+    static IconAtlas* instance();
+
+    // Icon size of the capture tool buttons, in device independent pixels
+    static int buttonIconSize();
+    // Icon size of the layer list of the side panel
+    static int panelIconSize();
+
+    void warmUp(qreal devicePixelRatio);
+    QIcon icon(const CaptureTool* tool,
+               const QColor& background,
+               int size,
+               qreal devicePixelRatio);
+    // Null icon when the type is not one of the toolbar tools
+    QIcon icon(CaptureTool::Type type,
+               const QColor& background,
+               int size,
+               qreal devicePixelRatio);
+    // Drops the icons handed out so far, they are cut from the atlas again
+    // when needed. The atlas itself is kept.
+    void releaseIcons();
+
+private:
+    struct Key
+    {
+        int type;
+        bool whiteIcon;
+        int size;
+        // Device pixel ratio in hundredths, so it can be compared exactly
+        int dpr;
+
+        bool operator==(const Key& other) const;
+    };
+    friend size_t qHash(const Key& key, size_t seed);
+
+    explicit IconAtlas(QObject* parent);
+
+    bool hasRow(bool whiteIcon, int size, int dpr) const;
+    void addRow(bool whiteIcon, int size, int dpr);
+
+    QImage m_atlas;
+    QHash<Key, QRect> m_rects;
+    QHash<Key, QIcon> m_icons;
+};
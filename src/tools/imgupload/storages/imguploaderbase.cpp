@@ -114,6 +114,8 @@ void ImgUploaderBase::showPostUploadDialog()
     m_vLayout->addWidget(m_notification);
 
     auto* imageLabel = new ImageLabel();
+    // m_pixmap is kept for dragging, the label only needs a preview
+    imageLabel->setKeepFullResolution(false);
     imageLabel->setScreenshot(m_pixmap);
     imageLabel->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     connect(imageLabel,
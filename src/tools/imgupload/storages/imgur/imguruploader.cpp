@@ -5,9 +5,9 @@
 #include "src/utils/confighandler.h"
 #include "src/utils/filenamehandler.h"
 #include "src/utils/history.h"
+#include "src/utils/imageencoder.h"
 #include "src/widgets/loadspinner.h"
 #include "src/widgets/notificationwidget.h"
-#include <QBuffer>
 #include <QDesktopServices>
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -75,9 +75,11 @@ void ImgurUploader::handleReply(QNetworkReply* reply)
 
 void ImgurUploader::upload()
 {
-    QByteArray byteArray;
-    QBuffer buffer(&byteArray);
-    pixmap().save(&buffer, "PNG");
+    QString format = ConfigHandler().uploadFormat();
+    if (format.isEmpty()) {
+        format = QStringLiteral("png");
+    }
+    QByteArray byteArray = ImageEncoder::encode(pixmap().toImage(), format);
 
     QUrlQuery urlQuery;
     urlQuery.addQueryItem(QStringLiteral("title"), QStringLiteral(""));
@@ -6,6 +6,7 @@
 #include "src/utils/confighandler.h"
 #include "src/utils/filenamehandler.h"
 #include "src/utils/globalvalues.h"
+#include "src/utils/pixelhash.h"
 #include "terminallauncher.h"
 #include <QCheckBox>
 #include <QDir>
@@ -108,8 +109,13 @@ AppLauncherWidget::AppLauncherWidget(const QPixmap& p, QWidget* parent)
 void AppLauncherWidget::launch(const QModelIndex& index)
 {
     if (!QFileInfo(m_tempFile).isReadable()) {
-        m_tempFile =
-          FileNameHandler().properScreenshotPath(QDir::tempPath(), "png");
+        // The pattern may name the file after the hash of its pixels
+        QString contentHash;
+        if (FileNameHandler::usesContentHash(QDir::tempPath())) {
+            contentHash = PixelHash::hash(m_pixmap.toImage()).toHex();
+        }
+        m_tempFile = FileNameHandler().properScreenshotPath(
+          QDir::tempPath(), "png", contentHash);
         bool ok = m_pixmap.save(m_tempFile);
         if (!ok) {
             QMessageBox::about(
@@ -5,6 +5,7 @@
 
 #if defined(Q_OS_WIN)
 #include "src/utils/filenamehandler.h"
+#include "src/utils/pixelhash.h"
 #include <QDir>
 #include <QMessageBox>
 #include <windows.h>
@@ -22,8 +23,13 @@
 void showOpenWithMenu(const QPixmap& capture)
 {
 #if defined(Q_OS_WIN)
-    QString tempFile =
-      FileNameHandler().properScreenshotPath(QDir::tempPath(), "png");
+    // The pattern may name the file after the hash of its pixels
+    QString contentHash;
+    if (FileNameHandler::usesContentHash(QDir::tempPath())) {
+        contentHash = PixelHash::hash(capture.toImage()).toHex();
+    }
+    QString tempFile = FileNameHandler().properScreenshotPath(
+      QDir::tempPath(), "png", contentHash);
     bool ok = capture.save(tempFile);
     if (!ok) {
         QMessageBox::about(nullptr,
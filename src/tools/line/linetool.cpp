@@ -7,6 +7,7 @@
 LineTool::LineTool(QObject* parent)
   : AbstractTwoPointTool(parent)
 {
+    m_shape = TwoPointAnnotation::LINE;
     m_supportsOrthogonalAdj = true;
     m_supportsDiagonalAdj = true;
 }
@@ -39,13 +40,6 @@ CaptureTool* LineTool::copy(QObject* parent)
     return tool;
 }
 
-void LineTool::process(QPainter& painter, const QPixmap& pixmap)
-{
-    Q_UNUSED(pixmap)
-    painter.setPen(QPen(color(), size()));
-    painter.drawLine(points().first, points().second);
-}
-
 void LineTool::pressed(CaptureContext& context)
 {
     Q_UNUSED(context)
@@ -16,7 +16,6 @@ public:
     QString description() const override;
 
     CaptureTool* copy(QObject* parent = nullptr) override;
-    void process(QPainter& painter, const QPixmap& pixmap) override;
 
 protected:
     CaptureTool::Type type() const override;
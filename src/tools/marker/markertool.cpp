@@ -9,6 +9,7 @@
 MarkerTool::MarkerTool(QObject* parent)
   : AbstractTwoPointTool(parent)
 {
+    m_shape = TwoPointAnnotation::MARKER;
     m_supportsOrthogonalAdj = true;
     m_supportsDiagonalAdj = true;
 }
@@ -48,21 +49,6 @@ CaptureTool* MarkerTool::copy(QObject* parent)
     return tool;
 }
 
-void MarkerTool::process(QPainter& painter, const QPixmap& pixmap)
-{
-    Q_UNUSED(pixmap)
-    auto compositionMode = painter.compositionMode();
-    qreal opacity = painter.opacity();
-    auto pen = painter.pen();
-    painter.setCompositionMode(QPainter::CompositionMode_Multiply);
-    painter.setOpacity(0.35);
-    painter.setPen(QPen(color(), size()));
-    painter.drawLine(points().first, points().second);
-    painter.setPen(pen);
-    painter.setOpacity(opacity);
-    painter.setCompositionMode(compositionMode);
-}
-
 void MarkerTool::paintMousePreview(QPainter& painter,
                                    const CaptureContext& context)
 {
@@ -35,13 +35,6 @@ CaptureTool* PencilTool::copy(QObject* parent)
     return tool;
 }
 
-void PencilTool::process(QPainter& painter, const QPixmap& pixmap)
-{
-    Q_UNUSED(pixmap)
-    painter.setPen(QPen(m_color, size()));
-    painter.drawPolyline(m_points.data(), m_points.size());
-}
-
 void PencilTool::paintMousePreview(QPainter& painter,
                                    const CaptureContext& context)
 {
@@ -236,6 +236,11 @@ bool PinWidget::event(QEvent* event)
     return QWidget::event(event);
 }
 
+qint64 PinWidget::pixmapBytes() const
+{
+    return qint64(m_pixmap.width()) * m_pixmap.height() * m_pixmap.depth() / 8;
+}
+
 void PinWidget::paintEvent(QPaintEvent* event)
 {
     if (m_sizeChanged) {
@@ -19,6 +19,9 @@ public:
                        const QRect& geometry,
                        QWidget* parent = nullptr);
 
+    // Bytes taken by the pinned pixels
+    qint64 pixmapBytes() const;
+
 protected:
     void mouseDoubleClickEvent(QMouseEvent*) override;
     void mousePressEvent(QMouseEvent*) override;
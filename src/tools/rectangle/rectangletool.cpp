@@ -2,13 +2,11 @@
 // SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
 
 #include "rectangletool.h"
-#include <QPainter>
-#include <QPainterPath>
-#include <cmath>
 
 RectangleTool::RectangleTool(QObject* parent)
   : AbstractTwoPointTool(parent)
 {
+    m_shape = TwoPointAnnotation::RECTANGLE;
     m_supportsDiagonalAdj = true;
 }
 
@@ -39,34 +37,6 @@ CaptureTool* RectangleTool::copy(QObject* parent)
     return tool;
 }
 
-void RectangleTool::process(QPainter& painter, const QPixmap& pixmap)
-{
-    Q_UNUSED(pixmap)
-    QPen orig_pen = painter.pen();
-    QBrush orig_brush = painter.brush();
-    painter.setPen(
-      QPen(color(), size(), Qt::SolidLine, Qt::SquareCap, Qt::RoundJoin));
-    painter.setBrush(QBrush(color()));
-    if (size() == 0) {
-        painter.drawRect(QRect(points().first, points().second));
-    } else {
-        QPainterPath path;
-        int offset =
-          size() <= 1 ? 1 : static_cast<int>(round(size() / 2 + 0.5));
-        path.addRoundedRect(
-          QRectF(
-            std::min(points().first.x(), points().second.x()) - offset,
-            std::min(points().first.y(), points().second.y()) - offset,
-            std::abs(points().first.x() - points().second.x()) + offset * 2,
-            std::abs(points().first.y() - points().second.y()) + offset * 2),
-          size(),
-          size());
-        painter.fillPath(path, color());
-    }
-    painter.setPen(orig_pen);
-    painter.setBrush(orig_brush);
-}
-
 void RectangleTool::drawStart(const CaptureContext& context)
 {
     AbstractTwoPointTool::drawStart(context);
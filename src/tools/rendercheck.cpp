@@ -0,0 +1,552 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "rendercheck.h"
+#include "src/tools/annotationrenderer.h"
+#include "src/tools/capturetool.h"
+#include "src/tools/toolfactory.h"
+#include "src/utils/blendkernels.h"
+#include "src/utils/confighandler.h"
+#include "src/widgets/capture/tilecompositor.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QPainter>
+#include <QPixmap>
+#include <QSettings>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace {
+
+// Logical size of the canvas every tool draws on
+const int CANVAS_WIDTH = 240;
+const int CANVAS_HEIGHT = 160;
+const qreal PIXEL_RATIOS[] = { 1.0, 1.25, 2.0 };
+const int REPEATS = 15;
+
+// Full recomposite of a 4K capture, compared between the serial painter and
+// the tile compositor
+const int SCENE_WIDTH = 3840;
+const int SCENE_HEIGHT = 2160;
+const int SCENE_OBJECTS = 200;
+// Every so many objects is an effect, drawn on the whole canvas
+const int SCENE_EFFECT_INTERVAL = 40;
+const int SCENE_REPEATS = 5;
+// The blend kernels run on a 4K frame of pixels
+const int KERNEL_REPEATS = 9;
+
+// Antialiasing and font hinting differ a little between machines, a pixel
+// only counts as different above this difference in one of its channels
+const int CHANNEL_TOLERANCE = 24;
+// Share of the pixels allowed to differ, in thousandths
+const int MAX_DIFFERENT_PERMILLE = 2;
+
+struct Case
+{
+    const char* name;
+    CaptureTool::Type type;
+    Annotation annotation;
+    bool insecurePixelate = false;
+};
+
+TwoPointAnnotation twoPoints(TwoPointAnnotation::Shape shape,
+                             QPoint first,
+                             QPoint second,
+                             const QColor& color,
+                             int thickness)
+{
+    TwoPointAnnotation annotation;
+    annotation.shape = shape;
+    annotation.first = first;
+    annotation.second = second;
+    annotation.color = color;
+    annotation.thickness = thickness;
+    return annotation;
+}
+
+QList<Case> cases()
+{
+    const QColor red(220, 30, 40);
+
+    PathAnnotation pencil;
+    for (int x = 20; x <= 220; x += 10) {
+        pencil.points << QPoint(x, (x / 10) % 2 == 0 ? 40 : 100);
+    }
+    pencil.color = red;
+    pencil.thickness = 3;
+
+    CircleCountAnnotation circleCount;
+    circleCount.center = QPoint(80, 70);
+    circleCount.pointer = QPoint(180, 130);
+    circleCount.color = red;
+    circleCount.thickness = 8;
+    circleCount.count = 7;
+
+    TextAnnotation text;
+    text.text = QStringLiteral("Flameshot 0123\nsecond line");
+    text.font = QFont(QStringLiteral("DejaVu Sans"));
+    text.font.setPixelSize(18);
+    text.color = red;
+    text.topLeft = QPoint(20, 40);
+    text.size = 18;
+
+    const QPoint a(30, 30);
+    const QPoint b(200, 130);
+    return {
+        { "pencil", CaptureTool::TYPE_PENCIL, pencil },
+        { "marker",
+          CaptureTool::TYPE_MARKER,
+          twoPoints(TwoPointAnnotation::MARKER, a, b, Qt::yellow, 14) },
+        { "arrow",
+          CaptureTool::TYPE_ARROW,
+          twoPoints(TwoPointAnnotation::ARROW, a, b, red, 4) },
+        { "line",
+          CaptureTool::TYPE_DRAWER,
+          twoPoints(TwoPointAnnotation::LINE, a, b, red, 4) },
+        { "rectangle",
+          CaptureTool::TYPE_RECTANGLE,
+          twoPoints(TwoPointAnnotation::RECTANGLE, a, b, red, 6) },
+        { "selection",
+          CaptureTool::TYPE_SELECTION,
+          twoPoints(TwoPointAnnotation::SELECTION, a, b, red, 4) },
+        { "circle",
+          CaptureTool::TYPE_CIRCLE,
+          twoPoints(TwoPointAnnotation::CIRCLE, a, b, red, 4) },
+        { "circlecount", CaptureTool::TYPE_CIRCLECOUNT, circleCount },
+        { "text", CaptureTool::TYPE_TEXT, text },
+        { "pixelate",
+          CaptureTool::TYPE_PIXELATE,
+          twoPoints(TwoPointAnnotation::PIXELATE, a, b, red, 4) },
+        { "pixelate_insecure",
+          CaptureTool::TYPE_PIXELATE,
+          twoPoints(TwoPointAnnotation::PIXELATE, a, b, red, 4),
+          true },
+        { "blur_insecure",
+          CaptureTool::TYPE_PIXELATE,
+          twoPoints(TwoPointAnnotation::PIXELATE, a, b, red, 1),
+          true },
+        { "invert",
+          CaptureTool::TYPE_INVERT,
+          twoPoints(TwoPointAnnotation::INVERT, a, b, red, 1) },
+    };
+}
+
+// Gradient with a checkerboard, so that effects reading the capture have
+// something to work on
+QPixmap background(qreal ratio)
+{
+    const int width = static_cast<int>(std::ceil(CANVAS_WIDTH * ratio));
+    const int height = static_cast<int>(std::ceil(CANVAS_HEIGHT * ratio));
+    QImage image(width, height, QImage::Format_RGB32);
+    const int cell = static_cast<int>(std::round(8 * ratio));
+    for (int y = 0; y < height; ++y) {
+        auto* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < width; ++x) {
+            const int shade = ((x / cell) + (y / cell)) % 2 == 0 ? 0 : 40;
+            line[x] = qRgb(qMax(0, x * 255 / width - shade),
+                           qMax(0, y * 255 / height - shade),
+                           160 - shade);
+        }
+    }
+    QPixmap pixmap = QPixmap::fromImage(image);
+    pixmap.setDevicePixelRatio(ratio);
+    return pixmap;
+}
+
+// A tool drawn over the capture, the effects read `canvas` and not the copy
+// being painted
+QImage render(CaptureTool* tool, const QPixmap& canvas, qint64& nsecs)
+{
+    QPixmap pixmap = canvas.copy();
+    QElapsedTimer timer;
+    timer.start();
+    {
+        QPainter painter(&pixmap);
+        painter.setRenderHint(QPainter::Antialiasing);
+        tool->process(painter, canvas);
+    }
+    nsecs = timer.nsecsElapsed();
+    return pixmap.toImage().convertToFormat(
+      QImage::Format_ARGB32_Premultiplied);
+}
+
+// Objects of every kind scattered on a 4K capture
+QList<Annotation> scene()
+{
+    std::mt19937 prng(42);
+    std::uniform_int_distribution<int> randomX(0, SCENE_WIDTH - 1);
+    std::uniform_int_distribution<int> randomY(0, SCENE_HEIGHT - 1);
+    std::uniform_int_distribution<int> randomExtent(20, 400);
+    const TwoPointAnnotation::Shape shapes[] = {
+        TwoPointAnnotation::LINE,      TwoPointAnnotation::ARROW,
+        TwoPointAnnotation::RECTANGLE, TwoPointAnnotation::CIRCLE,
+        TwoPointAnnotation::MARKER,    TwoPointAnnotation::SELECTION
+    };
+    const QColor red(220, 30, 40);
+
+    QList<Annotation> annotations;
+    for (int i = 0; i < SCENE_OBJECTS; ++i) {
+        const int x = randomX(prng);
+        const int y = randomY(prng);
+        const int width = randomExtent(prng);
+        const int height = randomExtent(prng);
+        const QPoint first(x, y);
+        const QPoint second(x + width, y + height);
+
+        if (i % SCENE_EFFECT_INTERVAL == SCENE_EFFECT_INTERVAL - 1) {
+            annotations << twoPoints((i / SCENE_EFFECT_INTERVAL) % 2 == 0
+                                       ? TwoPointAnnotation::PIXELATE
+                                       : TwoPointAnnotation::INVERT,
+                                     first,
+                                     second,
+                                     red,
+                                     4);
+        } else if (i % 10 == 0) {
+            PathAnnotation pencil;
+            for (int step = 0; step <= 10; ++step) {
+                pencil.points << first + QPoint(width * step / 10,
+                                                step % 2 == 0 ? 0 : height);
+            }
+            pencil.color = red;
+            pencil.thickness = 3;
+            annotations << pencil;
+        } else if (i % 10 == 5) {
+            TextAnnotation text;
+            text.text = QStringLiteral("Flameshot %1").arg(i);
+            text.font = QFont(QStringLiteral("DejaVu Sans"));
+            text.font.setPixelSize(18);
+            text.color = red;
+            text.topLeft = first;
+            text.size = 18;
+            annotations << text;
+        } else if (i % 10 == 7) {
+            CircleCountAnnotation circleCount;
+            circleCount.center = first;
+            circleCount.pointer = second;
+            circleCount.color = red;
+            circleCount.thickness = 8;
+            circleCount.count = i;
+            annotations << circleCount;
+        } else {
+            const int thickness = 2 + i % 12;
+            annotations << twoPoints(
+              shapes[i % 6], first, second, red, thickness);
+        }
+    }
+    return annotations;
+}
+
+// Same as CaptureWidget::drawToolsData before the tile compositor
+QImage composeSerially(const QPixmap& canvas,
+                       const QList<Annotation>& annotations)
+{
+    QPixmap pixmap = canvas.copy();
+    QPixmap input;
+    QPainter painter(&pixmap);
+    painter.setRenderHint(QPainter::Antialiasing);
+    for (const Annotation& annotation : annotations) {
+        if (AnnotationRenderer::readsBackground(annotation)) {
+            // Effects read a copy of what is drawn so far, never the pixels
+            // being painted
+            painter.end();
+            input = pixmap.copy();
+            painter.begin(&pixmap);
+            painter.setRenderHint(QPainter::Antialiasing);
+        }
+        AnnotationRenderer::render(painter, input, annotation);
+    }
+    painter.end();
+    return pixmap.toImage();
+}
+
+template<typename Compose>
+double medianUsecs(int repeats, QImage& image, Compose compose)
+{
+    QList<qint64> times;
+    for (int i = 0; i < repeats; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        image = compose();
+        times << timer.nsecsElapsed();
+    }
+    std::sort(times.begin(), times.end());
+    return times[repeats / 2] / 1000.0;
+}
+
+qint64 countDifferentPixels(const QImage& actual, const QImage& expected)
+{
+    if (actual.size() != expected.size()) {
+        return qint64(actual.width()) * actual.height();
+    }
+    qint64 different = 0;
+    for (int y = 0; y < actual.height(); ++y) {
+        const auto* a = reinterpret_cast<const QRgb*>(actual.constScanLine(y));
+        const auto* e =
+          reinterpret_cast<const QRgb*>(expected.constScanLine(y));
+        for (int x = 0; x < actual.width(); ++x) {
+            const int difference =
+              qMax(qMax(qAbs(qRed(a[x]) - qRed(e[x])),
+                        qAbs(qGreen(a[x]) - qGreen(e[x]))),
+                   qMax(qAbs(qBlue(a[x]) - qBlue(e[x])),
+                        qAbs(qAlpha(a[x]) - qAlpha(e[x]))));
+            different += difference > CHANNEL_TOLERANCE ? 1 : 0;
+        }
+    }
+    return different;
+}
+
+// The tiles must give the same image as the serial painter. They are timed
+// with a growing number of threads, the time should drop about linearly.
+int checkComposition(QTextStream& out, const QDir& failed)
+{
+    const QList<Annotation> annotations = scene();
+    const QPixmap canvas = background(1.0).scaled(SCENE_WIDTH, SCENE_HEIGHT);
+
+    QImage expected;
+    const double serialUsecs = medianUsecs(SCENE_REPEATS, expected, [&]() {
+        return composeSerially(canvas, annotations);
+    });
+    expected = expected.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    out << QStringLiteral("%1 %2 %3 us\n")
+             .arg(QStringLiteral("compose 4K serial"), -28)
+             .arg(QStringLiteral("reference"), -16)
+             .arg(serialUsecs, 10, 'f', 1);
+
+    QList<int> threadCounts;
+    for (int threads = 1; threads < QThread::idealThreadCount(); threads *= 2) {
+        threadCounts << threads;
+    }
+    threadCounts << QThread::idealThreadCount();
+
+    int failures = 0;
+    for (const int threads : threadCounts) {
+        QImage image;
+        const double usecs = medianUsecs(SCENE_REPEATS, image, [&]() {
+            return TileCompositor::compose(canvas, annotations, threads)
+              .toImage();
+        });
+        image = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+
+        const QString name =
+          QStringLiteral("compose 4K %1 threads").arg(threads);
+        const qint64 different = countDifferentPixels(image, expected);
+        const qint64 allowed = qint64(image.width()) * image.height() *
+                               MAX_DIFFERENT_PERMILLE / 1000;
+        QString result = QStringLiteral("ok");
+        if (different > allowed) {
+            result = QStringLiteral("FAILED (%1 px)").arg(different);
+            failed.mkpath(QStringLiteral("."));
+            image.save(failed.filePath(
+              QStringLiteral("compose@%1threads.png").arg(threads)));
+            expected.save(
+              failed.filePath(QStringLiteral("compose@serial.png")));
+            ++failures;
+        }
+        out << QStringLiteral("%1 %2 %3 us\n")
+                 .arg(name, -28)
+                 .arg(result, -16)
+                 .arg(usecs, 10, 'f', 1);
+    }
+    return failures;
+}
+
+// A premultiplied pixel, opaque in about half of the cases like most captures
+quint32 randomPixel(std::mt19937& prng)
+{
+    const int alpha = prng() % 2 == 0 ? 255 : static_cast<int>(prng() % 256);
+    return qRgba(static_cast<int>(prng() % (alpha + 1)),
+                 static_cast<int>(prng() % (alpha + 1)),
+                 static_cast<int>(prng() % (alpha + 1)),
+                 alpha);
+}
+
+// Every implementation of a kernel must give the scalar result to the bit
+int checkKernels(QTextStream& out)
+{
+    struct Kernel
+    {
+        const char* name;
+        void (*run)(quint32* dst, const quint32* src, int count);
+    };
+    const Kernel kernels[] = {
+        { "multiply",
+          [](quint32* dst, const quint32* src, int count) {
+              BlendKernels::multiply(dst, src, count, 89);
+          } },
+        { "invert",
+          [](quint32* dst, const quint32*, int count) {
+              BlendKernels::invert(dst, count);
+          } },
+        { "dim",
+          [](quint32* dst, const quint32*, int count) {
+              BlendKernels::dim(dst, count, 100);
+          } },
+        { "over",
+          [](quint32* dst, const quint32* src, int count) {
+              BlendKernels::over(dst, src, count);
+          } },
+    };
+
+    const int count = SCENE_WIDTH * SCENE_HEIGHT;
+    std::mt19937 prng(7);
+    QVector<quint32> source(count);
+    QVector<quint32> destination(count);
+    for (int i = 0; i < count; ++i) {
+        source[i] = randomPixel(prng);
+        destination[i] = randomPixel(prng);
+    }
+
+    const BlendKernels::Isa dispatched = BlendKernels::isa();
+    int failures = 0;
+    for (const Kernel& kernel : kernels) {
+        QVector<quint32> expected;
+        for (int i = 0; i < BlendKernels::ISA_COUNT; ++i) {
+            const auto isa = static_cast<BlendKernels::Isa>(i);
+            if (!BlendKernels::setIsa(isa)) {
+                continue;
+            }
+            QVector<quint32> pixels(count);
+            QList<qint64> times;
+            for (int repeat = 0; repeat < KERNEL_REPEATS; ++repeat) {
+                std::copy(
+                  destination.cbegin(), destination.cend(), pixels.begin());
+                QElapsedTimer timer;
+                timer.start();
+                kernel.run(pixels.data(), source.constData(), count);
+                times << timer.nsecsElapsed();
+            }
+            std::sort(times.begin(), times.end());
+
+            QString result;
+            if (isa == BlendKernels::SCALAR) {
+                expected = pixels;
+                result = QStringLiteral("reference");
+            } else if (pixels == expected) {
+                result = QStringLiteral("ok");
+            } else {
+                result = QStringLiteral("FAILED");
+                ++failures;
+            }
+            out << QStringLiteral("%1 %2 %3 us\n")
+                     .arg(QStringLiteral("kernel %1 %2")
+                            .arg(QLatin1String(kernel.name),
+                                 QLatin1String(BlendKernels::name(isa))),
+                          -28)
+                     .arg(result, -16)
+                     .arg(times[KERNEL_REPEATS / 2] / 1000.0, 10, 'f', 1);
+        }
+    }
+    BlendKernels::setIsa(dispatched);
+    return failures;
+}
+
+} // unnamed namespace
+
+namespace RenderCheck {
+
+int run(const QString& goldenDir, bool update)
+{
+    QTextStream out(stdout);
+    QDir golden(goldenDir);
+    QDir failed(QDir::temp().filePath(QStringLiteral("flameshot-render")));
+    if (update) {
+        golden.mkpath(QStringLiteral("."));
+    }
+    // Without any reference image the renders are only timed, the checks of
+    // the composition and the kernels don't need them
+    const bool compare =
+      !update && !golden.entryList({ QStringLiteral("*.png") }, QDir::Files)
+                    .isEmpty();
+    if (!update && !compare) {
+        out << QStringLiteral("No reference images in %1, the renders are "
+                              "not compared\n")
+                 .arg(golden.path());
+    }
+
+    // The cases change settings, never in the config of the user
+    QTemporaryDir scratch;
+    QSettings::setPath(
+      QSettings::IniFormat, QSettings::UserScope, scratch.path());
+    ConfigHandler config;
+    ToolFactory factory;
+    int failures = 0;
+
+    for (const Case& test : cases()) {
+        config.setInsecurePixelate(test.insecurePixelate);
+        CaptureTool* tool = factory.CreateTool(test.type);
+        tool->setAnnotation(test.annotation);
+
+        for (const qreal ratio : PIXEL_RATIOS) {
+            const QPixmap canvas = background(ratio);
+            QImage image;
+            QList<qint64> times;
+            for (int i = 0; i < REPEATS; ++i) {
+                qint64 nsecs = 0;
+                image = render(tool, canvas, nsecs);
+                times << nsecs;
+            }
+            std::sort(times.begin(), times.end());
+            const double medianUsecs = times[REPEATS / 2] / 1000.0;
+
+            const QString fileName =
+              QStringLiteral("%1@%2x.png")
+                .arg(QLatin1String(test.name))
+                .arg(ratio);
+            QString result;
+            if (update) {
+                result = image.save(golden.filePath(fileName))
+                           ? QStringLiteral("written")
+                           : QStringLiteral("FAILED");
+            } else if (!compare) {
+                result = QStringLiteral("not compared");
+            } else {
+                const QImage expected =
+                  QImage(golden.filePath(fileName))
+                    .convertToFormat(QImage::Format_ARGB32_Premultiplied);
+                const qint64 different = countDifferentPixels(image, expected);
+                const qint64 allowed = qint64(image.width()) *
+                                       image.height() *
+                                       MAX_DIFFERENT_PERMILLE / 1000;
+                if (expected.isNull()) {
+                    result = QStringLiteral("MISSING");
+                } else if (different > allowed) {
+                    result = QStringLiteral("FAILED (%1 px)").arg(different);
+                } else {
+                    result = QStringLiteral("ok");
+                }
+                if (result != QLatin1String("ok")) {
+                    failed.mkpath(QStringLiteral("."));
+                    image.save(failed.filePath(fileName));
+                }
+            }
+            if (result != QLatin1String("ok") &&
+                result != QLatin1String("written") &&
+                result != QLatin1String("not compared")) {
+                ++failures;
+            }
+            out << QStringLiteral("%1 %2 %3 us\n")
+                     .arg(fileName, -28)
+                     .arg(result, -16)
+                     .arg(medianUsecs, 10, 'f', 1);
+        }
+        delete tool;
+    }
+
+    config.setInsecurePixelate(false);
+    failures += checkComposition(out, failed);
+    failures += checkKernels(out);
+
+    if (failures > 0 && !update) {
+        out << QStringLiteral("Rendered images of the failed checks: %1\n")
+                 .arg(failed.path());
+    }
+    return failures;
+}
+
+} // namespace RenderCheck
@@ -0,0 +1,24 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QString>
+
+/**
+ * @brief Renders every drawing tool with fixed parameters and compares the
+ * output with reference images, timing each render.
+ *
+ * Built with FLAMESHOT_RENDER_CHECK or FLAMESHOT_DEBUG_CAPTURE, run through
+ * tests/tool_render.sh under the offscreen platform. Renderer changes that
+ * alter the output, even slightly, show up as a failed comparison next to
+ * their timing.
+ */
+namespace RenderCheck {
+
+// Returns the number of failed comparisons. With `update`, the reference
+// images are written instead of compared. Without any reference image only
+// the checks of the composition and of the blend kernels can fail.
+int run(const QString& goldenDir, bool update);
+
+} // namespace RenderCheck
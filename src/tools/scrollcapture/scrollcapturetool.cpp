@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "scrollcapturetool.h"
+
+ScrollCaptureTool::ScrollCaptureTool(QObject* parent)
+  : AbstractActionTool(parent)
+{}
+
+bool ScrollCaptureTool::closeOnButtonPressed() const
+{
+    return true;
+}
+
+QIcon ScrollCaptureTool::icon(const QColor& background, bool inEditor) const
+{
+    Q_UNUSED(inEditor)
+    return QIcon(iconPath(background) + "scroll-capture.svg");
+}
+
+QString ScrollCaptureTool::name() const
+{
+    return tr("Scrolling Capture");
+}
+
+CaptureTool::Type ScrollCaptureTool::type() const
+{
+    return CaptureTool::TYPE_SCROLLCAPTURE;
+}
+
+QString ScrollCaptureTool::description() const
+{
+    return tr("Capture the selection while scrolling its content");
+}
+
+CaptureTool* ScrollCaptureTool::copy(QObject* parent)
+{
+    return new ScrollCaptureTool(parent);
+}
+
+void ScrollCaptureTool::pressed(CaptureContext& context)
+{
+    emit requestAction(REQ_CLEAR_SELECTION);
+    emit requestAction(REQ_CAPTURE_DONE_OK);
+    // The capture is taken again once the capture window is closed
+    context.request.addTask(CaptureRequest::SCROLL);
+    emit requestAction(REQ_CLOSE_GUI);
+}
@@ -7,6 +7,7 @@
 SelectionTool::SelectionTool(QObject* parent)
   : AbstractTwoPointTool(parent)
 {
+    m_shape = TwoPointAnnotation::SELECTION;
     m_supportsDiagonalAdj = true;
 }
 
@@ -42,14 +43,6 @@ CaptureTool* SelectionTool::copy(QObject* parent)
     return tool;
 }
 
-void SelectionTool::process(QPainter& painter, const QPixmap& pixmap)
-{
-    Q_UNUSED(pixmap)
-    painter.setPen(
-      QPen(color(), size(), Qt::SolidLine, Qt::SquareCap, Qt::MiterJoin));
-    painter.drawRect(QRect(points().first, points().second));
-}
-
 void SelectionTool::pressed(CaptureContext& context)
 {
     Q_UNUSED(context)
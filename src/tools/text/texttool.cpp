@@ -2,12 +2,12 @@
 // SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
 
 #include "texttool.h"
+#include "src/tools/annotationrenderer.h"
 #include "src/utils/confighandler.h"
 #include "textconfig.h"
 #include "textwidget.h"
 
 #define BASE_POINT_SIZE 8
-#define MAX_INFO_LENGTH 24
 
 TextTool::TextTool(QObject* parent)
   : CaptureTool(parent)
@@ -33,7 +33,7 @@ void TextTool::copyParams(const TextTool* from, TextTool* to)
     to->m_text = from->m_text;
     to->m_size = from->m_size;
     to->m_color = from->m_color;
-    to->m_textArea = from->m_textArea;
+    to->m_topLeft = from->m_topLeft;
     to->m_currentPos = from->m_currentPos;
 }
 
@@ -59,7 +59,32 @@ bool TextTool::showMousePreview() const
 
 QRect TextTool::boundingRect() const
 {
-    return m_textArea;
+    return AnnotationRenderer::boundingRect(*annotation());
+}
+
+std::optional<Annotation> TextTool::annotation() const
+{
+    TextAnnotation text;
+    text.text = m_text;
+    text.font = m_font;
+    text.color = m_color;
+    text.alignment = m_alignment;
+    text.topLeft = m_topLeft;
+    text.size = m_size;
+    text.editing = editMode();
+    return text;
+}
+
+void TextTool::setAnnotation(const Annotation& annotation)
+{
+    if (const auto* text = std::get_if<TextAnnotation>(&annotation)) {
+        m_text = text->text;
+        m_font = text->font;
+        m_color = text->color;
+        m_alignment = text->alignment;
+        m_topLeft = text->topLeft;
+        m_size = text->size;
+    }
 }
 
 QIcon TextTool::icon(const QColor& background, bool inEditor) const
@@ -75,16 +100,7 @@ QString TextTool::name() const
 
 QString TextTool::info()
 {
-    if (m_text.length() > 0) {
-        m_tempString = QString("%1 - %2").arg(name(), m_text.trimmed());
-        m_tempString = m_tempString.split("\n").at(0);
-        if (m_tempString.length() > MAX_INFO_LENGTH) {
-            m_tempString.truncate(MAX_INFO_LENGTH);
-            m_tempString += "…";
-        }
-        return m_tempString;
-    }
-    return name();
+    return AnnotationRenderer::label(*annotation());
 }
 
 CaptureTool::Type TextTool::type() const
@@ -195,28 +211,7 @@ CaptureTool* TextTool::copy(QObject* parent)
 
 void TextTool::process(QPainter& painter, const QPixmap& pixmap)
 {
-    Q_UNUSED(pixmap)
-    if (m_text.isEmpty()) {
-        return;
-    }
-    const int val = 5;
-    QFont orig_font = painter.font();
-    QPen orig_pen = painter.pen();
-    QFontMetrics fm(m_font);
-    QSize fontsize(fm.boundingRect(QRect(), 0, m_text).size());
-    fontsize.setWidth(fontsize.width() + val * 2);
-    fontsize.setHeight(fontsize.height() + val * 2);
-    m_textArea.setSize(fontsize);
-    // draw text
-    painter.setFont(m_font);
-    painter.setPen(m_color);
-    if (!editMode()) {
-        painter.drawText(
-          m_textArea + QMargins(-val, -val, val, val), m_alignment, m_text);
-    }
-    painter.setFont(orig_font);
-    painter.setPen(orig_pen);
-
+    AnnotationRenderer::render(painter, pixmap, *annotation());
     if (m_widget != nullptr) {
         m_widget->setAlignment(m_alignment);
     }
@@ -239,7 +234,7 @@ void TextTool::paintMousePreview(QPainter& painter,
 
 void TextTool::drawEnd(const QPoint& point)
 {
-    m_textArea.moveTo(point);
+    m_topLeft = point;
 }
 
 void TextTool::drawMove(const QPoint& point)
@@ -326,7 +321,7 @@ void TextTool::updateFontItalic(const bool italic)
 
 void TextTool::move(const QPoint& pos)
 {
-    m_textArea.moveTo(pos);
+    m_topLeft = pos;
 }
 
 void TextTool::updateAlignment(Qt::AlignmentFlag alignment)
@@ -339,7 +334,7 @@ void TextTool::updateAlignment(Qt::AlignmentFlag alignment)
 
 const QPoint* TextTool::pos()
 {
-    m_currentPos = m_textArea.topLeft();
+    m_currentPos = m_topLeft;
     return &m_currentPos;
 }
 
@@ -22,6 +22,8 @@ public:
     [[nodiscard]] bool isSelectable() const override;
     [[nodiscard]] bool showMousePreview() const override;
     [[nodiscard]] QRect boundingRect() const override;
+    [[nodiscard]] std::optional<Annotation> annotation() const override;
+    void setAnnotation(const Annotation& annotation) override;
 
     [[nodiscard]] QIcon icon(const QColor& background,
                              bool inEditor) const override;
@@ -74,10 +76,8 @@ private:
     QString m_textOld;
     int m_size;
     QColor m_color;
-    QRect m_textArea;
+    QPoint m_topLeft;
     QPointer<TextWidget> m_widget;
     QPointer<TextConfig> m_confW;
     QPoint m_currentPos;
-
-    QString m_tempString;
 };
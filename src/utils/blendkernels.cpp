@@ -0,0 +1,642 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "blendkernels.h"
+#include <QImage>
+#include <atomic>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                   \
+  (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BLEND_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define BLEND_AVX2
+#define BLEND_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(_MSC_VER)
+#define BLEND_AVX2
+#define BLEND_TARGET_AVX2
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+#endif
+
+#if (defined(__ARM_NEON) || defined(__ARM_NEON__)) &&                         \
+  Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+#define BLEND_NEON
+#include <arm_neon.h>
+#endif
+
+// The vector implementations work on 16 bit lanes, two pixels per 128 bits.
+// All products of two channels fit, as premultiplied channels are never above
+// their alpha. x / 255 is rounded as (x + 128 + ((x + 128) >> 8)) >> 8, which
+// is exact in that range.
+
+namespace {
+
+struct Kernels
+{
+    void (*multiply)(quint32* dst, const quint32* src, int count, int opacity);
+    void (*invert)(quint32* dst, int count);
+    void (*dim)(quint32* dst, int count, int alpha);
+    void (*over)(quint32* dst, const quint32* src, int count);
+};
+
+// Scalar
+
+inline uint div255(uint x)
+{
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+void multiplyScalar(quint32* dst, const quint32* src, int count, int opacity)
+{
+    const uint inverse = 255 - opacity;
+    for (int i = 0; i < count; ++i) {
+        const quint32 d = dst[i];
+        const quint32 s = src[i];
+        const uint da = d >> 24;
+        const uint sa = s >> 24;
+        quint32 out = 0;
+        for (int shift = 0; shift < 32; shift += 8) {
+            const uint dc = (d >> shift) & 0xff;
+            const uint sc = (s >> shift) & 0xff;
+            const uint m = div255(sc * (dc + 255 - da) + dc * (255 - sa));
+            out |= div255(m * opacity + dc * inverse) << shift;
+        }
+        dst[i] = out;
+    }
+}
+
+void invertScalar(quint32* dst, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        const quint32 d = dst[i];
+        const uint a = d >> 24;
+        quint32 out = d & 0xff000000;
+        for (int shift = 0; shift < 24; shift += 8) {
+            const uint c = (d >> shift) & 0xff;
+            out |= (c < a ? a - c : 0) << shift;
+        }
+        dst[i] = out;
+    }
+}
+
+void dimScalar(quint32* dst, int count, int alpha)
+{
+    const uint inverse = 255 - alpha;
+    for (int i = 0; i < count; ++i) {
+        const quint32 d = dst[i];
+        quint32 out = 0;
+        for (int shift = 0; shift < 24; shift += 8) {
+            out |= div255(((d >> shift) & 0xff) * inverse) << shift;
+        }
+        out |= (alpha + div255((d >> 24) * inverse)) << 24;
+        dst[i] = out;
+    }
+}
+
+void overScalar(quint32* dst, const quint32* src, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        const quint32 d = dst[i];
+        const quint32 s = src[i];
+        const uint inverse = 255 - (s >> 24);
+        quint32 out = 0;
+        for (int shift = 0; shift < 32; shift += 8) {
+            const uint c = ((s >> shift) & 0xff) +
+                           div255(((d >> shift) & 0xff) * inverse);
+            out |= qMin(c, 255u) << shift;
+        }
+        dst[i] = out;
+    }
+}
+
+const Kernels SCALAR_KERNELS = { multiplyScalar,
+                                 invertScalar,
+                                 dimScalar,
+                                 overScalar };
+
+// SSE2
+
+#if defined(BLEND_SSE2)
+
+inline __m128i div255Sse2(__m128i x)
+{
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+// The alpha of each pixel in its four lanes
+inline __m128i alphaSse2(__m128i x)
+{
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, _MM_SHUFFLE(3, 3, 3, 3)),
+                               _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+inline __m128i multiplyHalfSse2(__m128i d,
+                                __m128i s,
+                                __m128i opacity,
+                                __m128i inverse)
+{
+    const __m128i c255 = _mm_set1_epi16(255);
+    const __m128i da = alphaSse2(d);
+    const __m128i sa = alphaSse2(s);
+    const __m128i m = div255Sse2(_mm_add_epi16(
+      _mm_mullo_epi16(s, _mm_sub_epi16(_mm_add_epi16(d, c255), da)),
+      _mm_mullo_epi16(d, _mm_sub_epi16(c255, sa))));
+    return div255Sse2(
+      _mm_add_epi16(_mm_mullo_epi16(m, opacity), _mm_mullo_epi16(d, inverse)));
+}
+
+void multiplySse2(quint32* dst, const quint32* src, int count, int opacity)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i o = _mm_set1_epi16(static_cast<short>(opacity));
+    const __m128i inverse = _mm_set1_epi16(static_cast<short>(255 - opacity));
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        auto* d128 = reinterpret_cast<__m128i*>(dst + i);
+        const __m128i d = _mm_loadu_si128(d128);
+        const __m128i s =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i low = multiplyHalfSse2(_mm_unpacklo_epi8(d, zero),
+                                             _mm_unpacklo_epi8(s, zero),
+                                             o,
+                                             inverse);
+        const __m128i high = multiplyHalfSse2(_mm_unpackhi_epi8(d, zero),
+                                              _mm_unpackhi_epi8(s, zero),
+                                              o,
+                                              inverse);
+        _mm_storeu_si128(d128, _mm_packus_epi16(low, high));
+    }
+    multiplyScalar(dst + i, src + i, count - i, opacity);
+}
+
+void invertSse2(quint32* dst, int count)
+{
+    const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xff000000u));
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        auto* d128 = reinterpret_cast<__m128i*>(dst + i);
+        const __m128i d = _mm_loadu_si128(d128);
+        const __m128i a = _mm_srli_epi32(d, 24);
+        const __m128i alphas = _mm_or_si128(
+          a, _mm_or_si128(_mm_slli_epi32(a, 8), _mm_slli_epi32(a, 16)));
+        const __m128i colors = _mm_andnot_si128(alphaMask, d);
+        _mm_storeu_si128(d128,
+                         _mm_or_si128(_mm_subs_epu8(alphas, colors),
+                                      _mm_and_si128(d, alphaMask)));
+    }
+    invertScalar(dst + i, count - i);
+}
+
+void dimSse2(quint32* dst, int count, int alpha)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i inverse = _mm_set1_epi16(static_cast<short>(255 - alpha));
+    const auto a = static_cast<short>(alpha);
+    const __m128i added = _mm_set_epi16(a, 0, 0, 0, a, 0, 0, 0);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        auto* d128 = reinterpret_cast<__m128i*>(dst + i);
+        const __m128i d = _mm_loadu_si128(d128);
+        const __m128i low = _mm_add_epi16(
+          div255Sse2(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), inverse)),
+          added);
+        const __m128i high = _mm_add_epi16(
+          div255Sse2(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), inverse)),
+          added);
+        _mm_storeu_si128(d128, _mm_packus_epi16(low, high));
+    }
+    dimScalar(dst + i, count - i, alpha);
+}
+
+inline __m128i overHalfSse2(__m128i d, __m128i s)
+{
+    const __m128i inverse = _mm_sub_epi16(_mm_set1_epi16(255), alphaSse2(s));
+    return _mm_add_epi16(s, div255Sse2(_mm_mullo_epi16(d, inverse)));
+}
+
+void overSse2(quint32* dst, const quint32* src, int count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        auto* d128 = reinterpret_cast<__m128i*>(dst + i);
+        const __m128i d = _mm_loadu_si128(d128);
+        const __m128i s =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i low = overHalfSse2(_mm_unpacklo_epi8(d, zero),
+                                         _mm_unpacklo_epi8(s, zero));
+        const __m128i high = overHalfSse2(_mm_unpackhi_epi8(d, zero),
+                                          _mm_unpackhi_epi8(s, zero));
+        _mm_storeu_si128(d128, _mm_packus_epi16(low, high));
+    }
+    overScalar(dst + i, src + i, count - i);
+}
+
+const Kernels SSE2_KERNELS = { multiplySse2, invertSse2, dimSse2, overSse2 };
+
+#endif
+
+// AVX2, the same as SSE2 on 256 bits. The unpacks and packs work within each
+// 128 bit half, so the pixels stay in order.
+
+#if defined(BLEND_AVX2)
+
+BLEND_TARGET_AVX2 inline __m256i div255Avx2(__m256i x)
+{
+    x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+BLEND_TARGET_AVX2 inline __m256i alphaAvx2(__m256i x)
+{
+    return _mm256_shufflehi_epi16(
+      _mm256_shufflelo_epi16(x, _MM_SHUFFLE(3, 3, 3, 3)),
+      _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+BLEND_TARGET_AVX2 inline __m256i multiplyHalfAvx2(__m256i d,
+                                                  __m256i s,
+                                                  __m256i opacity,
+                                                  __m256i inverse)
+{
+    const __m256i c255 = _mm256_set1_epi16(255);
+    const __m256i da = alphaAvx2(d);
+    const __m256i sa = alphaAvx2(s);
+    const __m256i m = div255Avx2(_mm256_add_epi16(
+      _mm256_mullo_epi16(s, _mm256_sub_epi16(_mm256_add_epi16(d, c255), da)),
+      _mm256_mullo_epi16(d, _mm256_sub_epi16(c255, sa))));
+    return div255Avx2(_mm256_add_epi16(_mm256_mullo_epi16(m, opacity),
+                                       _mm256_mullo_epi16(d, inverse)));
+}
+
+BLEND_TARGET_AVX2 void multiplyAvx2(quint32* dst,
+                                    const quint32* src,
+                                    int count,
+                                    int opacity)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i o = _mm256_set1_epi16(static_cast<short>(opacity));
+    const __m256i inverse =
+      _mm256_set1_epi16(static_cast<short>(255 - opacity));
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        auto* d256 = reinterpret_cast<__m256i*>(dst + i);
+        const __m256i d = _mm256_loadu_si256(d256);
+        const __m256i s =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i low = multiplyHalfAvx2(_mm256_unpacklo_epi8(d, zero),
+                                             _mm256_unpacklo_epi8(s, zero),
+                                             o,
+                                             inverse);
+        const __m256i high = multiplyHalfAvx2(_mm256_unpackhi_epi8(d, zero),
+                                              _mm256_unpackhi_epi8(s, zero),
+                                              o,
+                                              inverse);
+        _mm256_storeu_si256(d256, _mm256_packus_epi16(low, high));
+    }
+    multiplyScalar(dst + i, src + i, count - i, opacity);
+}
+
+BLEND_TARGET_AVX2 void invertAvx2(quint32* dst, int count)
+{
+    const __m256i alphaMask =
+      _mm256_set1_epi32(static_cast<int>(0xff000000u));
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        auto* d256 = reinterpret_cast<__m256i*>(dst + i);
+        const __m256i d = _mm256_loadu_si256(d256);
+        const __m256i a = _mm256_srli_epi32(d, 24);
+        const __m256i alphas = _mm256_or_si256(
+          a,
+          _mm256_or_si256(_mm256_slli_epi32(a, 8), _mm256_slli_epi32(a, 16)));
+        const __m256i colors = _mm256_andnot_si256(alphaMask, d);
+        _mm256_storeu_si256(d256,
+                            _mm256_or_si256(_mm256_subs_epu8(alphas, colors),
+                                            _mm256_and_si256(d, alphaMask)));
+    }
+    invertScalar(dst + i, count - i);
+}
+
+BLEND_TARGET_AVX2 void dimAvx2(quint32* dst, int count, int alpha)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i inverse = _mm256_set1_epi16(static_cast<short>(255 - alpha));
+    const auto a = static_cast<short>(alpha);
+    const __m256i added =
+      _mm256_set_epi16(a, 0, 0, 0, a, 0, 0, 0, a, 0, 0, 0, a, 0, 0, 0);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        auto* d256 = reinterpret_cast<__m256i*>(dst + i);
+        const __m256i d = _mm256_loadu_si256(d256);
+        const __m256i low = _mm256_add_epi16(
+          div255Avx2(
+            _mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), inverse)),
+          added);
+        const __m256i high = _mm256_add_epi16(
+          div255Avx2(
+            _mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), inverse)),
+          added);
+        _mm256_storeu_si256(d256, _mm256_packus_epi16(low, high));
+    }
+    dimScalar(dst + i, count - i, alpha);
+}
+
+BLEND_TARGET_AVX2 inline __m256i overHalfAvx2(__m256i d, __m256i s)
+{
+    const __m256i inverse =
+      _mm256_sub_epi16(_mm256_set1_epi16(255), alphaAvx2(s));
+    return _mm256_add_epi16(s, div255Avx2(_mm256_mullo_epi16(d, inverse)));
+}
+
+BLEND_TARGET_AVX2 void overAvx2(quint32* dst, const quint32* src, int count)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        auto* d256 = reinterpret_cast<__m256i*>(dst + i);
+        const __m256i d = _mm256_loadu_si256(d256);
+        const __m256i s =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i low = overHalfAvx2(_mm256_unpacklo_epi8(d, zero),
+                                         _mm256_unpacklo_epi8(s, zero));
+        const __m256i high = overHalfAvx2(_mm256_unpackhi_epi8(d, zero),
+                                          _mm256_unpackhi_epi8(s, zero));
+        _mm256_storeu_si256(d256, _mm256_packus_epi16(low, high));
+    }
+    overScalar(dst + i, src + i, count - i);
+}
+
+const Kernels AVX2_KERNELS = { multiplyAvx2, invertAvx2, dimAvx2, overAvx2 };
+
+bool cpuHasAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    // The OS must save the 256 bit registers too
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+// NEON, always there on 64 bit ARM
+
+#if defined(BLEND_NEON)
+
+inline uint16x8_t div255Neon(uint16x8_t x)
+{
+    x = vaddq_u16(x, vdupq_n_u16(128));
+    return vshrq_n_u16(vsraq_n_u16(x, x, 8), 8);
+}
+
+// Two pixels, widened to 16 bit lanes with the alpha of each pixel in its
+// four lanes
+inline uint16x8_t alphaNeon(uint8x8_t x)
+{
+    const uint8_t indexes[8] = { 3, 3, 3, 3, 7, 7, 7, 7 };
+    return vmovl_u8(vtbl1_u8(x, vld1_u8(indexes)));
+}
+
+inline uint8x8_t multiplyHalfNeon(uint8x8_t d8,
+                                  uint8x8_t s8,
+                                  uint16x8_t opacity,
+                                  uint16x8_t inverse)
+{
+    const uint16x8_t c255 = vdupq_n_u16(255);
+    const uint16x8_t d = vmovl_u8(d8);
+    const uint16x8_t s = vmovl_u8(s8);
+    const uint16x8_t m = div255Neon(
+      vaddq_u16(vmulq_u16(s, vsubq_u16(vaddq_u16(d, c255), alphaNeon(d8))),
+                vmulq_u16(d, vsubq_u16(c255, alphaNeon(s8)))));
+    return vqmovn_u16(div255Neon(
+      vaddq_u16(vmulq_u16(m, opacity), vmulq_u16(d, inverse))));
+}
+
+void multiplyNeon(quint32* dst, const quint32* src, int count, int opacity)
+{
+    const uint16x8_t o = vdupq_n_u16(static_cast<uint16_t>(opacity));
+    const uint16x8_t inverse =
+      vdupq_n_u16(static_cast<uint16_t>(255 - opacity));
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        auto* d8 = reinterpret_cast<uint8_t*>(dst + i);
+        const uint8x16_t d = vld1q_u8(d8);
+        const uint8x16_t s =
+          vld1q_u8(reinterpret_cast<const uint8_t*>(src + i));
+        const uint8x8_t low =
+          multiplyHalfNeon(vget_low_u8(d), vget_low_u8(s), o, inverse);
+        const uint8x8_t high =
+          multiplyHalfNeon(vget_high_u8(d), vget_high_u8(s), o, inverse);
+        vst1q_u8(d8, vcombine_u8(low, high));
+    }
+    multiplyScalar(dst + i, src + i, count - i, opacity);
+}
+
+void invertNeon(quint32* dst, int count)
+{
+    const uint32x4_t alphaMask = vdupq_n_u32(0xff000000u);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const uint32x4_t d = vld1q_u32(dst + i);
+        const uint32x4_t a = vshrq_n_u32(d, 24);
+        const uint32x4_t alphas =
+          vorrq_u32(a, vorrq_u32(vshlq_n_u32(a, 8), vshlq_n_u32(a, 16)));
+        const uint32x4_t colors = vbicq_u32(d, alphaMask);
+        const uint8x16_t inverted = vqsubq_u8(vreinterpretq_u8_u32(alphas),
+                                              vreinterpretq_u8_u32(colors));
+        vst1q_u32(dst + i,
+                  vorrq_u32(vreinterpretq_u32_u8(inverted),
+                            vandq_u32(d, alphaMask)));
+    }
+    invertScalar(dst + i, count - i);
+}
+
+void dimNeon(quint32* dst, int count, int alpha)
+{
+    const uint16x8_t inverse = vdupq_n_u16(static_cast<uint16_t>(255 - alpha));
+    const auto a = static_cast<uint16_t>(alpha);
+    const uint16_t addedLanes[8] = { 0, 0, 0, a, 0, 0, 0, a };
+    const uint16x8_t added = vld1q_u16(addedLanes);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        auto* d8 = reinterpret_cast<uint8_t*>(dst + i);
+        const uint8x16_t d = vld1q_u8(d8);
+        const uint8x8_t low = vqmovn_u16(vaddq_u16(
+          div255Neon(vmulq_u16(vmovl_u8(vget_low_u8(d)), inverse)), added));
+        const uint8x8_t high = vqmovn_u16(vaddq_u16(
+          div255Neon(vmulq_u16(vmovl_u8(vget_high_u8(d)), inverse)), added));
+        vst1q_u8(d8, vcombine_u8(low, high));
+    }
+    dimScalar(dst + i, count - i, alpha);
+}
+
+inline uint8x8_t overHalfNeon(uint8x8_t d8, uint8x8_t s8)
+{
+    const uint16x8_t inverse = vsubq_u16(vdupq_n_u16(255), alphaNeon(s8));
+    return vqmovn_u16(vaddq_u16(
+      vmovl_u8(s8), div255Neon(vmulq_u16(vmovl_u8(d8), inverse))));
+}
+
+void overNeon(quint32* dst, const quint32* src, int count)
+{
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        auto* d8 = reinterpret_cast<uint8_t*>(dst + i);
+        const uint8x16_t d = vld1q_u8(d8);
+        const uint8x16_t s =
+          vld1q_u8(reinterpret_cast<const uint8_t*>(src + i));
+        vst1q_u8(d8,
+                 vcombine_u8(overHalfNeon(vget_low_u8(d), vget_low_u8(s)),
+                             overHalfNeon(vget_high_u8(d), vget_high_u8(s))));
+    }
+    overScalar(dst + i, src + i, count - i);
+}
+
+const Kernels NEON_KERNELS = { multiplyNeon, invertNeon, dimNeon, overNeon };
+
+#endif
+
+const Kernels* kernelsOf(BlendKernels::Isa isa)
+{
+    switch (isa) {
+        case BlendKernels::SCALAR:
+            return &SCALAR_KERNELS;
+#if defined(BLEND_SSE2)
+        case BlendKernels::SSE2:
+            return &SSE2_KERNELS;
+#endif
+#if defined(BLEND_AVX2)
+        case BlendKernels::AVX2:
+            return cpuHasAvx2() ? &AVX2_KERNELS : nullptr;
+#endif
+#if defined(BLEND_NEON)
+        case BlendKernels::NEON:
+            return &NEON_KERNELS;
+#endif
+        default:
+            return nullptr;
+    }
+}
+
+BlendKernels::Isa bestIsa()
+{
+    // Resolved once, cpuHasAvx2() queries the CPU on every call
+    static const BlendKernels::Isa best = []() {
+        for (int isa = BlendKernels::ISA_COUNT - 1;
+             isa > BlendKernels::SCALAR;
+             --isa) {
+            if (kernelsOf(static_cast<BlendKernels::Isa>(isa)) != nullptr) {
+                return static_cast<BlendKernels::Isa>(isa);
+            }
+        }
+        return BlendKernels::SCALAR;
+    }();
+    return best;
+}
+
+// Set by setIsa() for the benchmarks, the best kernels are used otherwise
+std::atomic<int> forcedIsa{ -1 };
+std::atomic<const Kernels*> forcedKernels{ nullptr };
+
+// Called for every row, without querying the CPU
+const Kernels& kernels()
+{
+    static const Kernels* const best = kernelsOf(bestIsa());
+    const Kernels* forced = forcedKernels.load(std::memory_order_relaxed);
+    return forced != nullptr ? *forced : *best;
+}
+
+} // unnamed namespace
+
+namespace BlendKernels {
+
+bool supported(Isa isa)
+{
+    return kernelsOf(isa) != nullptr;
+}
+
+const char* name(Isa isa)
+{
+    const char* const names[ISA_COUNT] = { "scalar", "sse2", "avx2", "neon" };
+    return isa >= 0 && isa < ISA_COUNT ? names[isa] : "";
+}
+
+Isa isa()
+{
+    const int forced = forcedIsa.load(std::memory_order_relaxed);
+    return forced >= 0 ? static_cast<Isa>(forced) : bestIsa();
+}
+
+bool setIsa(Isa isa)
+{
+    const Kernels* kernels = kernelsOf(isa);
+    if (kernels == nullptr) {
+        return false;
+    }
+    forcedIsa.store(isa, std::memory_order_relaxed);
+    forcedKernels.store(kernels, std::memory_order_relaxed);
+    return true;
+}
+
+void multiply(quint32* dst, const quint32* src, int count, int opacity)
+{
+    kernels().multiply(dst, src, count, opacity);
+}
+
+void invert(quint32* dst, int count)
+{
+    kernels().invert(dst, count);
+}
+
+void dim(quint32* dst, int count, int alpha)
+{
+    kernels().dim(dst, count, alpha);
+}
+
+void over(quint32* dst, const quint32* src, int count)
+{
+    kernels().over(dst, src, count);
+}
+
+bool canBlend(const QImage& image)
+{
+    return image.format() == QImage::Format_RGB32 ||
+           image.format() == QImage::Format_ARGB32_Premultiplied;
+}
+
+void invert(QImage& image, const QRect& rect)
+{
+    const QRect area = rect.intersected(image.rect());
+    for (int y = area.top(); y <= area.bottom(); ++y) {
+        auto* line = reinterpret_cast<quint32*>(image.scanLine(y));
+        invert(line + area.left(), area.width());
+    }
+}
+
+void dim(QImage& image, int alpha)
+{
+    for (int y = 0; y < image.height(); ++y) {
+        auto* line = reinterpret_cast<quint32*>(image.scanLine(y));
+        dim(line, image.width(), alpha);
+    }
+}
+
+} // namespace BlendKernels
@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QRect>
+#include <QtGlobal>
+
+class QImage;
+
+// Per-pixel blends on rows of premultiplied QRgb pixels, as in
+// QImage::Format_ARGB32_Premultiplied and Format_RGB32. Each kernel has a
+// scalar, SSE2, AVX2 and NEON implementation, the best one the CPU supports
+// is picked at the first call. All of them give the same result.
+namespace BlendKernels {
+
+enum Isa
+{
+    SCALAR,
+    SSE2,
+    AVX2,
+    NEON,
+    ISA_COUNT
+};
+
+// Whether the implementation is built and the CPU runs it
+bool supported(Isa isa);
+const char* name(Isa isa);
+Isa isa();
+// Forces an implementation, for the benchmarks of render-check. Returns false
+// if it isn't supported.
+bool setIsa(Isa isa);
+
+// dst = dst multiplied with src (QPainter::CompositionMode_Multiply), mixed
+// with dst by opacity (0-255)
+void multiply(quint32* dst, const quint32* src, int count, int opacity);
+// Each color channel becomes alpha - channel, as QImage::invertPixels()
+void invert(quint32* dst, int count);
+// Black with the given alpha (0-255) drawn over dst
+void dim(quint32* dst, int count, int alpha);
+// src drawn over dst (QPainter::CompositionMode_SourceOver)
+void over(quint32* dst, const quint32* src, int count);
+
+// Whether the kernels can work on the pixels of the image
+bool canBlend(const QImage& image);
+void invert(QImage& image, const QRect& rect);
+void dim(QImage& image, int alpha);
+
+} // namespace BlendKernels
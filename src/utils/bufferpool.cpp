@@ -0,0 +1,205 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "bufferpool.h"
+#include <QMutexLocker>
+#include <cstring>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#elif defined(Q_OS_LINUX) || defined(Q_OS_UNIX)
+#include <sys/mman.h>
+#endif
+
+namespace {
+
+// Smaller images are not worth a mapping of their own
+const size_t MIN_POOLED_SIZE = 1024 * 1024;
+const size_t MEMORY_PAGE_SIZE = 4096;
+const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+// A capture, two frames in flight and the dimmed copy of the editor
+const int MAX_FREE_BUFFERS = 4;
+// A free buffer is reused for an image up to a quarter smaller
+const int MAX_WASTE_DIVISOR = 4;
+
+size_t roundUp(size_t size, size_t alignment)
+{
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+} // unnamed namespace
+
+BufferPool* BufferPool::instance()
+{
+    // Never destroyed, images may still be released during the exit
+    static auto* pool = new BufferPool();
+    return pool;
+}
+
+QImage BufferPool::image(const QSize& size, QImage::Format format)
+{
+    const int depth = QImage::toPixelFormat(format).bitsPerPixel();
+    if (size.isEmpty() || depth == 0) {
+        return QImage(size, format);
+    }
+    // Same 32 bit alignment of the lines as QImage
+    const qint64 bytesPerLine = (qint64(size.width()) * depth + 31) / 32 * 4;
+    const qint64 bytes = bytesPerLine * size.height();
+    if (bytes < qint64(MIN_POOLED_SIZE)) {
+        return QImage(size, format);
+    }
+
+    Buffer buffer;
+    {
+        QMutexLocker locker(&m_mutex);
+        // Best fit among the free buffers
+        int best = -1;
+        for (int i = 0; i < m_free.size(); ++i) {
+            const size_t available = m_free[i].size;
+            if (available >= size_t(bytes) &&
+                available - size_t(bytes) <=
+                  size_t(bytes) / MAX_WASTE_DIVISOR &&
+                (best < 0 || available < m_free[best].size)) {
+                best = i;
+            }
+        }
+        if (best >= 0) {
+            buffer = m_free.takeAt(best);
+        }
+    }
+    if (buffer.data == nullptr) {
+        buffer = allocate(size_t(bytes));
+        if (buffer.data == nullptr) {
+            return QImage(size, format);
+        }
+    }
+
+    return QImage(buffer.data,
+                  size.width(),
+                  size.height(),
+                  bytesPerLine,
+                  format,
+                  &BufferPool::release,
+                  new Buffer(buffer));
+}
+
+QImage BufferPool::copy(const QImage& image)
+{
+    QImage result = this->image(image.size(), image.format());
+    if (result.isNull() || image.isNull()) {
+        return image.copy();
+    }
+    const qsizetype lineBytes =
+      qMin(image.bytesPerLine(), result.bytesPerLine());
+    // The source is read through constScanLine(), scanLine() would detach it
+    for (int y = 0; y < image.height(); ++y) {
+        std::memcpy(result.scanLine(y), image.constScanLine(y), lineBytes);
+    }
+    result.setColorTable(image.colorTable());
+    result.setDevicePixelRatio(image.devicePixelRatio());
+    result.setDotsPerMeterX(image.dotsPerMeterX());
+    result.setDotsPerMeterY(image.dotsPerMeterY());
+    return result;
+}
+
+qint64 BufferPool::trim()
+{
+    QList<Buffer> unused;
+    {
+        QMutexLocker locker(&m_mutex);
+        // The largest buffer stays, the next capture would map it again
+        int largest = -1;
+        for (int i = 0; i < m_free.size(); ++i) {
+            if (largest < 0 || m_free[i].size > m_free[largest].size) {
+                largest = i;
+            }
+        }
+        if (largest < 0) {
+            return 0;
+        }
+        const Buffer kept = m_free.takeAt(largest);
+        unused.swap(m_free);
+        m_free << kept;
+    }
+    qint64 freed = 0;
+    for (const Buffer& buffer : std::as_const(unused)) {
+        freed += buffer.size;
+        deallocate(buffer);
+    }
+    return freed;
+}
+
+BufferPool::Buffer BufferPool::allocate(size_t size)
+{
+    Buffer buffer;
+#if defined(Q_OS_WIN)
+    buffer.size = roundUp(size, MEMORY_PAGE_SIZE);
+    buffer.data = static_cast<uchar*>(VirtualAlloc(
+      nullptr, buffer.size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+#elif defined(Q_OS_LINUX) || defined(Q_OS_UNIX)
+#if defined(MADV_HUGEPAGE)
+    // Whole huge pages, so that the tail of the mapping can use one too
+    buffer.size = size >= HUGE_PAGE_SIZE ? roundUp(size, HUGE_PAGE_SIZE)
+                                         : roundUp(size, MEMORY_PAGE_SIZE);
+#else
+    buffer.size = roundUp(size, MEMORY_PAGE_SIZE);
+#endif
+    void* data = mmap(nullptr,
+                      buffer.size,
+                      PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS,
+                      -1,
+                      0);
+    if (data == MAP_FAILED) {
+        return Buffer();
+    }
+    buffer.data = static_cast<uchar*>(data);
+#if defined(MADV_HUGEPAGE)
+    if (buffer.size >= HUGE_PAGE_SIZE) {
+        // Only a hint, the kernel may not have transparent huge pages enabled
+        madvise(data, buffer.size, MADV_HUGEPAGE);
+    }
+#endif
+#else
+    buffer.size = roundUp(size, MEMORY_PAGE_SIZE);
+    buffer.data =
+      static_cast<uchar*>(qMallocAligned(buffer.size, MEMORY_PAGE_SIZE));
+#endif
+    if (buffer.data == nullptr) {
+        return Buffer();
+    }
+    return buffer;
+}
+
+void BufferPool::deallocate(const Buffer& buffer)
+{
+#if defined(Q_OS_WIN)
+    VirtualFree(buffer.data, 0, MEM_RELEASE);
+#elif defined(Q_OS_LINUX) || defined(Q_OS_UNIX)
+    munmap(buffer.data, buffer.size);
+#else
+    qFreeAligned(buffer.data);
+#endif
+}
+
+void BufferPool::release(void* info)
+{
+    auto* buffer = static_cast<Buffer*>(info);
+    instance()->put(*buffer);
+    delete buffer;
+}
+
+void BufferPool::put(const Buffer& buffer)
+{
+    Buffer evicted;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_free.prepend(buffer);
+        if (m_free.size() > MAX_FREE_BUFFERS) {
+            evicted = m_free.takeLast();
+        }
+    }
+    if (evicted.data != nullptr) {
+        deallocate(evicted);
+    }
+}
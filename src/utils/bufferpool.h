@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QImage>
+#include <QList>
+#include <QMutex>
+#include <QSize>
+
+/**
+ * @brief Pool of the large pixel buffers of the captures.
+ *
+ * A capture of the whole desktop may take more than 100 MB, and every capture
+ * used to allocate several of them: the grab, the composed frames, the copies
+ * of the editor. The pool hands out page aligned buffers as QImage views and
+ * takes them back when the last copy of the image is gone, so the next
+ * capture reuses the memory instead of faulting fresh pages in. Where the
+ * system supports it the buffers are backed by transparent huge pages.
+ *
+ * Images below a megabyte are allocated by QImage as usual, and so are the
+ * captures of QScreen::grabWindow(), which the platform plugin allocates.
+ * The pool is thread safe, the images may be released on any thread.
+ */
+class BufferPool
+{
+public:
+    static BufferPool* instance();
+
+    // An image whose pixels are not initialized
+    QImage image(const QSize& size, QImage::Format format);
+    // Deep copy of `image`, with the same device pixel ratio
+    QImage copy(const QImage& image);
+
+    // Returns the unused buffers to the system, done once the daemon is idle.
+    // The largest one is kept for the next capture of the desktop. Returns
+    // the number of bytes freed.
+    qint64 trim();
+
+private:
+    struct Buffer
+    {
+        uchar* data = nullptr;
+        size_t size = 0;
+    };
+
+    BufferPool() = default;
+
+    static Buffer allocate(size_t size);
+    static void deallocate(const Buffer& buffer);
+    static void release(void* info);
+    void put(const Buffer& buffer);
+
+    QMutex m_mutex;
+    // The unused buffers, the most recently released first
+    QList<Buffer> m_free;
+};
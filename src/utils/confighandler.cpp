@@ -98,6 +98,7 @@ static QMap<class QString, QSharedPointer<ValueHandler>>
     OPTION("copyPathAfterSave"           ,Bool               ( false         )),
     OPTION("antialiasingPinZoom"         ,Bool               ( true          )),
     OPTION("useJpgForClipboard"          ,Bool               ( false         )),
+    OPTION("savePalettePng"              ,Bool               ( true          )),
     OPTION("uploadWithoutConfirmation"   ,Bool               ( false         )),
     OPTION("saveAfterCopy"               ,Bool               ( false         )),
     OPTION("savePath"                    ,ExistingDir        (               )),
@@ -136,8 +137,17 @@ static QMap<class QString, QSharedPointer<ValueHandler>>
     OPTION("showSelectionGeometry"       , BoundedInt        ( 0, 5, 4       )),
     OPTION("showSelectionGeometryHideTime", LowerBoundedInt  ( 0, 3000       )),
     OPTION("jpegQuality"                 , BoundedInt        ( 0,100,75      )),
+    OPTION("exportScale"                 , BoundedInt        ( 0,400,100     )),
+    OPTION("exportMaxWidth"              , LowerBoundedInt   ( 0, 0          )),
+    OPTION("webpLossless"                ,Bool               ( true          )),
+    OPTION("webpQuality"                 , BoundedInt        ( 0,100,90      )),
+    OPTION("avifQuality"                 , BoundedInt        ( 0,100,70      )),
+    OPTION("encodeEffort"                , BoundedInt        ( 0, 2, 1       )),
+    OPTION("uploadFormat"                ,SaveFileExtension  (               )),
+    OPTION("metricsSocket"               ,String             ( ""            )),
     OPTION("reverseArrow"                ,Bool               ( false         )),
     OPTION("insecurePixelate"            ,Bool               ( false         )),
+    OPTION("suggestRedactions"           ,Bool               ( true          )),
 };
 
 static QMap<QString, QSharedPointer<KeySequence>> recognizedShortcuts = {
@@ -177,6 +187,7 @@ static QMap<QString, QSharedPointer<KeySequence>> recognizedShortcuts = {
     SHORTCUT("TYPE_SYM_RESIZE_UP"       ,   "Ctrl+Shift+Up"         ),
     SHORTCUT("TYPE_SYM_RESIZE_DOWN"     ,   "Ctrl+Shift+Down"       ),
     SHORTCUT("TYPE_SELECT_ALL"          ,   "Ctrl+A"                ),
+    SHORTCUT("TYPE_ADD_REGION"          ,   "Insert"                ),
     SHORTCUT("TYPE_MOVE_LEFT"           ,   "Left"                  ),
     SHORTCUT("TYPE_MOVE_RIGHT"          ,   "Right"                 ),
     SHORTCUT("TYPE_MOVE_UP"             ,   "Up"                    ),
@@ -193,6 +204,7 @@ static QMap<QString, QSharedPointer<KeySequence>> recognizedShortcuts = {
     SHORTCUT("TYPE_SIZEINCREASE"        ,                           ),
     SHORTCUT("TYPE_SIZEDECREASE"        ,                           ),
     SHORTCUT("TYPE_CIRCLECOUNT"         ,                           ),
+    SHORTCUT("TYPE_SCROLLCAPTURE"       ,                           ),
 };
 // clang-format on
 
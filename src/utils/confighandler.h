@@ -121,6 +121,7 @@ public:
     CONFIG_GETTER_SETTER(saveAsFileExtension, setSaveAsFileExtension, QString)
     CONFIG_GETTER_SETTER(antialiasingPinZoom, setAntialiasingPinZoom, bool)
     CONFIG_GETTER_SETTER(useJpgForClipboard, setUseJpgForClipboard, bool)
+    CONFIG_GETTER_SETTER(savePalettePng, setSavePalettePng, bool)
     CONFIG_GETTER_SETTER(uploadWithoutConfirmation,
                          setUploadWithoutConfirmation,
                          bool)
@@ -136,8 +137,17 @@ public:
     CONFIG_GETTER_SETTER(saveLastRegion, setSaveLastRegion, bool)
     CONFIG_GETTER_SETTER(showSelectionGeometry, setShowSelectionGeometry, int)
     CONFIG_GETTER_SETTER(jpegQuality, setJpegQuality, int)
+    CONFIG_GETTER_SETTER(exportScale, setExportScale, int)
+    CONFIG_GETTER_SETTER(exportMaxWidth, setExportMaxWidth, int)
+    CONFIG_GETTER_SETTER(webpLossless, setWebpLossless, bool)
+    CONFIG_GETTER_SETTER(webpQuality, setWebpQuality, int)
+    CONFIG_GETTER_SETTER(avifQuality, setAvifQuality, int)
+    CONFIG_GETTER_SETTER(encodeEffort, setEncodeEffort, int)
+    CONFIG_GETTER_SETTER(uploadFormat, setUploadFormat, QString)
+    CONFIG_GETTER_SETTER(metricsSocket, setMetricsSocket, QString)
     CONFIG_GETTER_SETTER(reverseArrow, setReverseArrow, bool)
     CONFIG_GETTER_SETTER(insecurePixelate, setInsecurePixelate, bool)
+    CONFIG_GETTER_SETTER(suggestRedactions, setSuggestRedactions, bool)
     CONFIG_GETTER_SETTER(showSelectionGeometryHideTime,
                          showSelectionGeometryHideTime,
                          int)
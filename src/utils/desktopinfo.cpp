@@ -6,7 +6,10 @@
 
 DesktopInfo::DesktopInfo()
 {
-    auto e = QProcessEnvironment::systemEnvironment();
+    // DesktopInfo is constructed on every grab, the environment of the
+    // process does not change so only read it once
+    static const QProcessEnvironment e =
+      QProcessEnvironment::systemEnvironment();
     XDG_CURRENT_DESKTOP = e.value(QStringLiteral("XDG_CURRENT_DESKTOP"));
     XDG_SESSION_TYPE = e.value(QStringLiteral("XDG_SESSION_TYPE"));
     WAYLAND_DISPLAY = e.value(QStringLiteral("WAYLAND_DISPLAY"));
@@ -10,6 +10,9 @@
 #include <exception>
 #include <locale>
 
+const QLatin1String FileNameHandler::HASH_TOKEN("%{hash}");
+const QLatin1String FileNameHandler::INDEX_TOKEN("%{index}");
+
 FileNameHandler::FileNameHandler(QObject* parent)
   : QObject(parent)
 {
@@ -64,14 +67,20 @@ QString FileNameHandler::parseFilename(const QString& name)
  * - If `path` points to a file, its suffix will be changed to match `format`
  * - If `format` is not given, the suffix will remain untouched, unless `path`
  *   has no suffix, in which case it will be given the "png" suffix
+ * - The `%{hash}` token in the file name is replaced by `contentHash`, and
+ *   the `%{index}` token is dropped unless the caller already replaced it
  * - If the path generated by the previous steps points to an existing file,
  *   "_NUM" will be appended to its base name, where NUM is the first
  * available number that produces a non-existent path (starting from 1).
+ * Named by their content hash, an existing file already holds the same
+ * capture, and the path is returned unchanged.
  * @param path Possibly incomplete file name to transform
  * @param format Desired output file suffix (excluding an initial '.' character)
+ * @param contentHash Hash of the capture, see PixelHash
  */
 QString FileNameHandler::properScreenshotPath(QString path,
-                                              const QString& format)
+                                              const QString& format,
+                                              const QString& contentHash)
 {
     QFileInfo info(path);
     QString suffix = info.suffix();
@@ -85,6 +94,10 @@ QString FileNameHandler::properScreenshotPath(QString path,
                  .path();
     }
 
+    const bool hashed = path.contains(HASH_TOKEN);
+    path.replace(HASH_TOKEN, contentHash);
+    path.remove(INDEX_TOKEN);
+
     if (!format.isEmpty()) {
         // Override suffix to match format
         path += "." + format;
@@ -95,13 +108,23 @@ QString FileNameHandler::properScreenshotPath(QString path,
         path += ".png";
     }
 
-    if (!QFileInfo::exists(path)) {
+    if (!QFileInfo::exists(path) || (hashed && !contentHash.isEmpty())) {
         return path;
     } else {
         return autoNumerateDuplicate(path);
     }
 }
 
+bool FileNameHandler::usesContentHash(const QString& path)
+{
+    if (path.contains(HASH_TOKEN)) {
+        return true;
+    }
+    // A directory gets a file name from the pattern
+    return QFileInfo(path).isDir() &&
+           ConfigHandler().filenamePattern().contains(HASH_TOKEN);
+}
+
 QString FileNameHandler::autoNumerateDuplicate(const QString& path)
 {
     // add numeration in case of repeated filename in the directory
@@ -15,9 +15,16 @@ public:
     QString parseFilename(const QString& name);
 
     QString properScreenshotPath(QString filename,
-                                 const QString& format = QString());
+                                 const QString& format = QString(),
+                                 const QString& contentHash = QString());
+
+    static bool usesContentHash(const QString& path);
 
     static const int MAX_CHARACTERS = 70;
+    // Replaced by the hash of the pixels of the capture
+    static const QLatin1String HASH_TOKEN;
+    // Replaced by the number of the region, when several are saved at once
+    static const QLatin1String INDEX_TOKEN;
 
 private:
     QString autoNumerateDuplicate(const QString& path);
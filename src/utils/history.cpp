@@ -1,5 +1,6 @@
 #include "history.h"
 #include "src/utils/confighandler.h"
+#include "src/utils/resampler.h"
 #include <QDir>
 #include <QFile>
 #include <QProcessEnvironment>
@@ -32,20 +33,23 @@ const QString& History::path()
 void History::save(const QPixmap& pixmap, const QString& fileName)
 {
     // scale preview only in local disk
-    QPixmap pixmapScaled = QPixmap(pixmap);
-    if (pixmap.height() / HISTORYPIXMAP_MAX_PREVIEW_HEIGHT >=
-        pixmap.width() / HISTORYPIXMAP_MAX_PREVIEW_WIDTH) {
-        pixmapScaled = pixmap.scaledToHeight(HISTORYPIXMAP_MAX_PREVIEW_HEIGHT,
-                                             Qt::SmoothTransformation);
+    const int width = pixmap.width();
+    const int height = pixmap.height();
+    QSize size;
+    if (height / HISTORYPIXMAP_MAX_PREVIEW_HEIGHT >=
+        width / HISTORYPIXMAP_MAX_PREVIEW_WIDTH) {
+        size = QSize(qMax(1, width * HISTORYPIXMAP_MAX_PREVIEW_HEIGHT / height),
+                     HISTORYPIXMAP_MAX_PREVIEW_HEIGHT);
     } else {
-        pixmapScaled = pixmap.scaledToWidth(HISTORYPIXMAP_MAX_PREVIEW_WIDTH,
-                                            Qt::SmoothTransformation);
+        size = QSize(HISTORYPIXMAP_MAX_PREVIEW_WIDTH,
+                     qMax(1, height * HISTORYPIXMAP_MAX_PREVIEW_WIDTH / width));
     }
+    QImage preview = Resampler::resize(pixmap.toImage(), size);
 
-    // save preview
-    QFile file(path() + fileName);
+    // save preview, QOI as it is only read back by flameshot
+    QFile file(path() + fileName + HISTORY_CACHE_SUFFIX);
     if (file.open(QIODevice::WriteOnly)) {
-        pixmapScaled.save(&file, "PNG");
+        preview.save(&file, "QOI");
     }
 
     history();
@@ -54,10 +58,12 @@ void History::save(const QPixmap& pixmap, const QString& fileName)
 const QList<QString>& History::history()
 {
     QDir directory(path());
-    QStringList images = directory.entryList(QStringList() << "*.png"
-                                                           << "*.PNG",
-                                             QDir::Files,
-                                             QDir::Time);
+    // Previews of older versions were saved as PNG
+    QStringList images =
+      directory.entryList(QStringList() << "*" HISTORY_CACHE_SUFFIX << "*.png"
+                                        << "*.PNG",
+                          QDir::Files,
+                          QDir::Time);
     int cnt = 0;
     int max = ConfigHandler().uploadHistoryMax();
     m_thumbs.clear();
@@ -74,12 +80,16 @@ const QList<QString>& History::history()
 
 const HistoryFileName& History::unpackFileName(const QString& fileNamePacked)
 {
-    int nPathIndex = fileNamePacked.lastIndexOf("/");
+    QString packed = fileNamePacked;
+    if (packed.endsWith(HISTORY_CACHE_SUFFIX)) {
+        packed.chop(QStringLiteral(HISTORY_CACHE_SUFFIX).size());
+    }
+    int nPathIndex = packed.lastIndexOf("/");
     QStringList unpackedFileName;
     if (nPathIndex == -1) {
-        unpackedFileName = fileNamePacked.split("-");
+        unpackedFileName = packed.split("-");
     } else {
-        unpackedFileName = fileNamePacked.mid(nPathIndex + 1).split("-");
+        unpackedFileName = packed.mid(nPathIndex + 1).split("-");
     }
 
     switch (unpackedFileName.length()) {
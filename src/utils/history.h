@@ -3,6 +3,8 @@
 
 #define HISTORYPIXMAP_MAX_PREVIEW_WIDTH 250
 #define HISTORYPIXMAP_MAX_PREVIEW_HEIGHT 100
+// Appended to the packed file name of the previews in the cache
+#define HISTORY_CACHE_SUFFIX ".qoi"
 
 #include <QList>
 #include <QPixmap>
@@ -0,0 +1,267 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "imageencoder.h"
+#include "src/core/metrics.h"
+#include "src/utils/confighandler.h"
+#include "src/utils/paletteimage.h"
+#include <QBuffer>
+#include <QImageWriter>
+#include <QMimeDatabase>
+
+#ifdef USE_LIBWEBP
+#include <webp/encode.h>
+#endif
+#ifdef USE_LIBAVIF
+#include <QThread>
+#include <avif/avif.h>
+#endif
+
+namespace {
+
+#if defined(USE_LIBWEBP) || defined(USE_LIBAVIF)
+// Settings for each value of the encodeEffort option: fastest, default,
+// smallest files
+#ifdef USE_LIBWEBP
+const int WEBP_LOSSLESS_LEVEL[] = { 0, 2, 6 };
+const int WEBP_METHOD[] = { 0, 3, 5 };
+#endif
+#ifdef USE_LIBAVIF
+const int AVIF_SPEED[] = { 10, 8, 6 };
+#endif
+
+// Rows in memory order B, G, R, A (or X) on little endian machines, which
+// both libraries import without a conversion
+QImage toBgra(const QImage& image)
+{
+    if (!image.hasAlphaChannel()) {
+        return image.convertToFormat(QImage::Format_RGB32);
+    }
+    return image.convertToFormat(QImage::Format_ARGB32);
+}
+#endif
+
+#ifdef USE_LIBWEBP
+int writeToDevice(const uint8_t* data, size_t size, const WebPPicture* picture)
+{
+    auto* device = static_cast<QIODevice*>(picture->custom_ptr);
+    return device->write(reinterpret_cast<const char*>(data), qint64(size)) ==
+           qint64(size);
+}
+
+bool writeWebp(QIODevice* device,
+               const QImage& image,
+               const ImageEncoder::Options& options)
+{
+    WebPConfig webp;
+    if (!WebPConfigInit(&webp)) {
+        return false;
+    }
+    const int effort = qBound(0, options.effort, 2);
+    if (options.webpLossless) {
+        WebPConfigLosslessPreset(&webp, WEBP_LOSSLESS_LEVEL[effort]);
+    } else {
+        webp.quality = float(options.webpQuality);
+        webp.method = WEBP_METHOD[effort];
+    }
+    // Analysis and entropy coding run on a second thread
+    webp.thread_level = 1;
+    if (!WebPValidateConfig(&webp)) {
+        return false;
+    }
+
+    WebPPicture picture;
+    if (!WebPPictureInit(&picture)) {
+        return false;
+    }
+    picture.use_argb = webp.lossless;
+    picture.width = image.width();
+    picture.height = image.height();
+    // The encoded data goes straight to the device, not to a buffer
+    picture.writer = writeToDevice;
+    picture.custom_ptr = device;
+
+    bool ok;
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    const QImage bgra = toBgra(image);
+    ok = bgra.hasAlphaChannel()
+           ? WebPPictureImportBGRA(
+               &picture, bgra.constBits(), int(bgra.bytesPerLine()))
+           : WebPPictureImportBGRX(
+               &picture, bgra.constBits(), int(bgra.bytesPerLine()));
+#else
+    const QImage rgba = image.convertToFormat(QImage::Format_RGBA8888);
+    ok = WebPPictureImportRGBA(
+      &picture, rgba.constBits(), int(rgba.bytesPerLine()));
+#endif
+    ok = ok && WebPEncode(&webp, &picture);
+    WebPPictureFree(&picture);
+    return ok;
+}
+#endif
+
+#ifdef USE_LIBAVIF
+bool writeAvif(QIODevice* device,
+               const QImage& image,
+               const ImageEncoder::Options& options)
+{
+    // 4:4:4 keeps colored text sharp, which 4:2:0 visibly blurs
+    avifImage* avif = avifImageCreate(
+      image.width(), image.height(), 8, AVIF_PIXEL_FORMAT_YUV444);
+    if (avif == nullptr) {
+        return false;
+    }
+    avif->yuvRange = AVIF_RANGE_FULL;
+    const bool lossless = options.avifQuality == AVIF_QUALITY_LOSSLESS;
+    if (lossless) {
+        // The default matrix rounds the colors on their way to YUV, the
+        // identity one stores the RGB values as they are
+        avif->matrixCoefficients = AVIF_MATRIX_COEFFICIENTS_IDENTITY;
+    }
+
+    avifRGBImage rgb;
+    avifRGBImageSetDefaults(&rgb, avif);
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    const QImage source = toBgra(image);
+    rgb.format = AVIF_RGB_FORMAT_BGRA;
+#else
+    const QImage source = image.convertToFormat(QImage::Format_RGBA8888);
+    rgb.format = AVIF_RGB_FORMAT_RGBA;
+#endif
+    rgb.ignoreAlpha = source.hasAlphaChannel() ? AVIF_FALSE : AVIF_TRUE;
+    rgb.pixels = const_cast<uint8_t*>(source.constBits());
+    rgb.rowBytes = uint32_t(source.bytesPerLine());
+
+    avifRWData output = AVIF_DATA_EMPTY;
+    avifEncoder* encoder = avifEncoderCreate();
+    bool ok = encoder != nullptr &&
+              avifImageRGBToYUV(avif, &rgb) == AVIF_RESULT_OK;
+    if (ok) {
+        // The AV1 encoders split the frame in tiles and encode them in
+        // parallel
+        encoder->maxThreads = QThread::idealThreadCount();
+        encoder->autoTiling = AVIF_TRUE;
+        encoder->speed = AVIF_SPEED[qBound(0, options.effort, 2)];
+        encoder->quality = options.avifQuality;
+        if (lossless) {
+            encoder->qualityAlpha = AVIF_QUALITY_LOSSLESS;
+        }
+        ok = avifEncoderWrite(encoder, avif, &output) == AVIF_RESULT_OK &&
+             device->write(reinterpret_cast<const char*>(output.data),
+                           qint64(output.size)) == qint64(output.size);
+    }
+
+    avifRWDataFree(&output);
+    if (encoder != nullptr) {
+        avifEncoderDestroy(encoder);
+    }
+    avifImageDestroy(avif);
+    return ok;
+}
+#endif
+
+} // unnamed namespace
+
+namespace ImageEncoder {
+
+QStringList builtinFormats()
+{
+    QStringList formats;
+#ifdef USE_LIBWEBP
+    formats.append(QStringLiteral("webp"));
+#endif
+#ifdef USE_LIBAVIF
+    formats.append(QStringLiteral("avif"));
+#endif
+    return formats;
+}
+
+QStringList supportedFormats()
+{
+    QStringList formats;
+    for (const auto& format : QImageWriter::supportedImageFormats()) {
+        formats.append(QString::fromLatin1(format));
+    }
+    for (const auto& format : builtinFormats()) {
+        if (!formats.contains(format)) {
+            formats.append(format);
+        }
+    }
+    return formats;
+}
+
+QStringList supportedMimeTypes()
+{
+    QStringList mimeTypes;
+    for (const auto& mimeType : QImageWriter::supportedMimeTypes()) {
+        mimeTypes.append(QString::fromLatin1(mimeType));
+    }
+    QMimeDatabase db;
+    for (const auto& format : builtinFormats()) {
+        const QString mimeType = db.mimeTypeForFile("image." + format).name();
+        if (!mimeTypes.contains(mimeType)) {
+            mimeTypes.append(mimeType);
+        }
+    }
+    return mimeTypes;
+}
+
+Options Options::fromConfig()
+{
+    ConfigHandler config;
+    Options options;
+    options.effort = config.encodeEffort();
+    options.jpegQuality = config.jpegQuality();
+    options.webpLossless = config.webpLossless();
+    options.webpQuality = config.webpQuality();
+    options.avifQuality = config.avifQuality();
+    options.palettePng = config.savePalettePng();
+    return options;
+}
+
+bool write(QIODevice* device, const QImage& image, const QString& format)
+{
+    return write(device, image, format, Options::fromConfig());
+}
+
+bool write(QIODevice* device,
+           const QImage& image,
+           const QString& format,
+           const Options& options)
+{
+    Metrics::Timer timer(Metrics::ENCODE);
+    const QString suffix = format.toLower();
+#ifdef USE_LIBWEBP
+    if (suffix == QLatin1String("webp")) {
+        return writeWebp(device, image, options);
+    }
+#endif
+#ifdef USE_LIBAVIF
+    if (suffix == QLatin1String("avif")) {
+        return writeAvif(device, image, options);
+    }
+#endif
+    if (suffix == QLatin1String("png")) {
+        return PaletteImage::forPng(image, options.palettePng)
+          .save(device, "PNG");
+    }
+
+    QImageWriter writer(device, suffix.toLatin1());
+    if (suffix == QLatin1String("jpg") || suffix == QLatin1String("jpeg")) {
+        writer.setQuality(options.jpegQuality);
+    }
+    return writer.write(image);
+}
+
+QByteArray encode(const QImage& image, const QString& format)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    if (!write(&buffer, image, format)) {
+        return {};
+    }
+    return data;
+}
+
+} // namespace ImageEncoder
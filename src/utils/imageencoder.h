@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QByteArray>
+#include <QImage>
+#include <QStringList>
+
+class QIODevice;
+
+/**
+ * Encodes exported captures with the options from the config. WebP and AVIF
+ * use libwebp and libavif when flameshot is built with USE_LIBWEBP and
+ * USE_LIBAVIF, everything else goes through QImageWriter.
+ *
+ * Formats are named by their file suffix, e.g. "png" or "webp".
+ */
+namespace ImageEncoder {
+
+// Formats with an encoder built into flameshot
+QStringList builtinFormats();
+// Everything a capture can be saved as: QImageWriter's and the built in ones
+QStringList supportedFormats();
+QStringList supportedMimeTypes();
+
+// Encoding settings of the config. ConfigHandler may only be used on the GUI
+// thread, encoders running elsewhere get them read beforehand.
+struct Options
+{
+    // 0 fastest, 1 default, 2 smallest files
+    int effort = 1;
+    int jpegQuality = 75;
+    bool webpLossless = false;
+    int webpQuality = 90;
+    int avifQuality = 70;
+    bool palettePng = false;
+
+    static Options fromConfig();
+};
+
+bool write(QIODevice* device, const QImage& image, const QString& format);
+bool write(QIODevice* device,
+           const QImage& image,
+           const QString& format,
+           const Options& options);
+// Empty if encoding failed
+QByteArray encode(const QImage& image, const QString& format);
+
+} // namespace ImageEncoder
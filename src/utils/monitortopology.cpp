@@ -0,0 +1,253 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "monitortopology.h"
+#include "abstractlogger.h"
+#include "src/utils/desktopinfo.h"
+#include <QGuiApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalSocket>
+#include <QPointer>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QRectF>
+#include <QScreen>
+#include <cmath>
+
+/**
+ * @brief Process wide monitor topology cache.
+ *
+ * The daemon keeps this object alive for its whole lifetime, so the layout is
+ * only recomputed when a screen is added or removed, or when the geometry or
+ * scale of a screen changes. On Hyprland the compositor's event socket is used
+ * as an additional invalidation source, because Qt is not always notified
+ * when the monitor scale changes there.
+ */
+MonitorTopology::MonitorTopology(QObject* parent)
+  : QObject(parent)
+  , m_valid(false)
+  , m_hyprland(false)
+  , m_hyprlandEvents(nullptr)
+{
+    DesktopInfo info;
+    m_hyprland = info.waylandDetected() &&
+                 info.windowManager() == DesktopInfo::HYPRLAND;
+
+    connect(qApp, &QGuiApplication::screenAdded, this, [this](QScreen* s) {
+        watchScreen(s);
+        invalidate();
+    });
+    connect(qApp,
+            &QGuiApplication::screenRemoved,
+            this,
+            &MonitorTopology::invalidate);
+    connect(qApp,
+            &QGuiApplication::primaryScreenChanged,
+            this,
+            &MonitorTopology::invalidate);
+    for (QScreen* const screen : QGuiApplication::screens()) {
+        watchScreen(screen);
+    }
+
+    if (m_hyprland) {
+        connectHyprlandEvents();
+    }
+}
+
+MonitorTopology* MonitorTopology::instance()
+{
+    // Owned by the application, so that it and its socket are destroyed
+    // before qApp instead of after it
+    static QPointer<MonitorTopology> topology;
+    if (topology.isNull()) {
+        topology = new MonitorTopology(qApp);
+    }
+    return topology;
+}
+
+const MonitorTopology::Snapshot& MonitorTopology::snapshot()
+{
+    if (!m_valid) {
+        refresh();
+    }
+    return m_snapshot;
+}
+
+QRect MonitorTopology::desktopGeometry()
+{
+    return snapshot().physical;
+}
+
+QRect MonitorTopology::logicalDesktopGeometry()
+{
+    return snapshot().logical;
+}
+
+void MonitorTopology::invalidate()
+{
+    if (!m_valid) {
+        return;
+    }
+    m_valid = false;
+    emit changed();
+}
+
+void MonitorTopology::watchScreen(QScreen* screen)
+{
+    connect(screen,
+            &QScreen::geometryChanged,
+            this,
+            &MonitorTopology::invalidate);
+    connect(screen,
+            &QScreen::logicalDotsPerInchChanged,
+            this,
+            &MonitorTopology::invalidate);
+    connect(screen,
+            &QScreen::physicalDotsPerInchChanged,
+            this,
+            &MonitorTopology::invalidate);
+}
+
+void MonitorTopology::refresh()
+{
+    Snapshot snapshot;
+    if (!(m_hyprland && snapshotFromHyprland(snapshot))) {
+        snapshotFromQt(snapshot);
+    }
+    m_snapshot = snapshot;
+    m_valid = true;
+}
+
+void MonitorTopology::snapshotFromQt(Snapshot& snapshot) const
+{
+    QRectF logical;
+    for (QScreen* const screen : QGuiApplication::screens()) {
+        const QRect screenRect = screen->geometry();
+        const qreal dpr = screen->devicePixelRatio();
+        const QRectF logicalRect(static_cast<qreal>(screenRect.x()) / dpr,
+                                 static_cast<qreal>(screenRect.y()) / dpr,
+                                 static_cast<qreal>(screenRect.width()) / dpr,
+                                 static_cast<qreal>(screenRect.height()) / dpr);
+
+        Output output;
+        output.name = screen->name();
+        output.geometry = screenRect;
+        output.logicalGeometry = logicalRect.toAlignedRect();
+        output.devicePixelRatio = dpr;
+        snapshot.outputs.append(output);
+
+        snapshot.physical = snapshot.physical.united(screenRect);
+        logical = logical.united(logicalRect);
+    }
+    snapshot.logical = logical.toAlignedRect();
+}
+
+bool MonitorTopology::snapshotFromHyprland(Snapshot& snapshot) const
+{
+#if defined(Q_OS_LINUX) || defined(Q_OS_UNIX)
+    QProcess process;
+    process.start(QStringLiteral("hyprctl"),
+                  { QStringLiteral("monitors"), QStringLiteral("-j") });
+    if (!process.waitForFinished(1000)) {
+        AbstractLogger::warning()
+          << tr("Unable to query Hyprland monitors via hyprctl.");
+        return false;
+    }
+
+    const QByteArray output = process.readAllStandardOutput();
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(output, &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.isArray()) {
+        AbstractLogger::warning()
+          << tr("Failed to parse hyprctl monitor output: %1")
+               .arg(parseError.errorString());
+        return false;
+    }
+
+    const auto toInt = [](double value) {
+        return static_cast<int>(std::llround(value));
+    };
+
+    for (const QJsonValueConstRef& value : doc.array()) {
+        if (!value.isObject()) {
+            continue;
+        }
+        const QJsonObject obj = value.toObject();
+        const double width = obj.value(QStringLiteral("width")).toDouble();
+        const double height = obj.value(QStringLiteral("height")).toDouble();
+        const double x = obj.value(QStringLiteral("x")).toDouble();
+        const double y = obj.value(QStringLiteral("y")).toDouble();
+        const double scale = obj.value(QStringLiteral("scale")).toDouble(1.0);
+        if (width <= 0 || height <= 0 || scale <= 0.0) {
+            continue;
+        }
+
+        Output monitor;
+        monitor.name = obj.value(QStringLiteral("name")).toString();
+        monitor.geometry =
+          QRect(toInt(x), toInt(y), toInt(width), toInt(height));
+        monitor.logicalGeometry = QRect(toInt(x / scale),
+                                        toInt(y / scale),
+                                        toInt(width / scale),
+                                        toInt(height / scale));
+        monitor.devicePixelRatio = scale;
+        snapshot.outputs.append(monitor);
+
+        snapshot.physical = snapshot.physical.united(monitor.geometry);
+        snapshot.logical = snapshot.logical.united(monitor.logicalGeometry);
+    }
+    return !snapshot.outputs.isEmpty();
+#else
+    Q_UNUSED(snapshot);
+    return false;
+#endif
+}
+
+void MonitorTopology::connectHyprlandEvents()
+{
+    auto env = QProcessEnvironment::systemEnvironment();
+    const QString signature =
+      env.value(QStringLiteral("HYPRLAND_INSTANCE_SIGNATURE"));
+    if (signature.isEmpty()) {
+        return;
+    }
+
+    // Hyprland >= 0.40 keeps its sockets in XDG_RUNTIME_DIR, older versions
+    // use /tmp
+    QStringList candidates;
+    const QString runtimeDir = env.value(QStringLiteral("XDG_RUNTIME_DIR"));
+    if (!runtimeDir.isEmpty()) {
+        candidates << runtimeDir + "/hypr/" + signature + "/.socket2.sock";
+    }
+    candidates << "/tmp/hypr/" + signature + "/.socket2.sock";
+
+    m_hyprlandEvents = new QLocalSocket(this);
+    connect(m_hyprlandEvents,
+            &QLocalSocket::readyRead,
+            this,
+            &MonitorTopology::readHyprlandEvents);
+    for (const QString& path : candidates) {
+        m_hyprlandEvents->connectToServer(path, QIODevice::ReadOnly);
+        if (m_hyprlandEvents->waitForConnected(100)) {
+            return;
+        }
+    }
+    // Qt screen signals remain the only invalidation source
+    delete m_hyprlandEvents;
+    m_hyprlandEvents = nullptr;
+}
+
+void MonitorTopology::readHyprlandEvents()
+{
+    // Events are newline separated and have the form `EVENT>>DATA`
+    while (m_hyprlandEvents->canReadLine()) {
+        const QByteArray line = m_hyprlandEvents->readLine();
+        const QByteArray event = line.left(line.indexOf(">>"));
+        if (event.startsWith("monitoradded") ||
+            event.startsWith("monitorremoved") || event == "configreloaded") {
+            invalidate();
+        }
+    }
+}
@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QList>
+#include <QObject>
+#include <QRect>
+#include <QString>
+
+class QLocalSocket;
+class QScreen;
+
+/**
+ * @brief Cached description of the monitor layout.
+ *
+ * Computing the desktop geometry may be expensive (on Hyprland it requires
+ * spawning `hyprctl`), so the result is computed once and reused by every
+ * grab until the layout changes.
+ */
+class MonitorTopology : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Output
+    {
+        QString name;
+        // Geometry in physical pixels
+        QRect geometry;
+        // Geometry in logical (device independent) pixels
+        QRect logicalGeometry;
+        qreal devicePixelRatio = 1.0;
+    };
+
+    struct Snapshot
+    {
+        // Bounding rect of all outputs in physical pixels
+        QRect physical;
+        // Bounding rect of all outputs in logical pixels
+        QRect logical;
+        QList<Output> outputs;
+    };
+
+    static MonitorTopology* instance();
+
+    const Snapshot& snapshot();
+    QRect desktopGeometry();
+    QRect logicalDesktopGeometry();
+
+public slots:
+    void invalidate();
+
+signals:
+    void changed();
+
+private:
+    explicit MonitorTopology(QObject* parent);
+
+    void watchScreen(QScreen* screen);
+    void refresh();
+    void snapshotFromQt(Snapshot& snapshot) const;
+    bool snapshotFromHyprland(Snapshot& snapshot) const;
+    void connectHyprlandEvents();
+    void readHyprlandEvents();
+
+    Snapshot m_snapshot;
+    bool m_valid;
+    bool m_hyprland;
+    QLocalSocket* m_hyprlandEvents;
+};
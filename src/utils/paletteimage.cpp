@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "paletteimage.h"
+#include "src/utils/confighandler.h"
+#include <QVector>
+#include <array>
+
+namespace {
+
+// Open addressing set of colors, sized so it stays sparse at MAX_COLORS
+const int TABLE_BITS = 10;
+const int TABLE_SIZE = 1 << TABLE_BITS;
+static_assert(TABLE_SIZE >= PaletteImage::MAX_COLORS * 4);
+
+class ColorTable
+{
+public:
+    explicit ColorTable(int maxColors)
+      : m_maxColors(maxColors)
+    {
+        m_slots.fill(EMPTY);
+    }
+
+    // Index of the color in the palette, -1 once the palette is full
+    int insert(QRgb color)
+    {
+        quint32 slot = (color * 0x9e3779b1U) >> (32 - TABLE_BITS);
+        while (m_slots[slot] != EMPTY) {
+            if (m_colors[m_slots[slot]] == color) {
+                return m_slots[slot];
+            }
+            slot = (slot + 1) & (TABLE_SIZE - 1);
+        }
+        if (m_colors.size() >= m_maxColors) {
+            return -1;
+        }
+        m_slots[slot] = static_cast<qint16>(m_colors.size());
+        m_colors.append(color);
+        return m_slots[slot];
+    }
+
+    const QVector<QRgb>& colors() const { return m_colors; }
+
+private:
+    static constexpr qint16 EMPTY = -1;
+
+    int m_maxColors;
+    std::array<qint16, TABLE_SIZE> m_slots;
+    QVector<QRgb> m_colors;
+};
+
+QImage unpremultiplied(const QImage& image)
+{
+    if (image.format() == QImage::Format_RGB32 ||
+        image.format() == QImage::Format_ARGB32) {
+        return image;
+    }
+    return image.convertToFormat(image.hasAlphaChannel()
+                                   ? QImage::Format_ARGB32
+                                   : QImage::Format_RGB32);
+}
+
+/**
+ * @brief Call `visit(x, y, index)` for every pixel with the palette index
+ * of its color. Returns false as soon as the palette overflows.
+ *
+ * Screenshots are mostly runs of the same color, these are skipped four
+ * pixels at a time without touching the table.
+ */
+template<typename Visit>
+bool scan(const QImage& image, ColorTable& table, Visit visit)
+{
+    const int width = image.width();
+    for (int y = 0; y < image.height(); ++y) {
+        const auto* line =
+          reinterpret_cast<const QRgb*>(image.constScanLine(y));
+        QRgb last = line[0];
+        int index = table.insert(last);
+        if (index < 0) {
+            return false;
+        }
+        int x = 0;
+        while (x < width) {
+            while (x + 4 <= width &&
+                   ((line[x] ^ last) | (line[x + 1] ^ last) |
+                    (line[x + 2] ^ last) | (line[x + 3] ^ last)) == 0) {
+                visit(x, y, index, 4);
+                x += 4;
+            }
+            if (x == width) {
+                break;
+            }
+            if (line[x] != last) {
+                last = line[x];
+                index = table.insert(last);
+                if (index < 0) {
+                    return false;
+                }
+            }
+            visit(x, y, index, 1);
+            ++x;
+        }
+    }
+    return true;
+}
+
+} // unnamed namespace
+
+namespace PaletteImage {
+
+QImage toIndexed(const QImage& image)
+{
+    if (image.isNull()) {
+        return {};
+    }
+    const QImage source = unpremultiplied(image);
+    QImage indexed(source.size(), QImage::Format_Indexed8);
+    if (indexed.isNull()) {
+        return {};
+    }
+
+    ColorTable table(MAX_COLORS);
+    bool fits = scan(source, table, [&indexed](int x, int y, int index, int n) {
+        uchar* line = indexed.scanLine(y);
+        for (int i = 0; i < n; ++i) {
+            line[x + i] = static_cast<uchar>(index);
+        }
+    });
+    if (!fits) {
+        return {};
+    }
+
+    indexed.setColorTable(table.colors());
+    indexed.setDevicePixelRatio(image.devicePixelRatio());
+    indexed.setDotsPerMeterX(image.dotsPerMeterX());
+    indexed.setDotsPerMeterY(image.dotsPerMeterY());
+    return indexed;
+}
+
+QImage forPng(const QImage& image)
+{
+    return forPng(image, ConfigHandler().savePalettePng());
+}
+
+QImage forPng(const QImage& image, bool palette)
+{
+    if (!palette) {
+        return image;
+    }
+    QImage indexed = toIndexed(image);
+    return indexed.isNull() ? image : indexed;
+}
+
+} // namespace PaletteImage
@@ -0,0 +1,23 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QImage>
+
+// Lossless conversion of captures with few colors (most UI screenshots) to
+// 8-bit indexed images, which are written as much smaller palette PNGs.
+namespace PaletteImage {
+
+const int MAX_COLORS = 256;
+
+// Indexed copy of the image, null if it has more than MAX_COLORS colors.
+// The colors are counted while the copy is made, it gives up as soon as
+// there are too many.
+QImage toIndexed(const QImage& image);
+// Image to encode as PNG, indexed when enabled in the config and lossless
+QImage forPng(const QImage& image);
+// Same with the setting read by the caller, for other threads than the GUI
+QImage forPng(const QImage& image, bool palette);
+
+} // namespace PaletteImage
@@ -0,0 +1,179 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "pixelhash.h"
+#include <QtEndian>
+#include <array>
+#include <cstring>
+
+namespace {
+
+const int LANES = 8;
+const int STRIPE_SIZE = LANES * 8;
+// The accumulators are scrambled after every block of stripes, so that
+// products can't cancel out over long inputs
+const int STRIPES_PER_BLOCK = 16;
+
+const quint64 PRIME32_1 = 0x9E3779B1U;
+const quint64 PRIME64_1 = 0x9E3779B185EBCA87ULL;
+const quint64 PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+const quint64 PRIME64_3 = 0x165667B19E3779F9ULL;
+const quint64 PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+const quint64 PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+// Stripe n of a block is mixed with KEYS[n .. n + LANES - 1]
+constexpr std::array<quint64, STRIPES_PER_BLOCK + LANES> makeKeys()
+{
+    // splitmix64
+    std::array<quint64, STRIPES_PER_BLOCK + LANES> keys{};
+    quint64 state = PRIME64_3;
+    for (auto& key : keys) {
+        state += 0x9E3779B97F4A7C15ULL;
+        quint64 z = state;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        key = z ^ (z >> 31);
+    }
+    return keys;
+}
+
+constexpr auto KEYS = makeKeys();
+
+inline quint64 readLittleEndian(const uchar* p)
+{
+    quint64 value;
+    std::memcpy(&value, p, sizeof(value));
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    value = qbswap(value);
+#endif
+    return value;
+}
+
+inline void accumulate(quint64* acc, const uchar* stripe, const quint64* keys)
+{
+    for (int i = 0; i < LANES; ++i) {
+        const quint64 data = readLittleEndian(stripe + 8 * i);
+        const quint64 key = data ^ keys[i];
+        // Keeps the input itself in the state too, a zero product would
+        // lose it otherwise
+        acc[i ^ 1] += data;
+        acc[i] += (key & 0xFFFFFFFFU) * (key >> 32);
+    }
+}
+
+inline void scramble(quint64* acc)
+{
+    for (int i = 0; i < LANES; ++i) {
+        acc[i] = (acc[i] ^ (acc[i] >> 47) ^ KEYS[i]) * PRIME32_1;
+    }
+}
+
+// Low and high halves of the 128 bit product, folded
+inline quint64 multiplyFold(quint64 a, quint64 b)
+{
+    const quint64 aLow = a & 0xFFFFFFFFU;
+    const quint64 aHigh = a >> 32;
+    const quint64 bLow = b & 0xFFFFFFFFU;
+    const quint64 bHigh = b >> 32;
+    const quint64 lowLow = aLow * bLow;
+    const quint64 highLow = aHigh * bLow;
+    const quint64 lowHigh = aLow * bHigh;
+    const quint64 highHigh = aHigh * bHigh;
+    const quint64 cross =
+      (lowLow >> 32) + (highLow & 0xFFFFFFFFU) + (lowHigh & 0xFFFFFFFFU);
+    const quint64 high =
+      highHigh + (highLow >> 32) + (lowHigh >> 32) + (cross >> 32);
+    const quint64 low = (cross << 32) | (lowLow & 0xFFFFFFFFU);
+    return low ^ high;
+}
+
+inline quint64 avalanche(quint64 h)
+{
+    h ^= h >> 33;
+    h *= PRIME64_2;
+    h ^= h >> 29;
+    h *= PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+quint64 merge(const quint64* acc, quint64 start, int keyOffset)
+{
+    quint64 result = start;
+    for (int i = 0; i < LANES; i += 2) {
+        result += multiplyFold(acc[i] ^ KEYS[keyOffset + i],
+                               acc[i + 1] ^ KEYS[keyOffset + i + 1]);
+    }
+    return avalanche(result);
+}
+
+} // unnamed namespace
+
+namespace PixelHash {
+
+QString Hash::toHex() const
+{
+    return QStringLiteral("%1%2")
+      .arg(high, 16, 16, QLatin1Char('0'))
+      .arg(low, 16, 16, QLatin1Char('0'));
+}
+
+Hash hash(const uchar* data, qsizetype size, quint64 seed)
+{
+    quint64 acc[LANES] = { PRIME32_1 ^ seed, PRIME64_1 + seed,
+                           PRIME64_2 - seed, PRIME64_3 ^ seed,
+                           PRIME64_4 + seed, PRIME64_5 - seed,
+                           PRIME32_1 + seed, PRIME64_1 ^ seed };
+
+    const uchar* p = data;
+    qsizetype left = size;
+    const qsizetype blockSize = STRIPE_SIZE * STRIPES_PER_BLOCK;
+    while (left >= blockSize) {
+        for (int s = 0; s < STRIPES_PER_BLOCK; ++s) {
+            accumulate(acc, p + s * STRIPE_SIZE, KEYS.data() + s);
+        }
+        scramble(acc);
+        p += blockSize;
+        left -= blockSize;
+    }
+
+    int stripe = 0;
+    while (left >= STRIPE_SIZE) {
+        accumulate(acc, p, KEYS.data() + stripe++);
+        p += STRIPE_SIZE;
+        left -= STRIPE_SIZE;
+    }
+    if (left > 0) {
+        // Zero padded, the length is merged in below
+        uchar last[STRIPE_SIZE] = {};
+        std::memcpy(last, p, size_t(left));
+        accumulate(acc, last, KEYS.data() + stripe);
+    }
+
+    const auto length = quint64(size);
+    Hash result;
+    result.low = merge(acc, length * PRIME64_1, 0);
+    result.high = merge(acc, ~length * PRIME64_2, STRIPES_PER_BLOCK);
+    return result;
+}
+
+Hash hash(const QImage& image)
+{
+    if (image.isNull()) {
+        return {};
+    }
+
+    // Opaque pixels of both are the same bytes, and captures are usually
+    // already in one of them
+    QImage pixels = image;
+    if (pixels.format() != QImage::Format_RGB32 &&
+        pixels.format() != QImage::Format_ARGB32_Premultiplied) {
+        pixels = pixels.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    }
+    const quint64 seed =
+      quint64(pixels.width()) << 32 | quint32(pixels.height());
+    // Rows of 32 bit pixels have no padding
+    return hash(pixels.constBits(), pixels.sizeInBytes(), seed);
+}
+
+} // namespace PixelHash
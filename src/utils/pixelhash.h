@@ -0,0 +1,29 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QImage>
+#include <QString>
+
+// Fast 128 bit hash of pixel data, built like XXH3: eight 64 bit lanes
+// accumulate 32x32 bit products of the input mixed with a key, in a loop the
+// compiler turns into SIMD code. It is not compatible with XXH3 and must not
+// be used where an attacker picks the input.
+namespace PixelHash {
+
+struct Hash
+{
+    quint64 low = 0;
+    quint64 high = 0;
+
+    // 32 lowercase hex digits
+    QString toHex() const;
+};
+
+Hash hash(const uchar* data, qsizetype size, quint64 seed = 0);
+// Hash of the visible pixels, the same for a capture in RGB32 and in the
+// equivalent premultiplied format. The size is part of the hash.
+Hash hash(const QImage& image);
+
+} // namespace PixelHash
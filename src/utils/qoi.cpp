@@ -0,0 +1,234 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "qoi.h"
+#include <array>
+#include <cstring>
+
+namespace {
+
+const char MAGIC[] = "qoif";
+const int HEADER_SIZE = 14;
+const uchar PADDING[] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+
+const uchar OP_INDEX = 0x00;
+const uchar OP_DIFF = 0x40;
+const uchar OP_LUMA = 0x80;
+const uchar OP_RUN = 0xc0;
+const uchar OP_RGB = 0xfe;
+const uchar OP_RGBA = 0xff;
+const uchar OP_MASK = 0xc0;
+const int MAX_RUN = 62;
+
+inline int hash(QRgb px)
+{
+    return (qRed(px) * 3 + qGreen(px) * 5 + qBlue(px) * 7 + qAlpha(px) * 11) &
+           63;
+}
+
+inline void writeBigEndian(uchar* p, quint32 value)
+{
+    p[0] = value >> 24;
+    p[1] = value >> 16;
+    p[2] = value >> 8;
+    p[3] = value;
+}
+
+inline quint32 readBigEndian(const uchar* p)
+{
+    return (quint32(p[0]) << 24) | (quint32(p[1]) << 16) |
+           (quint32(p[2]) << 8) | quint32(p[3]);
+}
+
+} // unnamed namespace
+
+namespace Qoi {
+
+bool isQoi(const QByteArray& data)
+{
+    return data.startsWith(MAGIC);
+}
+
+QByteArray encode(const QImage& image)
+{
+    const int width = image.width();
+    const int height = image.height();
+    if (image.isNull() || qint64(width) * height > MAX_PIXELS) {
+        return {};
+    }
+
+    const bool alpha = image.hasAlphaChannel();
+    // Both formats are native QRgb, no conversion for the usual captures
+    const QImage src = image.convertToFormat(
+      alpha ? QImage::Format_ARGB32 : QImage::Format_RGB32);
+    const int channels = alpha ? 4 : 3;
+
+    // Worst case is one tagged RGB(A) op per pixel, written without checks
+    QByteArray out;
+    out.resize(HEADER_SIZE + qsizetype(width) * height * (channels + 1) +
+               sizeof(PADDING));
+    auto* begin = reinterpret_cast<uchar*>(out.data());
+    uchar* p = begin;
+
+    std::memcpy(p, MAGIC, 4);
+    writeBigEndian(p + 4, width);
+    writeBigEndian(p + 8, height);
+    p[12] = channels;
+    p[13] = 0; // sRGB with linear alpha
+    p += HEADER_SIZE;
+
+    std::array<QRgb, 64> index{};
+    QRgb prev = qRgba(0, 0, 0, 255);
+    int run = 0;
+    for (int y = 0; y < height; ++y) {
+        const auto* line = reinterpret_cast<const QRgb*>(src.constScanLine(y));
+        for (int x = 0; x < width; ++x) {
+            const QRgb px = alpha ? line[x] : (line[x] | 0xff000000);
+            if (px == prev) {
+                if (++run == MAX_RUN) {
+                    *p++ = OP_RUN | (run - 1);
+                    run = 0;
+                }
+                continue;
+            }
+            if (run > 0) {
+                *p++ = OP_RUN | (run - 1);
+                run = 0;
+            }
+
+            const int slot = hash(px);
+            if (index[slot] == px) {
+                *p++ = OP_INDEX | slot;
+            } else if (qAlpha(px) == qAlpha(prev)) {
+                index[slot] = px;
+                // Differences wrap around, as specified
+                const qint8 dr = qint8(qRed(px) - qRed(prev));
+                const qint8 dg = qint8(qGreen(px) - qGreen(prev));
+                const qint8 db = qint8(qBlue(px) - qBlue(prev));
+                const qint8 dgr = qint8(dr - dg);
+                const qint8 dgb = qint8(db - dg);
+                if (dr > -3 && dr < 2 && dg > -3 && dg < 2 && db > -3 &&
+                    db < 2) {
+                    *p++ = OP_DIFF | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2);
+                } else if (dgr > -9 && dgr < 8 && dg > -33 && dg < 32 &&
+                           dgb > -9 && dgb < 8) {
+                    *p++ = OP_LUMA | (dg + 32);
+                    *p++ = (dgr + 8) << 4 | (dgb + 8);
+                } else {
+                    *p++ = OP_RGB;
+                    *p++ = qRed(px);
+                    *p++ = qGreen(px);
+                    *p++ = qBlue(px);
+                }
+            } else {
+                index[slot] = px;
+                *p++ = OP_RGBA;
+                *p++ = qRed(px);
+                *p++ = qGreen(px);
+                *p++ = qBlue(px);
+                *p++ = qAlpha(px);
+            }
+            prev = px;
+        }
+    }
+    if (run > 0) {
+        *p++ = OP_RUN | (run - 1);
+    }
+    std::memcpy(p, PADDING, sizeof(PADDING));
+    p += sizeof(PADDING);
+
+    out.truncate(p - begin);
+    return out;
+}
+
+QImage decode(const QByteArray& data)
+{
+    if (!isQoi(data) ||
+        data.size() < HEADER_SIZE + qsizetype(sizeof(PADDING))) {
+        return {};
+    }
+
+    const auto* p = reinterpret_cast<const uchar*>(data.constData());
+    const quint32 width = readBigEndian(p + 4);
+    const quint32 height = readBigEndian(p + 8);
+    const int channels = p[12];
+    if (width == 0 || height == 0 || (channels != 3 && channels != 4) ||
+        p[13] > 1 || qint64(width) * height > MAX_PIXELS) {
+        return {};
+    }
+
+    QImage image(int(width),
+                 int(height),
+                 channels == 4 ? QImage::Format_ARGB32 : QImage::Format_RGB32);
+    if (image.isNull()) {
+        return {};
+    }
+
+    const uchar* end = p + data.size() - sizeof(PADDING);
+    p += HEADER_SIZE;
+
+    std::array<QRgb, 64> index{};
+    QRgb px = qRgba(0, 0, 0, 255);
+    int run = 0;
+    for (int y = 0; y < image.height(); ++y) {
+        auto* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < image.width(); ++x) {
+            if (run > 0) {
+                --run;
+                line[x] = px;
+                continue;
+            }
+            if (p >= end) {
+                // Truncated data
+                return {};
+            }
+
+            const uchar b1 = *p++;
+            if (b1 == OP_RGB) {
+                if (end - p < 3) {
+                    return {};
+                }
+                px = qRgba(p[0], p[1], p[2], qAlpha(px));
+                p += 3;
+            } else if (b1 == OP_RGBA) {
+                if (end - p < 4) {
+                    return {};
+                }
+                px = qRgba(p[0], p[1], p[2], p[3]);
+                p += 4;
+            } else {
+                switch (b1 & OP_MASK) {
+                    case OP_INDEX:
+                        px = index[b1];
+                        break;
+                    case OP_DIFF:
+                        px = qRgba(qRed(px) + ((b1 >> 4) & 3) - 2,
+                                   qGreen(px) + ((b1 >> 2) & 3) - 2,
+                                   qBlue(px) + (b1 & 3) - 2,
+                                   qAlpha(px));
+                        break;
+                    case OP_LUMA: {
+                        if (p >= end) {
+                            return {};
+                        }
+                        const uchar b2 = *p++;
+                        const int dg = (b1 & 0x3f) - 32;
+                        px = qRgba(qRed(px) + dg - 8 + ((b2 >> 4) & 0x0f),
+                                   qGreen(px) + dg,
+                                   qBlue(px) + dg - 8 + (b2 & 0x0f),
+                                   qAlpha(px));
+                        break;
+                    }
+                    default: // OP_RUN
+                        run = b1 & 0x3f;
+                        break;
+                }
+            }
+            index[hash(px)] = px;
+            line[x] = px;
+        }
+    }
+    return image;
+}
+
+} // namespace Qoi
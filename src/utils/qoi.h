@@ -0,0 +1,24 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QByteArray>
+#include <QImage>
+
+// "Quite OK Image" format (https://qoiformat.org), lossless like PNG but with
+// an encoder an order of magnitude faster. Used where the image never leaves
+// this machine: the transport between instances and the history cache.
+namespace Qoi {
+
+// The format can't describe images larger than this
+const qint64 MAX_PIXELS = 400000000;
+
+bool isQoi(const QByteArray& data);
+// Empty if the image is null or too large
+QByteArray encode(const QImage& image);
+// ARGB32 image, or RGB32 if the data has no alpha channel. Null if the data
+// isn't valid QOI.
+QImage decode(const QByteArray& data);
+
+} // namespace Qoi
@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "qoihandler.h"
+#include "src/utils/qoi.h"
+#include <QIODevice>
+#include <QImage>
+
+bool QoiHandler::canRead() const
+{
+    if (canRead(device())) {
+        setFormat("qoi");
+        return true;
+    }
+    return false;
+}
+
+bool QoiHandler::read(QImage* image)
+{
+    QImage decoded = Qoi::decode(device()->readAll());
+    if (decoded.isNull()) {
+        return false;
+    }
+    *image = decoded;
+    return true;
+}
+
+bool QoiHandler::write(const QImage& image)
+{
+    const QByteArray data = Qoi::encode(image);
+    return !data.isEmpty() && device()->write(data) == data.size();
+}
+
+bool QoiHandler::canRead(QIODevice* device)
+{
+    return device != nullptr && Qoi::isQoi(device->peek(4));
+}
+
+QImageIOPlugin::Capabilities QoiPlugin::capabilities(
+  QIODevice* device,
+  const QByteArray& format) const
+{
+    if (format == "qoi") {
+        return { CanRead | CanWrite };
+    }
+    if (!format.isEmpty() || device == nullptr || !device->isOpen()) {
+        return {};
+    }
+
+    Capabilities capabilities;
+    if (device->isReadable() && QoiHandler::canRead(device)) {
+        capabilities |= CanRead;
+    }
+    if (device->isWritable()) {
+        capabilities |= CanWrite;
+    }
+    return capabilities;
+}
+
+QImageIOHandler* QoiPlugin::create(QIODevice* device,
+                                   const QByteArray& format) const
+{
+    auto* handler = new QoiHandler();
+    handler->setDevice(device);
+    handler->setFormat(format);
+    return handler;
+}
@@ -0,0 +1,33 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QImageIOHandler>
+#include <QImageIOPlugin>
+
+// Reads and writes QOI through QImageReader and QImageWriter, which also
+// makes "qoi" one of the formats captures can be saved as
+class QoiHandler : public QImageIOHandler
+{
+public:
+    bool canRead() const override;
+    bool read(QImage* image) override;
+    bool write(const QImage& image) override;
+
+    static bool canRead(QIODevice* device);
+};
+
+// Compiled into the executable, imported in main.cpp
+class QoiPlugin : public QImageIOPlugin
+{
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID QImageIOHandlerFactoryInterface_iid FILE "qoi.json")
+
+public:
+    Capabilities capabilities(QIODevice* device,
+                              const QByteArray& format) const override;
+    QImageIOHandler* create(
+      QIODevice* device,
+      const QByteArray& format = QByteArray()) const override;
+};
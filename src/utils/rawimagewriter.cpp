@@ -0,0 +1,164 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "rawimagewriter.h"
+#include "src/utils/paletteimage.h"
+#include <QIODevice>
+#include <QtEndian>
+
+namespace {
+
+// Rows of the captures are already QRgb, other formats are converted once
+QImage toRgb32(const QImage& image)
+{
+    if (image.format() == QImage::Format_ARGB32 ||
+        image.format() == QImage::Format_RGB32) {
+        return image;
+    }
+    return image.convertToFormat(QImage::Format_ARGB32);
+}
+
+// Converts the image one row at a time into a buffer of a single row, which
+// is written before the next one is converted
+template<typename ConvertPixel>
+bool writeRows(QIODevice* output,
+               const QImage& image,
+               int bytesPerPixel,
+               ConvertPixel convert)
+{
+    QByteArray row(qsizetype(image.width()) * bytesPerPixel, Qt::Uninitialized);
+    auto* out = reinterpret_cast<uchar*>(row.data());
+    for (int y = 0; y < image.height(); ++y) {
+        const auto* in = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+        for (int x = 0; x < image.width(); ++x) {
+            convert(in[x], out + x * bytesPerPixel);
+        }
+        if (output->write(row) != row.size()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool writeHeader(QIODevice* output, const QByteArray& header)
+{
+    return output->write(header) == header.size();
+}
+
+bool writePpm(QIODevice* output, const QImage& image)
+{
+    const QByteArray header = QStringLiteral("P6\n%1 %2\n255\n")
+                                .arg(image.width())
+                                .arg(image.height())
+                                .toLatin1();
+    return writeHeader(output, header) &&
+           writeRows(output, image, 3, [](QRgb px, uchar* out) {
+               out[0] = qRed(px);
+               out[1] = qGreen(px);
+               out[2] = qBlue(px);
+           });
+}
+
+bool writePam(QIODevice* output, const QImage& image)
+{
+    const QByteArray header =
+      QStringLiteral("P7\nWIDTH %1\nHEIGHT %2\nDEPTH 4\nMAXVAL 255\n"
+                     "TUPLTYPE RGB_ALPHA\nENDHDR\n")
+        .arg(image.width())
+        .arg(image.height())
+        .toLatin1();
+    return writeHeader(output, header) &&
+           writeRows(output, image, 4, [](QRgb px, uchar* out) {
+               out[0] = qRed(px);
+               out[1] = qGreen(px);
+               out[2] = qBlue(px);
+               out[3] = qAlpha(px);
+           });
+}
+
+bool writeFarbfeld(QIODevice* output, const QImage& image)
+{
+    QByteArray header("farbfeld", 8);
+    header.resize(16);
+    qToBigEndian<quint32>(image.width(), header.data() + 8);
+    qToBigEndian<quint32>(image.height(), header.data() + 12);
+    // 16 bit channels, v * 257 spreads 0-255 over 0-65535
+    return writeHeader(output, header) &&
+           writeRows(output, image, 8, [](QRgb px, uchar* out) {
+               out[0] = out[1] = qRed(px);
+               out[2] = out[3] = qGreen(px);
+               out[4] = out[5] = qBlue(px);
+               out[6] = out[7] = qAlpha(px);
+           });
+}
+
+bool writeBgra(QIODevice* output, const QImage& image)
+{
+    QByteArray header("BGRA", 4);
+    header.resize(12);
+    qToLittleEndian<quint32>(image.width(), header.data() + 4);
+    qToLittleEndian<quint32>(image.height(), header.data() + 8);
+    if (!writeHeader(output, header)) {
+        return false;
+    }
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    // A QRgb in memory is already B, G, R, A, and 32 bit rows have no padding
+    const qint64 size = image.sizeInBytes();
+    return output->write(reinterpret_cast<const char*>(image.constBits()),
+                         size) == size;
+#else
+    return writeRows(output, image, 4, [](QRgb px, uchar* out) {
+        out[0] = qBlue(px);
+        out[1] = qGreen(px);
+        out[2] = qRed(px);
+        out[3] = qAlpha(px);
+    });
+#endif
+}
+
+} // unnamed namespace
+
+namespace RawImageWriter {
+
+QStringList formatNames()
+{
+    return { QStringLiteral("png"),
+             QStringLiteral("ppm"),
+             QStringLiteral("pam"),
+             QStringLiteral("farbfeld"),
+             QStringLiteral("bgra") };
+}
+
+bool parseFormat(const QString& name, Format& format)
+{
+    int index = formatNames().indexOf(name.toLower());
+    if (index < 0) {
+        return false;
+    }
+    format = static_cast<Format>(index);
+    return true;
+}
+
+bool write(QIODevice* output, const QImage& image, Format format)
+{
+    if (output == nullptr || !output->isOpen() || image.isNull()) {
+        return false;
+    }
+    switch (format) {
+        case PNG:
+            // Written to the device directly, libpng hands each IDAT chunk
+            // over as soon as it is compressed
+            return PaletteImage::forPng(image).save(output, "PNG");
+        case PPM:
+            return writePpm(output, toRgb32(image));
+        case PAM:
+            return writePam(output, toRgb32(image));
+        case FARBFELD:
+            return writeFarbfeld(output, toRgb32(image));
+        case BGRA:
+            return writeBgra(output, toRgb32(image));
+    }
+    return false;
+}
+
+} // namespace RawImageWriter
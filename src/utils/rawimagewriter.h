@@ -0,0 +1,34 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QImage>
+#include <QStringList>
+
+class QIODevice;
+
+// Writes the capture printed with `--raw` straight to the output, one row at a
+// time, so no encoded copy of the whole capture is kept in memory.
+namespace RawImageWriter {
+
+enum Format
+{
+    PNG,
+    // Binary netpbm formats, RGB for PPM and RGB_ALPHA for PAM
+    PPM,
+    PAM,
+    // https://tools.suckless.org/farbfeld/
+    FARBFELD,
+    // "BGRA", the width and height as little endian 32 bit integers, then the
+    // rows without padding
+    BGRA,
+};
+
+// Names accepted by `--raw-format`, in the order of Format
+QStringList formatNames();
+// false if the name isn't one of formatNames()
+bool parseFormat(const QString& name, Format& format);
+bool write(QIODevice* output, const QImage& image, Format format);
+
+} // namespace RawImageWriter
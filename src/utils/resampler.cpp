@@ -0,0 +1,292 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "resampler.h"
+#include <QSemaphore>
+#include <QThreadPool>
+#include <QVector>
+#include <QtMath>
+#include <atomic>
+#include <cmath>
+
+namespace {
+
+// Output rows resampled by a task. The source rows of a band are filtered
+// horizontally into a buffer of the band, so it has to stay small.
+const int BAND_HEIGHT = 32;
+
+double sinc(double x)
+{
+    if (x == 0.0) {
+        return 1.0;
+    }
+    x *= M_PI; // from QtMath, also on MSVC
+    return std::sin(x) / x;
+}
+
+double lanczos3(double x)
+{
+    x = std::abs(x);
+    return x < 3.0 ? sinc(x) * sinc(x / 3.0) : 0.0;
+}
+
+// Mitchell-Netravali with B = C = 1/3
+double mitchell(double x)
+{
+    const double b = 1.0 / 3.0;
+    const double c = 1.0 / 3.0;
+    x = std::abs(x);
+    if (x < 1.0) {
+        return ((12 - 9 * b - 6 * c) * x * x * x +
+                (-18 + 12 * b + 6 * c) * x * x + (6 - 2 * b)) /
+               6.0;
+    }
+    if (x < 2.0) {
+        return ((-b - 6 * c) * x * x * x + (6 * b + 30 * c) * x * x +
+                (-12 * b - 48 * c) * x + (8 * b + 24 * c)) /
+               6.0;
+    }
+    return 0.0;
+}
+
+/**
+ * @brief Weights of the source pixels making each destination pixel, along
+ * one axis.
+ *
+ * Every destination pixel has the same number of taps, starting at `first`.
+ * Windows reaching past the edges are shifted inside and the edge pixels
+ * repeated, so the passes never check bounds.
+ */
+struct Coefficients
+{
+    int taps = 0;
+    QVector<int> first;
+    QVector<float> weights;
+
+    Coefficients(int srcSize, int dstSize, Resampler::Filter filter)
+    {
+        const bool lanczos = filter == Resampler::LANCZOS3;
+        const double radius = lanczos ? 3.0 : 2.0;
+        const double scale = double(dstSize) / srcSize;
+        // Widen the filter when downscaling so it covers the skipped pixels
+        const double filterScale = qMax(1.0, 1.0 / scale);
+        const double support = radius * filterScale;
+
+        taps = qMin(srcSize, 2 * int(std::ceil(support)) + 1);
+        first.resize(dstSize);
+        weights.fill(0.0F, dstSize * taps);
+
+        QVector<double> w(taps);
+        for (int i = 0; i < dstSize; ++i) {
+            const double center = (i + 0.5) / scale;
+            const int left = int(std::ceil(center - 0.5 - support));
+            const int right = int(std::floor(center - 0.5 + support));
+            const int start = qBound(0, left, srcSize - taps);
+            first[i] = start;
+
+            w.fill(0.0);
+            double sum = 0.0;
+            for (int j = left; j <= right; ++j) {
+                const double x = (j + 0.5 - center) / filterScale;
+                const double weight = lanczos ? lanczos3(x) : mitchell(x);
+                w[qBound(0, j, srcSize - 1) - start] += weight;
+                sum += weight;
+            }
+            for (int k = 0; k < taps; ++k) {
+                weights[i * taps + k] = float(w[k] / sum);
+            }
+        }
+    }
+};
+
+// Premultiplied row as four floats per pixel, in memory order
+void unpackRow(const quint32* in, float* out, int width)
+{
+    for (int x = 0; x < width; ++x) {
+        const quint32 px = in[x];
+        out[4 * x] = float(px & 0xff);
+        out[4 * x + 1] = float((px >> 8) & 0xff);
+        out[4 * x + 2] = float((px >> 16) & 0xff);
+        out[4 * x + 3] = float(px >> 24);
+    }
+}
+
+// Filtering rings past the valid range, clamp to it and keep the colors
+// premultiplied
+void packRow(const float* in, quint32* out, int width, bool opaque)
+{
+    for (int x = 0; x < width; ++x) {
+        const int a =
+          opaque ? 255 : qBound(0, int(std::lround(in[4 * x + 3])), 255);
+        const int c0 = qBound(0, int(std::lround(in[4 * x])), a);
+        const int c1 = qBound(0, int(std::lround(in[4 * x + 1])), a);
+        const int c2 = qBound(0, int(std::lround(in[4 * x + 2])), a);
+        out[x] = quint32(c0) | quint32(c1) << 8 | quint32(c2) << 16 |
+                 quint32(a) << 24;
+    }
+}
+
+class Job
+{
+public:
+    Job(const QImage& src, QImage& dst, Resampler::Filter filter)
+      : m_src(src)
+      , m_dstBits(dst.bits())
+      , m_dstBytesPerLine(dst.bytesPerLine())
+      , m_dstWidth(dst.width())
+      , m_dstHeight(dst.height())
+      , m_horizontal(src.width(), dst.width(), filter)
+      , m_vertical(src.height(), dst.height(), filter)
+      , m_opaque(!src.hasAlphaChannel())
+      , m_bandCount((dst.height() + BAND_HEIGHT - 1) / BAND_HEIGHT)
+    {}
+
+    int bandCount() const { return m_bandCount; }
+
+    // Resample bands until none is left, run by every participating thread
+    void work()
+    {
+        QVector<float> srcRow(m_src.width() * 4);
+        QVector<float> band;
+        QVector<float> dstRow(m_dstWidth * 4);
+        for (int b = m_nextBand++; b < m_bandCount; b = m_nextBand++) {
+            resampleBand(b, srcRow, band, dstRow);
+        }
+    }
+
+private:
+    void resampleBand(int b,
+                      QVector<float>& srcRow,
+                      QVector<float>& band,
+                      QVector<float>& dstRow)
+    {
+        const int y0 = b * BAND_HEIGHT;
+        const int y1 = qMin(y0 + BAND_HEIGHT, m_dstHeight);
+        const int firstRow = m_vertical.first[y0];
+        const int rowCount = m_vertical.first[y1 - 1] + m_vertical.taps -
+                             firstRow;
+        const int dstWidth = m_dstWidth;
+        const int hTaps = m_horizontal.taps;
+        const int vTaps = m_vertical.taps;
+        band.resize(rowCount * dstWidth * 4);
+
+        // Horizontal pass over the source rows of the band
+        for (int r = 0; r < rowCount; ++r) {
+            const auto* row = reinterpret_cast<const quint32*>(
+              m_src.constScanLine(firstRow + r));
+            unpackRow(row, srcRow.data(), m_src.width());
+            float* out = band.data() + r * dstWidth * 4;
+            for (int x = 0; x < dstWidth; ++x) {
+                const float* in =
+                  srcRow.constData() + m_horizontal.first[x] * 4;
+                const float* w = m_horizontal.weights.constData() + x * hTaps;
+                // Four independent sums, vectorized by the compiler
+                float acc[4] = { 0, 0, 0, 0 };
+                for (int k = 0; k < hTaps; ++k) {
+                    for (int c = 0; c < 4; ++c) {
+                        acc[c] += w[k] * in[4 * k + c];
+                    }
+                }
+                for (int c = 0; c < 4; ++c) {
+                    out[4 * x + c] = acc[c];
+                }
+            }
+        }
+
+        // Vertical pass, each tap adds a whole row so the inner loop runs
+        // over contiguous floats
+        const int rowLength = dstWidth * 4;
+        for (int y = y0; y < y1; ++y) {
+            const float* w = m_vertical.weights.constData() + y * vTaps;
+            const float* in =
+              band.constData() + (m_vertical.first[y] - firstRow) * rowLength;
+            float* out = dstRow.data();
+            for (int i = 0; i < rowLength; ++i) {
+                out[i] = w[0] * in[i];
+            }
+            for (int k = 1; k < vTaps; ++k) {
+                const float* row = in + k * rowLength;
+                const float weight = w[k];
+                for (int i = 0; i < rowLength; ++i) {
+                    out[i] += weight * row[i];
+                }
+            }
+            packRow(out,
+                    reinterpret_cast<quint32*>(m_dstBits +
+                                               y * m_dstBytesPerLine),
+                    dstWidth,
+                    m_opaque);
+        }
+    }
+
+    const QImage& m_src;
+    // Rows are written by several threads, QImage::scanLine() would detach
+    uchar* m_dstBits;
+    qsizetype m_dstBytesPerLine;
+    int m_dstWidth;
+    int m_dstHeight;
+    Coefficients m_horizontal;
+    Coefficients m_vertical;
+    bool m_opaque;
+    int m_bandCount;
+    std::atomic<int> m_nextBand{ 0 };
+};
+
+} // unnamed namespace
+
+namespace Resampler {
+
+QImage resize(const QImage& image, const QSize& size)
+{
+    const bool downscale =
+      size.width() <= image.width() && size.height() <= image.height();
+    return resize(image, size, downscale ? LANCZOS3 : MITCHELL);
+}
+
+QImage resize(const QImage& image, const QSize& size, Filter filter)
+{
+    if (image.isNull() || size.isEmpty()) {
+        return {};
+    }
+
+    // Both are premultiplied QRgb rows as they are, as the alpha of RGB32 is
+    // always 255
+    QImage src = image;
+    if (src.format() != QImage::Format_RGB32 &&
+        src.format() != QImage::Format_ARGB32_Premultiplied) {
+        src = src.convertToFormat(src.hasAlphaChannel()
+                                    ? QImage::Format_ARGB32_Premultiplied
+                                    : QImage::Format_RGB32);
+    }
+    QImage dst(size,
+               src.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied
+                                     : QImage::Format_RGB32);
+    if (dst.isNull()) {
+        return {};
+    }
+
+    Job job(src, dst, filter);
+
+    // Helpers are only started on idle threads of the pool, and the calling
+    // thread works too. Waiting can't deadlock, even when called from a task
+    // of the same pool.
+    QThreadPool* pool = QThreadPool::globalInstance();
+    QSemaphore finished;
+    int helpers = 0;
+    const int wanted = qMin(pool->maxThreadCount(), job.bandCount()) - 1;
+    for (int i = 0; i < wanted; ++i) {
+        const bool started = pool->tryStart([&job, &finished]() {
+            job.work();
+            finished.release();
+        });
+        if (!started) {
+            break;
+        }
+        ++helpers;
+    }
+    job.work();
+    finished.acquire(helpers);
+    return dst;
+}
+
+} // namespace Resampler
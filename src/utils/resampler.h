@@ -0,0 +1,27 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QImage>
+#include <QSize>
+
+// Separable resampling with a windowed filter, much sharper on text than
+// Qt::SmoothTransformation. Large images are split into bands of rows that
+// are resampled in parallel on the global thread pool.
+namespace Resampler {
+
+enum Filter
+{
+    // Sharpest, used when downscaling
+    LANCZOS3,
+    // Doesn't ring around hard edges, used when upscaling
+    MITCHELL,
+};
+
+// The filter is picked from the direction of the scaling. The result is
+// premultiplied, or RGB32 if the image has no alpha channel.
+QImage resize(const QImage& image, const QSize& size);
+QImage resize(const QImage& image, const QSize& size, Filter filter);
+
+} // namespace Resampler
@@ -3,19 +3,19 @@
 
 #include "screengrabber.h"
 #include "abstractlogger.h"
+#include "src/core/metrics.h"
 #include "src/core/qguiappcurrentscreen.h"
+#include "src/utils/bufferpool.h"
 #include "src/utils/confighandler.h"
 #include "src/utils/filenamehandler.h"
+#include "src/utils/monitortopology.h"
 #include "src/utils/systemnotification.h"
 #include <QApplication>
 #include <QGuiApplication>
-#include <QJsonArray>
-#include <QJsonDocument>
-#include <QJsonObject>
+#include <QImageReader>
 #include <QPixmap>
 #include <QProcess>
 #include <QScreen>
-#include <cmath>
 
 #if !(defined(Q_OS_MACOS) || defined(Q_OS_WIN))
 #include "request.h"
@@ -26,6 +26,27 @@
 #include <QUuid>
 #endif
 
+#if defined(USE_WLR_SCREENCOPY)
+#include "src/utils/wlrscreencopy.h"
+#endif
+
+namespace {
+
+// Decodes a capture written by grim or the portal into a pooled buffer, the
+// image handlers reuse the buffer when its size and format match
+QPixmap readPooled(const QString& path, const char* format = nullptr)
+{
+    QImageReader reader(path, format);
+    QImage image =
+      BufferPool::instance()->image(reader.size(), reader.imageFormat());
+    if (!reader.read(&image)) {
+        return QPixmap();
+    }
+    return QPixmap::fromImage(std::move(image));
+}
+
+} // unnamed namespace
+
 ScreenGrabber::ScreenGrabber(QObject* parent)
   : QObject(parent)
 {}
@@ -47,7 +68,7 @@ void ScreenGrabber::generalGrimScreenshot(bool& ok, QPixmap& res)
               << "ppm" << imgPath;
     Process.start(program, arguments);
     if (Process.waitForFinished()) {
-        res.load(imgPath, "ppm");
+        res = readPooled(imgPath, "ppm");
         QFile imgFile(imgPath);
         imgFile.remove();
         adjustDevicePixelRatio(res);
@@ -59,6 +80,37 @@ void ScreenGrabber::generalGrimScreenshot(bool& ok, QPixmap& res)
                 "the screen capture component of wayland. If the screen "
                 "capture component is missing, please install it!");
     }
+    Metrics::grabbed(Metrics::GRIM, ok);
+#endif
+}
+
+void ScreenGrabber::wlrScreencopyScreenshot(bool& ok,
+                                            QPixmap& res,
+                                            const QRect& region)
+{
+#if defined(USE_WLR_SCREENCOPY)
+    WlrScreencopy* screencopy = WlrScreencopy::instance();
+    if (!screencopy->isAvailable()) {
+        ok = false;
+        return;
+    }
+    QImage image = region.isNull() ? screencopy->grabDesktop(ok)
+                                   : screencopy->grabRegion(region, ok);
+    Metrics::grabbed(Metrics::WLR_SCREENCOPY, ok);
+    if (!ok) {
+        return;
+    }
+    res = QPixmap::fromImage(std::move(image));
+    if (region.isNull()) {
+        adjustDevicePixelRatio(res);
+    } else {
+        res.setDevicePixelRatio(static_cast<qreal>(res.width()) /
+                                region.width());
+    }
+#else
+    Q_UNUSED(region);
+    ok = false;
+    res = QPixmap();
 #endif
 }
 
@@ -71,6 +123,7 @@ void ScreenGrabber::freeDesktopPortal(bool& ok, QPixmap& res)
 
     if (!connectionInterface->isServiceRegistered(service)) {
         ok = false;
+        Metrics::grabbed(Metrics::PORTAL, ok);
         AbstractLogger::error() << tr(
           "Could not locate the `org.freedesktop.portal.Desktop` service");
         return;
@@ -102,7 +155,7 @@ void ScreenGrabber::freeDesktopPortal(bool& ok, QPixmap& res)
             // Parse this as URI to handle unicode properly
             QUrl uri = map.value("uri").toString();
             QString uriString = uri.toLocalFile();
-            res = QPixmap(uriString);
+            res = readPooled(uriString);
             adjustDevicePixelRatio(res);
             QFile imgFile(uriString);
             imgFile.remove();
@@ -128,6 +181,7 @@ void ScreenGrabber::freeDesktopPortal(bool& ok, QPixmap& res)
     if (res.isNull()) {
         ok = false;
     }
+    Metrics::grabbed(Metrics::PORTAL, ok);
 #endif
 }
 
@@ -145,6 +199,7 @@ QPixmap ScreenGrabber::grabEntireDesktop(bool& ok)
                                 currentScreen->geometry().width(),
                                 currentScreen->geometry().height()));
     screenPixmap.setDevicePixelRatio(currentScreen->devicePixelRatio());
+    Metrics::grabbed(Metrics::QT, !screenPixmap.isNull());
     return screenPixmap;
 #elif defined(Q_OS_LINUX) || defined(Q_OS_UNIX)
     if (m_info.waylandDetected()) {
@@ -160,6 +215,15 @@ QPixmap ScreenGrabber::grabEntireDesktop(bool& ok)
             case DesktopInfo::WLROOTS:
             case DesktopInfo::HYPRLAND:
             case DesktopInfo::OTHER: {
+#if defined(USE_WLR_SCREENCOPY)
+                wlrScreencopyScreenshot(ok, res);
+                if (ok) {
+                    break;
+                }
+                // The compositor does not support wlr-screencopy, fall back
+                // to grim or the portal
+                ok = true;
+#endif
                 if (!ConfigHandler().useGrimAdapter()) {
                     if (!ConfigHandler().disabledGrimWarning()) {
                         AbstractLogger::warning() << tr(
@@ -205,16 +269,19 @@ QPixmap ScreenGrabber::grabEntireDesktop(bool& ok)
     // multi-monitor setups where screens have different positions/heights.
     // This fixes the dual monitor offset bug and handles edge cases where
     // the desktop bounding box includes virtual space.
+    // grabWindow() allocates the pixmap in the platform plugin, a black
+    // pixmap filled beforehand would only be replaced. For the same reason
+    // the Qt grabs stay out of BufferPool, moving them in would cost one more
+    // copy of the whole desktop.
     QScreen* primaryScreen = QGuiApplication::primaryScreen();
     QRect r = primaryScreen->geometry();
-    QPixmap desktop(geometry.size());
-    desktop.fill(Qt::black); // Fill with black background
-    desktop =
+    QPixmap desktop =
       primaryScreen->grabWindow(wid,
                                 -r.x() / primaryScreen->devicePixelRatio(),
                                 -r.y() / primaryScreen->devicePixelRatio(),
                                 geometry.width(),
                                 geometry.height());
+    Metrics::grabbed(Metrics::QT, !desktop.isNull());
     return desktop;
 #endif
 }
@@ -247,137 +314,77 @@ QPixmap ScreenGrabber::grabScreen(QScreen* screen, bool& ok)
     QPixmap p;
     QRect geometry = screenGeometry(screen);
     if (m_info.waylandDetected()) {
+#if defined(USE_WLR_SCREENCOPY)
+        // Only capture the requested screen instead of cropping the desktop
+        if (m_info.windowManager() != DesktopInfo::GNOME &&
+            m_info.windowManager() != DesktopInfo::KDE &&
+            m_info.windowManager() != DesktopInfo::COSMIC) {
+            wlrScreencopyScreenshot(ok, p, screen->geometry());
+            if (ok) {
+                return p;
+            }
+        }
+#endif
         p = grabEntireDesktop(ok);
         if (ok) {
             return p.copy(geometry);
         }
     } else {
         ok = true;
-        return screen->grabWindow(
+        p = screen->grabWindow(
           0, geometry.x(), geometry.y(), geometry.width(), geometry.height());
+        Metrics::grabbed(Metrics::QT, !p.isNull());
     }
     return p;
 }
 
-QRect ScreenGrabber::desktopGeometry()
+/**
+ * @brief Grab a region of the desktop, in logical coordinates, without
+ * grabbing the whole desktop. Used for repeated grabs, so it fails rather
+ * than falling back to the slow desktop portal.
+ */
+QPixmap ScreenGrabber::grabRegion(const QRect& region, bool& ok)
 {
-    QRect hyprPhysical;
-    QRect hyprLogical;
-    if (hyprlandDesktopGeometries(hyprPhysical, hyprLogical)) {
-        return hyprPhysical;
+    QPixmap p;
+    if (m_info.waylandDetected()) {
+        ok = false;
+#if defined(USE_WLR_SCREENCOPY)
+        if (m_info.windowManager() != DesktopInfo::GNOME &&
+            m_info.windowManager() != DesktopInfo::KDE &&
+            m_info.windowManager() != DesktopInfo::COSMIC) {
+            wlrScreencopyScreenshot(ok, p, region);
+        }
+#endif
+        return p;
     }
 
-    QRect geometry;
-
-    for (QScreen* const screen : QGuiApplication::screens()) {
-        QRect scrRect = screen->geometry();
-        geometry = geometry.united(scrRect);
+    QScreen* screen = QGuiApplication::screenAt(region.center());
+    if (screen == nullptr) {
+        screen = QGuiApplication::primaryScreen();
     }
-    return geometry;
+    p = screen->grabWindow(
+      0, region.x(), region.y(), region.width(), region.height());
+    ok = !p.isNull();
+    Metrics::grabbed(Metrics::QT, ok);
+    return p;
 }
 
-QRect ScreenGrabber::logicalDesktopGeometry()
+QRect ScreenGrabber::desktopGeometry()
 {
-    QRect hyprPhysical;
-    QRect hyprLogical;
-    if (hyprlandDesktopGeometries(hyprPhysical, hyprLogical)) {
-        return hyprLogical;
-    }
-
-    QRectF geometry;
-    for (QScreen* const screen : QGuiApplication::screens()) {
-        const QRect screenRect = screen->geometry();
-        const qreal dpr = screen->devicePixelRatio();
-        const QPointF logicalTopLeft(
-          static_cast<qreal>(screenRect.x()) / dpr,
-          static_cast<qreal>(screenRect.y()) / dpr);
-        const QSizeF logicalSize(
-          static_cast<qreal>(screenRect.width()) / dpr,
-          static_cast<qreal>(screenRect.height()) / dpr);
-        geometry = geometry.united(QRectF(logicalTopLeft, logicalSize));
-    }
-    return geometry.toAlignedRect();
+    return MonitorTopology::instance()->desktopGeometry();
 }
 
-bool ScreenGrabber::hyprlandDesktopGeometries(QRect& physical, QRect& logical)
+QRect ScreenGrabber::logicalDesktopGeometry()
 {
-#if defined(Q_OS_LINUX) || defined(Q_OS_UNIX)
-    if (!(m_info.waylandDetected() &&
-          m_info.windowManager() == DesktopInfo::HYPRLAND)) {
-        return false;
-    }
-
-    QProcess process;
-    process.start(QStringLiteral("hyprctl"),
-                  { QStringLiteral("monitors"), QStringLiteral("-j") });
-    if (!process.waitForFinished(1000)) {
-        AbstractLogger::warning()
-          << QObject::tr("Unable to query Hyprland monitors via hyprctl.");
-        return false;
-    }
-
-    const QByteArray output = process.readAllStandardOutput();
-    QJsonParseError parseError;
-    const QJsonDocument doc =
-      QJsonDocument::fromJson(output, &parseError);
-    if (parseError.error != QJsonParseError::NoError || !doc.isArray()) {
-        AbstractLogger::warning()
-          << QObject::tr("Failed to parse hyprctl monitor output: %1")
-               .arg(parseError.errorString());
-        return false;
-    }
-
-    const auto toInt = [](double value) {
-        return static_cast<int>(std::llround(value));
-    };
-
-    QRect physicalUnion;
-    QRect logicalUnion;
-    bool gotMonitor = false;
-
-    for (const QJsonValueConstRef& value : doc.array()) {
-        if (!value.isObject()) {
-            continue;
-        }
-        const QJsonObject obj = value.toObject();
-        const double width = obj.value(QStringLiteral("width")).toDouble();
-        const double height = obj.value(QStringLiteral("height")).toDouble();
-        const double x = obj.value(QStringLiteral("x")).toDouble();
-        const double y = obj.value(QStringLiteral("y")).toDouble();
-        const double scale = obj.value(QStringLiteral("scale")).toDouble(1.0);
-        if (width <= 0 || height <= 0 || scale <= 0.0) {
-            continue;
-        }
-
-        const QRect physicalRect(toInt(x),
-                                 toInt(y),
-                                 toInt(width),
-                                 toInt(height));
-        const QRect logicalRect(toInt(x / scale),
-                                toInt(y / scale),
-                                toInt(width / scale),
-                                toInt(height / scale));
-        physicalUnion = physicalUnion.united(physicalRect);
-        logicalUnion = logicalUnion.united(logicalRect);
-        gotMonitor = true;
-    }
-
-    if (gotMonitor) {
-        physical = physicalUnion;
-        logical = logicalUnion;
-    }
-    return gotMonitor;
-#else
-    Q_UNUSED(physical);
-    Q_UNUSED(logical);
-    return false;
-#endif
+    return MonitorTopology::instance()->logicalDesktopGeometry();
 }
 
 void ScreenGrabber::adjustDevicePixelRatio(QPixmap& pixmap)
 {
-    QRect physicalGeo = desktopGeometry();
-    QRect logicalGeo = logicalDesktopGeometry();
+    const MonitorTopology::Snapshot& topology =
+      MonitorTopology::instance()->snapshot();
+    const QRect& physicalGeo = topology.physical;
+    const QRect& logicalGeo = topology.logical;
     if (pixmap.size() == physicalGeo.size()) {
         // Pixmap is physical size and Qt's DPR is correct
         pixmap.setDevicePixelRatio(qApp->devicePixelRatio());
@@ -15,13 +15,16 @@ public:
     QPixmap grabEntireDesktop(bool& ok);
     QRect screenGeometry(QScreen* screen);
     QPixmap grabScreen(QScreen* screenNumber, bool& ok);
+    QPixmap grabRegion(const QRect& region, bool& ok);
     void freeDesktopPortal(bool& ok, QPixmap& res);
     void generalGrimScreenshot(bool& ok, QPixmap& res);
+    void wlrScreencopyScreenshot(bool& ok,
+                                 QPixmap& res,
+                                 const QRect& region = QRect());
     QRect desktopGeometry();
     QRect logicalDesktopGeometry();
 
 private:
-    bool hyprlandDesktopGeometries(QRect& physical, QRect& logical);
     void adjustDevicePixelRatio(QPixmap& pixmap);
     DesktopInfo m_info;
 };
@@ -5,9 +5,12 @@
 #include "abstractlogger.h"
 #include "src/core/flameshot.h"
 #include "src/core/flameshotdaemon.h"
+#include "src/core/metrics.h"
 #include "src/utils/confighandler.h"
 #include "src/utils/filenamehandler.h"
 #include "src/utils/globalvalues.h"
+#include "src/utils/imageencoder.h"
+#include "src/utils/pixelhash.h"
 #include "utils/desktopinfo.h"
 
 #include <QByteArray>
@@ -29,36 +32,76 @@
 #include <QMessageBox>
 #include <QMimeData>
 #include <QPointer>
+#include <QSemaphore>
 #include <QStandardPaths>
+#include <QThreadPool>
 #include <QTimer>
+#include <atomic>
 #include <qimagewriter.h>
 #include <qmimedatabase.h>
 #if defined(Q_OS_MACOS)
 #include "src/widgets/capture/capturewidget.h"
 #endif
 
+namespace {
+
+QString defaultSaveDirectory()
+{
+    QString path = ConfigHandler().savePath();
+    if (path.isEmpty() || !QDir(path).exists() ||
+        !QFileInfo(path).isWritable()) {
+        path =
+          QStandardPaths::writableLocation(QStandardPaths::PicturesLocation);
+    }
+    return path;
+}
+
+struct RegionFile
+{
+    QImage image;
+    QString path;
+    bool exists = false;
+    bool saved = false;
+};
+
+} // unnamed namespace
+
 bool saveToFilesystem(const QPixmap& capture,
                       const QString& path,
                       const QString& messagePrefix)
 {
+    const QImage image = capture.toImage();
+    // Only hashed when the file name asks for it
+    QString contentHash;
+    if (FileNameHandler::usesContentHash(path)) {
+        contentHash = PixelHash::hash(image).toHex();
+    }
     QString completePath = FileNameHandler().properScreenshotPath(
-      path, ConfigHandler().saveAsFileExtension());
+      path, ConfigHandler().saveAsFileExtension(), contentHash);
+
+    QString saveMessage = messagePrefix;
+    QString notificationPath = completePath;
+    if (!saveMessage.isEmpty()) {
+        saveMessage += " ";
+    }
+
+    // The same pixels were saved before, skip encoding them again
+    if (!contentHash.isEmpty() && QFileInfo::exists(completePath)) {
+        saveMessage += QObject::tr("Capture already saved as ") + completePath;
+        AbstractLogger::info().attachNotificationPath(notificationPath)
+          << saveMessage;
+        return true;
+    }
+
     QFile file{ completePath };
     bool okay = false;
 
     if (file.open(QIODevice::WriteOnly)) {
         QString saveExtension;
         saveExtension = QFileInfo(completePath).suffix().toLower();
-        if (saveExtension == "jpg" || saveExtension == "jpeg") {
-            okay = capture.save(&file, nullptr, ConfigHandler().jpegQuality());
-        } else {
-            okay = capture.save(&file);
-        }
-
-        QString saveMessage = messagePrefix;
-        QString notificationPath = completePath;
-        if (!saveMessage.isEmpty()) {
-            saveMessage += " ";
+        {
+            Metrics::Timer timer(Metrics::WRITE);
+            okay = ImageEncoder::write(&file, image, saveExtension);
         }
 
         if (okay) {
@@ -76,6 +119,9 @@ bool saveToFilesystem(const QPixmap& capture,
               << saveMessage;
         }
     }
+    if (!okay) {
+        Metrics::error(Metrics::SAVE_FAILED);
+    }
     return okay;
 }
 
@@ -86,7 +132,7 @@ QString ShowSaveFileDialog(const QString& title, const QString& directory)
 
     // Build string list of supported image formats
     QStringList mimeTypeList;
-    for (const auto& mimeType : QImageWriter::supportedMimeTypes()) {
+    for (const auto& mimeType : ImageEncoder::supportedMimeTypes()) {
         // image/heif has several aliases and they cause glitch in save dialog
         // It is necessary to keep the image/heif (otherwise HEIF plug-in from
         // kimageformats will not work) but the aliases could be filtered out.
@@ -153,13 +199,7 @@ void saveJpegToClipboardMacOS(const QPixmap& capture)
 
 void saveToClipboardMime(const QPixmap& capture, const QString& imageType)
 {
-    QByteArray array;
-    QBuffer buffer{ &array };
-    QImageWriter imageWriter{ &buffer, imageType.toUpper().toUtf8() };
-    if (imageType == "jpeg") {
-        imageWriter.setQuality(ConfigHandler().jpegQuality());
-    }
-    imageWriter.write(capture.toImage());
+    QByteArray array = ImageEncoder::encode(capture.toImage(), imageType);
 
     QPixmap formattedPixmap;
     bool isLoaded =
@@ -232,8 +272,13 @@ public:
 protected:
     QStringList formats() const override
     {
-        return { QStringLiteral("image/png"),
-                 QStringLiteral("application/x-qt-image") };
+        QStringList formats = { QStringLiteral("image/png"),
+                                QStringLiteral("application/x-qt-image") };
+        // Only encoded if the pasting application asks for them
+        for (const auto& format : ImageEncoder::builtinFormats()) {
+            formats.append("image/" + format);
+        }
+        return formats;
     }
 
     QVariant retrieveData(const QString& mimeType,
@@ -243,11 +288,11 @@ protected:
             notifyOwner();
             return QVariant::fromValue(m_image);
         }
-        if (mimeType == QLatin1String("image/png")) {
-            QByteArray ba;
-            QBuffer buffer(&ba);
-            buffer.open(QIODevice::WriteOnly);
-            m_image.save(&buffer, "PNG");
+        const QString format = mimeType.section('/', 1);
+        if (mimeType == QLatin1String("image/png") ||
+            (mimeType.startsWith(QLatin1String("image/")) &&
+             ImageEncoder::builtinFormats().contains(format))) {
+            QByteArray ba = ImageEncoder::encode(m_image, format);
             notifyOwner();
             return ba;
         }
@@ -299,14 +344,13 @@ bool saveToFilesystemGUI(const QPixmap& capture)
 {
     bool okay = false;
     ConfigHandler config;
-    QString defaultSavePath = ConfigHandler().savePath();
-    if (defaultSavePath.isEmpty() || !QDir(defaultSavePath).exists() ||
-        !QFileInfo(defaultSavePath).isWritable()) {
-        defaultSavePath =
-          QStandardPaths::writableLocation(QStandardPaths::PicturesLocation);
+    QString defaultSavePath = defaultSaveDirectory();
+    QString contentHash;
+    if (FileNameHandler::usesContentHash(defaultSavePath)) {
+        contentHash = PixelHash::hash(capture.toImage()).toHex();
     }
     QString savePath = FileNameHandler().properScreenshotPath(
-      defaultSavePath, ConfigHandler().saveAsFileExtension());
+      defaultSavePath, ConfigHandler().saveAsFileExtension(), contentHash);
 #if defined(Q_OS_MACOS)
     for (QWidget* widget : qApp->topLevelWidgets()) {
         QString className(widget->metaObject()->className());
@@ -329,10 +373,9 @@ bool saveToFilesystemGUI(const QPixmap& capture)
     if (file.open(QIODevice::WriteOnly)) {
         QString saveExtension;
         saveExtension = QFileInfo(savePath).suffix().toLower();
-        if (saveExtension == "jpg" || saveExtension == "jpeg") {
-            okay = capture.save(&file, nullptr, ConfigHandler().jpegQuality());
-        } else {
-            okay = capture.save(&file);
+        {
+            Metrics::Timer timer(Metrics::WRITE);
+            okay = ImageEncoder::write(&file, capture.toImage(), saveExtension);
         }
 
         if (okay) {
@@ -367,6 +410,108 @@ bool saveToFilesystemGUI(const QPixmap& capture)
             saveErrBox.exec();
         }
     }
+    if (!okay) {
+        Metrics::error(Metrics::SAVE_FAILED);
+    }
 
     return okay;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Save several captures of the same grab, like the regions of a
+ * multi-selection. They are encoded and written in parallel on the global
+ * thread pool, and this returns once all are written.
+ * @param path Directory or file name, as for saveToFilesystem. The default
+ * save path is used when it is empty. The captures are numbered through the
+ * `%{index}` token, which is appended to the file name if it has none.
+ * @return Number of captures saved
+ */
+int saveRegionsToFilesystem(const QList<QImage>& captures,
+                            const QString& path)
+{
+    QString directory = path.isEmpty() ? defaultSaveDirectory() : path;
+    QString name;
+    if (QFileInfo(directory).isDir()) {
+        name = FileNameHandler().parsedPattern();
+    } else {
+        QFileInfo info(directory);
+        directory = info.absolutePath();
+        name = info.completeBaseName();
+    }
+    if (!name.contains(FileNameHandler::INDEX_TOKEN)) {
+        name += '_';
+        name += FileNameHandler::INDEX_TOKEN;
+    }
+
+    // File names are picked here, the workers only encode and write
+    FileNameHandler nameHandler;
+    const QString format = ConfigHandler().saveAsFileExtension();
+    const bool hashed = name.contains(FileNameHandler::HASH_TOKEN);
+    QVector<RegionFile> files(captures.size());
+    for (int i = 0; i < captures.size(); ++i) {
+        RegionFile& file = files[i];
+        file.image = captures[i];
+        QString fileName = name;
+        fileName.replace(FileNameHandler::INDEX_TOKEN, QString::number(i + 1));
+        const QString hash =
+          hashed ? PixelHash::hash(file.image).toHex() : QString();
+        file.path = nameHandler.properScreenshotPath(
+          QDir(directory).filePath(fileName), format, hash);
+        file.exists = hashed && QFileInfo::exists(file.path);
+    }
+
+    // The workers can't use ConfigHandler, the settings are read here
+    const ImageEncoder::Options options = ImageEncoder::Options::fromConfig();
+    std::atomic<int> next{ 0 };
+    auto work = [&files, &next, &options]() {
+        for (int i = next++; i < files.size(); i = next++) {
+            RegionFile& region = files[i];
+            if (region.exists) {
+                continue;
+            }
+            Metrics::Timer timer(Metrics::WRITE);
+            QFile file(region.path);
+            region.saved =
+              file.open(QIODevice::WriteOnly) &&
+              ImageEncoder::write(&file,
+                                  region.image,
+                                  QFileInfo(region.path).suffix().toLower(),
+                                  options);
+        }
+    };
+
+    // Same scheme as the resampler: helpers only start on idle threads and
+    // this thread works too
+    QThreadPool* pool = QThreadPool::globalInstance();
+    QSemaphore finished;
+    int helpers = 0;
+    const int wanted = qMin(pool->maxThreadCount(), int(files.size())) - 1;
+    for (int i = 0; i < wanted; ++i) {
+        const bool started = pool->tryStart([&work, &finished]() {
+            work();
+            finished.release();
+        });
+        if (!started) {
+            break;
+        }
+        ++helpers;
+    }
+    work();
+    finished.acquire(helpers);
+
+    int saved = 0;
+    for (const RegionFile& file : files) {
+        if (file.saved || file.exists) {
+            ++saved;
+        } else {
+            Metrics::error(Metrics::SAVE_FAILED);
+            AbstractLogger::error()
+              << QObject::tr("Error trying to save as ") + file.path;
+        }
+    }
+    if (saved > 0) {
+        AbstractLogger::info().attachNotificationPath(directory)
+          << QObject::tr("%1 captures saved in %2").arg(saved).arg(directory);
+    }
+    return saved;
+}
@@ -6,6 +6,7 @@
 #include <QString>
 #include <QWidget>
 
+class QImage;
 class QPixmap;
 
 bool saveToFilesystem(const QPixmap& capture,
@@ -17,3 +18,5 @@ void saveToClipboard(const QPixmap& capture);
 // GNOME Wayland: keeps the widget alive until clipboard data is fetched
 bool saveToClipboardGnomeWorkaround(const QPixmap& pixmap, QWidget* keepAlive);
 bool saveToFilesystemGUI(const QPixmap& capture);
+int saveRegionsToFilesystem(const QList<QImage>& captures,
+                            const QString& path);
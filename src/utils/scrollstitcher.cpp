@@ -0,0 +1,174 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "scrollstitcher.h"
+#include <algorithm>
+#include <array>
+
+namespace {
+// Columns ignored on both sides of a row, where scroll bars usually are
+const int MAX_HASH_MARGIN = 16;
+// Part of the rows that must still be visible after a scroll
+const int MIN_OVERLAP_DIVISOR = 4;
+const int MIN_OVERLAP = 8;
+// Distinct rows that must line up for an offset to be trusted
+const int MIN_DISTINCT_MATCHES = 4;
+const double MATCH_THRESHOLD = 0.9;
+
+const quint64 HASH_PRIME = 0x100000001b3ULL;
+} // unnamed namespace
+
+ScrollStitcher::ScrollStitcher()
+  : m_appendedRows(0)
+{}
+
+ScrollStitcher::Result ScrollStitcher::append(const QImage& source)
+{
+    const QImage frame = source.format() == QImage::Format_RGB32
+                           ? source
+                           : source.convertToFormat(QImage::Format_RGB32);
+    QVector<quint64> hashes = rowHashes(frame);
+    const int rows = frame.height();
+
+    if (m_image.isEmpty() || m_image.width() != frame.width() ||
+        m_lastHashes.size() != rows) {
+        m_image = TiledImage(frame.width(), QImage::Format_RGB32);
+        m_image.appendRows(frame, 0, rows);
+        m_lastHashes = hashes;
+        m_appendedRows = rows;
+        return FIRST_FRAME;
+    }
+
+    // Rows that stayed in place are a sticky header or footer
+    const quint64* previous = m_lastHashes.constData();
+    const quint64* current = hashes.constData();
+    int top = 0;
+    while (top < rows && previous[top] == current[top]) {
+        ++top;
+    }
+    if (top == rows) {
+        return NO_MOVEMENT;
+    }
+    int bottom = 0;
+    while (previous[rows - 1 - bottom] == current[rows - 1 - bottom]) {
+        ++bottom;
+    }
+
+    const int band = rows - top - bottom;
+    const int offset = findOffset(previous + top, current + top, band);
+    if (offset <= 0) {
+        return NO_MATCH;
+    }
+
+    // The stitched image ends with the footer of the previous frame, put
+    // the new rows above it
+    m_image.truncate(m_image.height() - bottom);
+    m_image.appendRows(frame, rows - bottom - offset, offset + bottom);
+    m_lastHashes = hashes;
+    m_appendedRows = offset;
+    return APPENDED;
+}
+
+int ScrollStitcher::appendedRows() const
+{
+    return m_appendedRows;
+}
+
+const TiledImage& ScrollStitcher::image() const
+{
+    return m_image;
+}
+
+void ScrollStitcher::clear()
+{
+    m_image.clear();
+    m_lastHashes.clear();
+    m_appendedRows = 0;
+}
+
+/**
+ * @brief Hash the pixels of every row with a polynomial hash, four
+ * interleaved lanes at a time so that the multiplications do not wait on
+ * each other.
+ */
+QVector<quint64> ScrollStitcher::rowHashes(const QImage& frame)
+{
+    const int width = frame.width();
+    const int margin = std::min(MAX_HASH_MARGIN, width / 8);
+    const int first = margin;
+    const int last = width - margin;
+
+    QVector<quint64> hashes(frame.height());
+    for (int y = 0; y < frame.height(); ++y) {
+        const auto* line = reinterpret_cast<const quint32*>(frame.scanLine(y));
+        std::array<quint64, 4> lanes = { 1, 2, 3, 4 };
+        int x = first;
+        for (; x + 4 <= last; x += 4) {
+            for (int lane = 0; lane < 4; ++lane) {
+                lanes[lane] = (lanes[lane] + line[x + lane]) * HASH_PRIME;
+            }
+        }
+        for (; x < last; ++x) {
+            lanes[0] = (lanes[0] + line[x]) * HASH_PRIME;
+        }
+        quint64 hash = lanes[0];
+        for (int lane = 1; lane < 4; ++lane) {
+            hash = hash * HASH_PRIME + lanes[lane];
+        }
+        hashes[y] = hash;
+    }
+    return hashes;
+}
+
+/**
+ * @brief Find by how many rows the content moved up between two frames,
+ * comparing the row hashes at every candidate offset.
+ *
+ * Runs of identical rows (blank lines, solid backgrounds) line up at any
+ * offset, so only the first row of each run is counted. Returns 0 when no
+ * offset matches well enough.
+ */
+int ScrollStitcher::findOffset(const quint64* previous,
+                               const quint64* current,
+                               int rows)
+{
+    const int minOverlap = std::max(MIN_OVERLAP, rows / MIN_OVERLAP_DIVISOR);
+    if (rows <= minOverlap) {
+        return 0;
+    }
+
+    // 1 for rows starting a run, as integers to keep the loop below branchless
+    QVector<quint64> distinct(rows);
+    QVector<int> distinctBefore(rows + 1);
+    distinctBefore[0] = 0;
+    for (int y = 0; y < rows; ++y) {
+        distinct[y] = (y == 0 || current[y] != current[y - 1]) ? 1 : 0;
+        distinctBefore[y + 1] =
+          distinctBefore[y] + static_cast<int>(distinct[y]);
+    }
+
+    int bestOffset = 0;
+    double bestScore = MATCH_THRESHOLD;
+    const quint64* mask = distinct.constData();
+    for (int offset = 1; offset <= rows - minOverlap; ++offset) {
+        const int overlap = rows - offset;
+        const int candidates = distinctBefore[overlap];
+        if (candidates < MIN_DISTINCT_MATCHES) {
+            continue;
+        }
+        const quint64* shifted = previous + offset;
+        // Plain counting loop over contiguous arrays, vectorized by the
+        // compiler
+        quint64 matches = 0;
+        for (int y = 0; y < overlap; ++y) {
+            matches += static_cast<quint64>(shifted[y] == current[y]) & mask[y];
+        }
+        const double score = static_cast<double>(matches) / candidates;
+        // The smallest offset wins ties, repeated content matches at several
+        if (score > bestScore || (bestOffset == 0 && score >= bestScore)) {
+            bestScore = score;
+            bestOffset = offset;
+        }
+    }
+    return bestOffset;
+}
@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "src/utils/tiledimage.h"
+#include <QImage>
+#include <QVector>
+
+/**
+ * @brief Assemble a long image from captures of a region being scrolled.
+ *
+ * Every frame is reduced to one hash per row. The vertical scroll between
+ * two frames is the offset at which the row hashes of the new frame line up
+ * with those of the previous one, and only the rows scrolled into view are
+ * appended. Rows which did not move at the top and bottom of the region
+ * (sticky headers and footers) are kept once.
+ */
+class ScrollStitcher
+{
+public:
+    enum Result
+    {
+        FIRST_FRAME,
+        NO_MOVEMENT,
+        APPENDED,
+        // The frame does not overlap the previous one, e.g. the content was
+        // scrolled too fast or upwards. It is ignored.
+        NO_MATCH,
+    };
+
+    ScrollStitcher();
+
+    Result append(const QImage& frame);
+    // Rows added by the last successful append
+    int appendedRows() const;
+    const TiledImage& image() const;
+    void clear();
+
+private:
+    static QVector<quint64> rowHashes(const QImage& frame);
+    static int findOffset(const quint64* previous,
+                          const quint64* current,
+                          int rows);
+
+    TiledImage m_image;
+    QVector<quint64> m_lastHashes;
+    int m_appendedRows;
+};
@@ -0,0 +1,221 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "textregions.h"
+#include <QElapsedTimer>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// Strokes are counted in cells of the image
+const int CELL_WIDTH = 8;
+const int CELL_HEIGHT = 4;
+// Brightness difference between two neighbours making an edge
+const int EDGE_THRESHOLD = 48;
+// Widest stroke of a glyph, in pixels
+const int MAX_STROKE_WIDTH = 10;
+// Strokes in a cell for it to be part of text
+const int MIN_CELL_STROKES = 3;
+// Gap between two words of a line, in cells
+const int MAX_WORD_GAP = 2;
+// Size of a line box, in cells
+const int MIN_LINE_HEIGHT = 2;
+const int MAX_LINE_HEIGHT = 24;
+const int MIN_LINE_WIDTH = 3;
+// Rows of a component with fewer cells than this share of its fullest row
+// separate two lines, in percent
+const int LINE_SPLIT_PERCENT = 15;
+// Share of the cells of a line box that are part of the text, in percent
+const int MIN_FILL_PERCENT = 35;
+const int PADDING = 2;
+const int ROWS_PER_BUDGET_CHECK = 8 * CELL_HEIGHT;
+
+// 1 for a rising edge, -1 for a falling one, 0 elsewhere. No branches, so
+// that the compiler vectorizes it.
+void findEdges(const uchar* luma, qint8* edges, int width)
+{
+    for (int x = 0; x < width - 1; ++x) {
+        const int gradient = int(luma[x + 1]) - int(luma[x]);
+        edges[x] = static_cast<qint8>((gradient > EDGE_THRESHOLD) -
+                                      (gradient < -EDGE_THRESHOLD));
+    }
+    edges[width - 1] = 0;
+}
+
+// A stroke is an edge followed closely by an edge of the opposite sign, e.g.
+// into a dark glyph and back to the light background. Adds the strokes of a
+// row to the cells they are centered in.
+void countStrokes(const qint8* edges, int width, quint16* cells)
+{
+    int openingEnd = 0;
+    int openingSign = 0;
+    int x = 0;
+    while (x < width) {
+        // Most of a row has no edge, skip them 8 pixels at a time
+        if (x + 8 <= width) {
+            quint64 word;
+            std::memcpy(&word, edges + x, sizeof(word));
+            if (word == 0) {
+                x += 8;
+                continue;
+            }
+        }
+        const int sign = edges[x];
+        if (sign == 0) {
+            ++x;
+            continue;
+        }
+        // Antialiased edges span a few pixels
+        int end = x + 1;
+        while (end < width && edges[end] == sign) {
+            ++end;
+        }
+        if (openingSign == -sign && x - openingEnd <= MAX_STROKE_WIDTH) {
+            ++cells[(openingEnd + x) / 2 / CELL_WIDTH];
+            openingSign = 0;
+        } else {
+            openingSign = sign;
+            openingEnd = end;
+        }
+        x = end;
+    }
+}
+
+} // unnamed namespace
+
+namespace TextRegions {
+
+QList<QRect> detect(const QImage& image, int budgetMs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    if (image.width() < 2 || image.height() < CELL_HEIGHT) {
+        return {};
+    }
+
+    const QImage luma = image.convertToFormat(QImage::Format_Grayscale8);
+    const int width = luma.width();
+    const int height = luma.height();
+    const int columns = (width + CELL_WIDTH - 1) / CELL_WIDTH;
+    int rows = (height + CELL_HEIGHT - 1) / CELL_HEIGHT;
+
+    std::vector<quint16> strokes(size_t(columns) * rows, 0);
+    std::vector<qint8> edges(width);
+    for (int y = 0; y < height; ++y) {
+        if (y % ROWS_PER_BUDGET_CHECK == 0 && timer.elapsed() > budgetMs) {
+            rows = y / CELL_HEIGHT;
+            break;
+        }
+        findEdges(luma.constScanLine(y), edges.data(), width);
+        countStrokes(edges.data(),
+                     width,
+                     strokes.data() + size_t(y / CELL_HEIGHT) * columns);
+    }
+
+    // Cells dense in strokes, with the gaps between words filled
+    std::vector<uchar> text(size_t(columns) * rows, 0);
+    for (int r = 0; r < rows; ++r) {
+        uchar* line = text.data() + size_t(r) * columns;
+        const quint16* counts = strokes.data() + size_t(r) * columns;
+        int previous = -1;
+        for (int c = 0; c < columns; ++c) {
+            if (counts[c] < MIN_CELL_STROKES) {
+                continue;
+            }
+            line[c] = 1;
+            if (previous >= 0 && c - previous - 1 <= MAX_WORD_GAP) {
+                std::memset(line + previous + 1, 1, size_t(c - previous - 1));
+            }
+            previous = c;
+        }
+    }
+
+    QList<QRect> boxes;
+    std::vector<int> component;
+    std::vector<int> pending;
+    for (int start = 0; start < columns * rows; ++start) {
+        if (text[start] != 1) {
+            continue;
+        }
+        // Flood fill, visited cells are marked with 2
+        component.clear();
+        pending.assign(1, start);
+        text[start] = 2;
+        int top = rows;
+        int bottom = 0;
+        while (!pending.empty()) {
+            const int cell = pending.back();
+            pending.pop_back();
+            component.push_back(cell);
+            const int r = cell / columns;
+            const int c = cell % columns;
+            top = qMin(top, r);
+            bottom = qMax(bottom, r);
+            const int neighbours[] = { c > 0 ? cell - 1 : -1,
+                                       c < columns - 1 ? cell + 1 : -1,
+                                       r > 0 ? cell - columns : -1,
+                                       r < rows - 1 ? cell + columns : -1 };
+            for (const int neighbour : neighbours) {
+                if (neighbour >= 0 && text[neighbour] == 1) {
+                    text[neighbour] = 2;
+                    pending.push_back(neighbour);
+                }
+            }
+        }
+
+        // Paragraphs make a single component, split it where rows are
+        // (almost) empty
+        const int lineRows = bottom - top + 1;
+        std::vector<int> counts(lineRows, 0);
+        std::vector<int> left(lineRows, columns);
+        std::vector<int> right(lineRows, -1);
+        for (const int cell : component) {
+            const int r = cell / columns - top;
+            const int c = cell % columns;
+            ++counts[r];
+            left[r] = qMin(left[r], c);
+            right[r] = qMax(right[r], c);
+        }
+        int peak = 0;
+        for (const int count : counts) {
+            peak = qMax(peak, count);
+        }
+        const int threshold = qMax(1, peak * LINE_SPLIT_PERCENT / 100);
+
+        int lineStart = -1;
+        for (int r = 0; r <= lineRows; ++r) {
+            const bool inLine = r < lineRows && counts[r] >= threshold;
+            if (inLine && lineStart < 0) {
+                lineStart = r;
+            }
+            if (inLine || lineStart < 0) {
+                continue;
+            }
+            int boxLeft = columns;
+            int boxRight = -1;
+            int cells = 0;
+            for (int i = lineStart; i < r; ++i) {
+                boxLeft = qMin(boxLeft, left[i]);
+                boxRight = qMax(boxRight, right[i]);
+                cells += counts[i];
+            }
+            const int boxWidth = boxRight - boxLeft + 1;
+            const int boxHeight = r - lineStart;
+            // Lines of text are wider than high, and mostly filled
+            if (boxHeight >= MIN_LINE_HEIGHT && boxHeight <= MAX_LINE_HEIGHT &&
+                boxWidth >= qMax(MIN_LINE_WIDTH, boxHeight) &&
+                cells * 100 >= MIN_FILL_PERCENT * boxWidth * boxHeight) {
+                const QRect box(boxLeft * CELL_WIDTH - PADDING,
+                                (top + lineStart) * CELL_HEIGHT - PADDING,
+                                boxWidth * CELL_WIDTH + 2 * PADDING,
+                                boxHeight * CELL_HEIGHT + 2 * PADDING);
+                boxes << box.intersected(luma.rect());
+            }
+            lineStart = -1;
+        }
+    }
+    return boxes;
+}
+
+} // namespace TextRegions
@@ -0,0 +1,20 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QImage>
+#include <QList>
+#include <QRect>
+
+// Finds the lines of text of a capture without recognizing them, to suggest
+// areas to pixelate. Text shows up as many thin strokes, i.e. close pairs of
+// opposite brightness edges along a row. Areas dense in strokes are grouped
+// into connected components, which are split into line boxes.
+namespace TextRegions {
+
+// Line boxes in pixels of the image. The rows below the point reached when
+// the time budget runs out are not searched.
+QList<QRect> detect(const QImage& image, int budgetMs);
+
+} // namespace TextRegions
@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "tiledimage.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+TiledImage::TiledImage(int width, QImage::Format format, int tileHeight)
+  : m_width(width)
+  , m_format(format)
+  , m_tileHeight(std::max(1, tileHeight))
+  , m_height(0)
+{}
+
+int TiledImage::width() const
+{
+    return m_width;
+}
+
+int TiledImage::height() const
+{
+    return m_height;
+}
+
+QImage::Format TiledImage::format() const
+{
+    return m_format;
+}
+
+bool TiledImage::isEmpty() const
+{
+    return m_height == 0;
+}
+
+void TiledImage::appendRows(const QImage& source, int firstRow, int count)
+{
+    Q_ASSERT(source.width() == m_width && source.format() == m_format);
+    firstRow = std::max(0, firstRow);
+    count = std::min(count, source.height() - firstRow);
+    if (count <= 0) {
+        return;
+    }
+
+    const qsizetype rowBytes = source.bytesPerLine();
+    for (int row = 0; row < count; ++row) {
+        const int tile = m_height / m_tileHeight;
+        if (tile == m_tiles.size()) {
+            m_tiles.append(QImage(m_width, m_tileHeight, m_format));
+        }
+        uchar* dest = m_tiles[tile].scanLine(m_height % m_tileHeight);
+        std::memcpy(dest,
+                    source.constScanLine(firstRow + row),
+                    std::min(rowBytes, m_tiles[tile].bytesPerLine()));
+        ++m_height;
+    }
+}
+
+void TiledImage::truncate(int height)
+{
+    if (height < 0 || height >= m_height) {
+        return;
+    }
+    m_height = height;
+    // keep the tile being filled, release the ones after it
+    const int tiles = (m_height + m_tileHeight - 1) / m_tileHeight;
+    while (m_tiles.size() > tiles) {
+        m_tiles.removeLast();
+    }
+}
+
+void TiledImage::clear()
+{
+    m_tiles.clear();
+    m_height = 0;
+}
+
+int TiledImage::maxImageHeight() const
+{
+    if (m_width <= 0) {
+        return 0;
+    }
+    // QImage addresses its buffer with an int byte count
+    const qsizetype rowBytes = QImage(m_width, 1, m_format).bytesPerLine();
+    return static_cast<int>(std::numeric_limits<int>::max() / rowBytes);
+}
+
+QImage TiledImage::copy(int y, int height) const
+{
+    y = std::clamp(y, 0, m_height);
+    height = std::min(height, m_height - y);
+    if (height <= 0 || height > maxImageHeight()) {
+        return {};
+    }
+
+    QImage image(m_width, height, m_format);
+    if (image.isNull()) {
+        return {};
+    }
+    for (int row = 0; row < height; ++row) {
+        const int source = y + row;
+        const QImage& tile = m_tiles.at(source / m_tileHeight);
+        std::memcpy(image.scanLine(row),
+                    tile.constScanLine(source % m_tileHeight),
+                    std::min(image.bytesPerLine(), tile.bytesPerLine()));
+    }
+    return image;
+}
+
+QImage TiledImage::toImage() const
+{
+    return copy(0, m_height);
+}
@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QImage>
+#include <QList>
+
+/**
+ * @brief Image of fixed width made of horizontal tiles, growing downwards.
+ *
+ * Appending rows never copies the rows already stored, and the total height
+ * is not bound by the size limits of a single QImage.
+ */
+class TiledImage
+{
+public:
+    static const int DEFAULT_TILE_HEIGHT = 1024;
+
+    explicit TiledImage(int width = 0,
+                        QImage::Format format = QImage::Format_RGB32,
+                        int tileHeight = DEFAULT_TILE_HEIGHT);
+
+    int width() const;
+    int height() const;
+    QImage::Format format() const;
+    bool isEmpty() const;
+
+    // Append `count` rows of `source` starting at `firstRow`. The source must
+    // have the width and format of the tiled image.
+    void appendRows(const QImage& source, int firstRow, int count);
+    // Drop the rows after `height`
+    void truncate(int height);
+    void clear();
+
+    // Largest height that fits in a single QImage of this width and format
+    int maxImageHeight() const;
+    // Copy rows [y, y + height) into a single image
+    QImage copy(int y, int height) const;
+    QImage toImage() const;
+
+private:
+    int m_width;
+    QImage::Format m_format;
+    int m_tileHeight;
+    int m_height;
+    QList<QImage> m_tiles;
+};
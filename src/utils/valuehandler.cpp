@@ -2,10 +2,10 @@
 #include "capturetool.h"
 #include "colorpickerwidget.h"
 #include "confighandler.h"
+#include "imageencoder.h"
 #include "screengrabber.h"
 #include <QColor>
 #include <QFileInfo>
-#include <QImageWriter>
 #include <QKeySequence>
 #include <QRegularExpression>
 #include <QStandardPaths>
@@ -490,11 +490,7 @@ bool SaveFileExtension::check(const QVariant& val)
         extension.remove(0, 1);
     }
 
-    QStringList imageFormatList;
-    for (const auto& imageFormat : QImageWriter::supportedImageFormats())
-        imageFormatList.append(imageFormat);
-
-    if (!imageFormatList.contains(extension)) {
+    if (!ImageEncoder::supportedFormats().contains(extension)) {
         return false;
     }
 
@@ -0,0 +1,751 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "wlrscreencopy.h"
+#include "abstractlogger.h"
+#include "src/utils/bufferpool.h"
+#include "src/utils/monitortopology.h"
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QPainter>
+#include <QPointer>
+#include <QScreen>
+#include <QTransform>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <wayland-client.h>
+
+#include "wlr-screencopy-unstable-v1-client-protocol.h"
+
+namespace {
+// A capture that takes longer than this is considered failed, the caller
+// then falls back to the next capture method
+constexpr int CAPTURE_TIMEOUT_MS = 2000;
+
+int createShmFile(size_t size)
+{
+#if defined(__linux__)
+    int fd = memfd_create("flameshot-screencopy", MFD_CLOEXEC);
+#else
+    char name[] = "/flameshot-screencopy-XXXXXX";
+    int fd = -1;
+    for (int retries = 0; retries < 100 && fd < 0; ++retries) {
+        for (char* c = name + sizeof(name) - 7; *c != '\0'; ++c) {
+            *c = 'A' + (rand() % 26);
+        }
+        fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    }
+    if (fd >= 0) {
+        shm_unlink(name);
+    }
+#endif
+    if (fd < 0) {
+        return -1;
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+QTransform outputTransform(int32_t transform, const QSize& size)
+{
+    // The buffer is in the orientation of the output, undo the output
+    // transform to get back to the orientation of the compositor layout
+    QTransform t;
+    if (transform >= WL_OUTPUT_TRANSFORM_FLIPPED) {
+        t.scale(-1, 1);
+        t.translate(-size.width(), 0);
+    }
+    switch (transform % 4) {
+        case WL_OUTPUT_TRANSFORM_90:
+            t.rotate(90);
+            break;
+        case WL_OUTPUT_TRANSFORM_180:
+            t.rotate(180);
+            break;
+        case WL_OUTPUT_TRANSFORM_270:
+            t.rotate(270);
+            break;
+        default:
+            break;
+    }
+    return t;
+}
+} // unnamed namespace
+
+WlrScreencopy::WlrScreencopy(QObject* parent)
+  : QObject(parent)
+  , m_display(nullptr)
+  , m_registry(nullptr)
+  , m_shm(nullptr)
+  , m_manager(nullptr)
+  , m_managerVersion(0)
+{
+    // Buffer sizes depend on the output modes, no need to keep the old ones
+    connect(MonitorTopology::instance(),
+            &MonitorTopology::changed,
+            this,
+            &WlrScreencopy::releaseBuffers);
+}
+
+WlrScreencopy::~WlrScreencopy()
+{
+    disconnectFromDisplay();
+}
+
+WlrScreencopy* WlrScreencopy::instance()
+{
+    // Owned by the application, so that the Wayland connection is closed
+    // before qApp is destroyed instead of after it
+    static QPointer<WlrScreencopy> screencopy;
+    if (screencopy.isNull()) {
+        screencopy = new WlrScreencopy(qApp);
+    }
+    return screencopy;
+}
+
+bool WlrScreencopy::isAvailable()
+{
+    if (m_display == nullptr && !connectToDisplay()) {
+        return false;
+    }
+    return m_manager != nullptr && m_shm != nullptr && !m_outputs.isEmpty();
+}
+
+QImage WlrScreencopy::grabDesktop(bool& ok)
+{
+    QRect region;
+    if (isAvailable()) {
+        for (const Output* output : m_outputs) {
+            region = region.united(logicalGeometry(output));
+        }
+    }
+    return grabRegion(region, ok);
+}
+
+QImage WlrScreencopy::grabRegion(const QRect& region, bool& ok)
+{
+    ok = false;
+    if (!isAvailable() || region.isEmpty()) {
+        return QImage();
+    }
+    // Pick up outputs that were added or removed since the last capture
+    if (wl_display_roundtrip(m_display) < 0) {
+        disconnectFromDisplay();
+        return QImage();
+    }
+
+    static const zwlr_screencopy_frame_v1_listener frameListener = {
+        &WlrScreencopy::handleFrameBuffer,
+        &WlrScreencopy::handleFrameFlags,
+        &WlrScreencopy::handleFrameReady,
+        &WlrScreencopy::handleFrameFailed,
+        &WlrScreencopy::handleFrameDamage,
+        &WlrScreencopy::handleFrameLinuxDmabuf,
+        &WlrScreencopy::handleFrameBufferDone,
+    };
+
+    QList<Frame*> frames;
+    for (Output* output : m_outputs) {
+        const QRect outputRect = logicalGeometry(output);
+        const QRect captureRect = outputRect.intersected(region);
+        if (captureRect.isEmpty()) {
+            continue;
+        }
+
+        auto* frame = new Frame;
+        frame->owner = this;
+        frame->transform = output->transform;
+        frame->logicalRect = captureRect;
+        if (captureRect == outputRect) {
+            frame->frame = zwlr_screencopy_manager_v1_capture_output(
+              m_manager, 0, output->output);
+        } else {
+            const QRect local = captureRect.translated(-outputRect.topLeft());
+            frame->frame =
+              zwlr_screencopy_manager_v1_capture_output_region(m_manager,
+                                                               0,
+                                                               output->output,
+                                                               local.x(),
+                                                               local.y(),
+                                                               local.width(),
+                                                               local.height());
+        }
+        zwlr_screencopy_frame_v1_add_listener(
+          frame->frame, &frameListener, frame);
+        frames.append(frame);
+    }
+
+    const bool dispatched = dispatchUntil(
+      [&frames]() {
+          for (const Frame* frame : frames) {
+              if (frame->state == Frame::PENDING) {
+                  return false;
+              }
+          }
+          return true;
+      },
+      CAPTURE_TIMEOUT_MS);
+
+    bool failed = !dispatched || frames.isEmpty();
+    for (const Frame* frame : frames) {
+        failed = failed || frame->state != Frame::READY;
+    }
+
+    QImage res;
+    if (failed) {
+        AbstractLogger::warning()
+          << tr("wlr-screencopy capture failed, falling back.");
+    } else {
+        res = assemble(frames, region);
+        ok = !res.isNull();
+    }
+
+    for (Frame* frame : frames) {
+        zwlr_screencopy_frame_v1_destroy(frame->frame);
+        if (frame->buffer != nullptr) {
+            frame->buffer->busy = false;
+        }
+        delete frame;
+    }
+    if (m_display != nullptr) {
+        wl_display_flush(m_display);
+    }
+    if (!dispatched) {
+        // The connection is in an unknown state, start over next time
+        disconnectFromDisplay();
+    }
+    return res;
+}
+
+void WlrScreencopy::releaseBuffers()
+{
+    for (auto it = m_buffers.begin(); it != m_buffers.end();) {
+        if ((*it)->busy) {
+            ++it;
+            continue;
+        }
+        destroyBuffer(*it);
+        it = m_buffers.erase(it);
+    }
+}
+
+bool WlrScreencopy::connectToDisplay()
+{
+    if (qEnvironmentVariableIsEmpty("WAYLAND_DISPLAY")) {
+        return false;
+    }
+    m_display = wl_display_connect(nullptr);
+    if (m_display == nullptr) {
+        AbstractLogger::warning()
+          << tr("Unable to connect to the Wayland display.");
+        return false;
+    }
+
+    static const wl_registry_listener registryListener = {
+        &WlrScreencopy::handleGlobal,
+        &WlrScreencopy::handleGlobalRemove,
+    };
+    m_registry = wl_display_get_registry(m_display);
+    wl_registry_add_listener(m_registry, &registryListener, this);
+    // The first roundtrip announces the globals, the second one delivers the
+    // initial state of the bound outputs
+    if (wl_display_roundtrip(m_display) < 0 ||
+        wl_display_roundtrip(m_display) < 0) {
+        disconnectFromDisplay();
+        return false;
+    }
+    return true;
+}
+
+void WlrScreencopy::disconnectFromDisplay()
+{
+    for (ShmBuffer* buffer : m_buffers) {
+        destroyBuffer(buffer);
+    }
+    m_buffers.clear();
+    for (Output* output : m_outputs) {
+        wl_output_destroy(output->output);
+        delete output;
+    }
+    m_outputs.clear();
+    if (m_manager != nullptr) {
+        zwlr_screencopy_manager_v1_destroy(m_manager);
+        m_manager = nullptr;
+    }
+    if (m_shm != nullptr) {
+        wl_shm_destroy(m_shm);
+        m_shm = nullptr;
+    }
+    if (m_registry != nullptr) {
+        wl_registry_destroy(m_registry);
+        m_registry = nullptr;
+    }
+    if (m_display != nullptr) {
+        wl_display_disconnect(m_display);
+        m_display = nullptr;
+    }
+}
+
+bool WlrScreencopy::dispatchUntil(const std::function<bool()>& done,
+                                  int timeoutMs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (!done()) {
+        if (wl_display_prepare_read(m_display) != 0) {
+            if (wl_display_dispatch_pending(m_display) < 0) {
+                return false;
+            }
+            continue;
+        }
+        wl_display_flush(m_display);
+
+        const int remaining = timeoutMs - static_cast<int>(timer.elapsed());
+        if (remaining <= 0) {
+            wl_display_cancel_read(m_display);
+            return false;
+        }
+        pollfd fd = { wl_display_get_fd(m_display), POLLIN, 0 };
+        const int ret = poll(&fd, 1, remaining);
+        if (ret <= 0) {
+            wl_display_cancel_read(m_display);
+            if (ret < 0 && errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        if (wl_display_read_events(m_display) < 0 ||
+            wl_display_dispatch_pending(m_display) < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+QRect WlrScreencopy::logicalGeometry(const Output* output) const
+{
+    // Qt knows the exact logical geometry through xdg-output, which is needed
+    // for fractional scales
+    for (QScreen* const screen : QGuiApplication::screens()) {
+        if (!output->name.isEmpty() && screen->name() == output->name) {
+            return screen->geometry();
+        }
+    }
+
+    QSize size = output->modeSize / qMax(1, output->scale);
+    if (output->transform % 2 == 1) {
+        size.transpose();
+    }
+    return QRect(output->position, size);
+}
+
+WlrScreencopy::ShmBuffer* WlrScreencopy::acquireBuffer(const Frame& frame)
+{
+    ShmBuffer* spare = nullptr;
+    for (ShmBuffer* buffer : m_buffers) {
+        if (buffer->busy) {
+            continue;
+        }
+        if (buffer->format == frame.format && buffer->width == frame.width &&
+            buffer->height == frame.height && buffer->stride == frame.stride) {
+            buffer->busy = true;
+            return buffer;
+        }
+        spare = buffer;
+    }
+
+    // Replace an idle buffer of the wrong size rather than growing the pool,
+    // which then holds at most one buffer per output
+    if (spare != nullptr) {
+        m_buffers.removeOne(spare);
+        destroyBuffer(spare);
+    }
+    ShmBuffer* buffer = createBuffer(frame);
+    if (buffer != nullptr) {
+        buffer->busy = true;
+        m_buffers.append(buffer);
+    }
+    return buffer;
+}
+
+WlrScreencopy::ShmBuffer* WlrScreencopy::createBuffer(const Frame& frame)
+{
+    const size_t size = static_cast<size_t>(frame.stride) * frame.height;
+    const int fd = createShmFile(size);
+    if (fd < 0) {
+        AbstractLogger::warning()
+          << tr("Unable to create a shared memory buffer: %1")
+               .arg(QString::fromLocal8Bit(strerror(errno)));
+        return nullptr;
+    }
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        close(fd);
+        return nullptr;
+    }
+
+    wl_shm_pool* pool = wl_shm_create_pool(m_shm, fd, static_cast<int>(size));
+    auto* buffer = new ShmBuffer;
+    buffer->buffer = wl_shm_pool_create_buffer(
+      pool, 0, frame.width, frame.height, frame.stride, frame.format);
+    wl_shm_pool_destroy(pool);
+    close(fd);
+
+    buffer->data = data;
+    buffer->size = size;
+    buffer->format = frame.format;
+    buffer->width = frame.width;
+    buffer->height = frame.height;
+    buffer->stride = frame.stride;
+    return buffer;
+}
+
+void WlrScreencopy::destroyBuffer(ShmBuffer* buffer)
+{
+    if (buffer->buffer != nullptr) {
+        wl_buffer_destroy(buffer->buffer);
+    }
+    if (buffer->data != nullptr) {
+        munmap(buffer->data, buffer->size);
+    }
+    delete buffer;
+}
+
+void WlrScreencopy::startCopy(Frame* frame)
+{
+    if (frame->copyRequested || frame->state != Frame::PENDING) {
+        return;
+    }
+    frame->copyRequested = true;
+    if (!frame->hasShmInfo) {
+        frame->state = Frame::FAILED;
+        return;
+    }
+    frame->buffer = acquireBuffer(*frame);
+    if (frame->buffer == nullptr) {
+        frame->state = Frame::FAILED;
+        return;
+    }
+    zwlr_screencopy_frame_v1_copy(frame->frame, frame->buffer->buffer);
+}
+
+QImage WlrScreencopy::assemble(const QList<Frame*>& frames,
+                               const QRect& region)
+{
+    // The result uses the density of the most dense output, so nothing is
+    // lost on mixed DPI setups
+    qreal scale = 1.0;
+    QImage::Format format = imageFormat(frames.first()->format);
+    for (const Frame* frame : frames) {
+        scale = qMax(scale,
+                     static_cast<qreal>(frame->width) /
+                       qMax(1, frame->transform % 2 == 1
+                                 ? frame->logicalRect.height()
+                                 : frame->logicalRect.width()));
+        if (imageFormat(frame->format) != format) {
+            format = QImage::Format_RGB32;
+        }
+    }
+
+    const QSize canvasSize(qRound(region.width() * scale),
+                           qRound(region.height() * scale));
+    QImage canvas = BufferPool::instance()->image(canvasSize, format);
+    if (canvas.isNull()) {
+        return QImage();
+    }
+    if (frames.size() > 1 || frames.first()->logicalRect != region) {
+        // Areas of the bounding box not covered by any output
+        canvas.fill(Qt::black);
+    }
+
+    for (const Frame* frame : frames) {
+        const ShmBuffer* buffer = frame->buffer;
+        const QPoint offset(
+          qRound((frame->logicalRect.x() - region.x()) * scale),
+          qRound((frame->logicalRect.y() - region.y()) * scale));
+        const QRect target(offset,
+                           QSize(qRound(frame->logicalRect.width() * scale),
+                                 qRound(frame->logicalRect.height() * scale)));
+        const bool yInvert =
+          frame->flags & ZWLR_SCREENCOPY_FRAME_V1_FLAGS_Y_INVERT;
+
+        if (imageFormat(buffer->format) == format &&
+            frame->transform == WL_OUTPUT_TRANSFORM_NORMAL &&
+            target.size() == QSize(buffer->width, buffer->height) &&
+            canvas.rect().contains(target)) {
+            // Common case, copy the rows straight out of shared memory
+            const auto* src = static_cast<const uchar*>(buffer->data);
+            const size_t rowBytes = static_cast<size_t>(buffer->width) * 4;
+            for (int y = 0; y < buffer->height; ++y) {
+                const int srcRow = yInvert ? buffer->height - 1 - y : y;
+                uchar* dst = canvas.scanLine(offset.y() + y) + offset.x() * 4;
+                memcpy(dst, src + srcRow * buffer->stride, rowBytes);
+            }
+            continue;
+        }
+
+        // Mixed formats, rotated outputs or outputs with a lower density than
+        // the canvas need to go through QPainter
+        QImage view(static_cast<const uchar*>(buffer->data),
+                    buffer->width,
+                    buffer->height,
+                    buffer->stride,
+                    imageFormat(buffer->format));
+        if (yInvert) {
+            view = view.mirrored(false, true);
+        }
+        if (frame->transform != WL_OUTPUT_TRANSFORM_NORMAL) {
+            view = view.transformed(
+              outputTransform(frame->transform, view.size()));
+        }
+        QPainter painter(&canvas);
+        painter.setRenderHint(QPainter::SmoothPixmapTransform);
+        painter.drawImage(target, view);
+    }
+    return canvas;
+}
+
+QImage::Format WlrScreencopy::imageFormat(uint32_t shmFormat)
+{
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    // wl_shm formats are little endian, QImage formats are native endian
+    switch (shmFormat) {
+        case WL_SHM_FORMAT_ARGB8888:
+        case WL_SHM_FORMAT_XRGB8888:
+            return QImage::Format_RGB32;
+        case WL_SHM_FORMAT_ABGR8888:
+        case WL_SHM_FORMAT_XBGR8888:
+            return QImage::Format_RGBX8888;
+        case WL_SHM_FORMAT_XRGB2101010:
+        case WL_SHM_FORMAT_ARGB2101010:
+            return QImage::Format_RGB30;
+        case WL_SHM_FORMAT_XBGR2101010:
+        case WL_SHM_FORMAT_ABGR2101010:
+            return QImage::Format_BGR30;
+        default:
+            break;
+    }
+#else
+    Q_UNUSED(shmFormat);
+#endif
+    return QImage::Format_Invalid;
+}
+
+void WlrScreencopy::handleGlobal(void* data,
+                                 wl_registry* registry,
+                                 uint32_t name,
+                                 const char* interface,
+                                 uint32_t version)
+{
+    auto* self = static_cast<WlrScreencopy*>(data);
+    if (strcmp(interface, wl_shm_interface.name) == 0) {
+        self->m_shm = static_cast<wl_shm*>(
+          wl_registry_bind(registry, name, &wl_shm_interface, 1));
+    } else if (strcmp(interface, zwlr_screencopy_manager_v1_interface.name) ==
+               0) {
+        self->m_managerVersion = qMin(version, 3u);
+        self->m_manager =
+          static_cast<zwlr_screencopy_manager_v1*>(wl_registry_bind(
+            registry,
+            name,
+            &zwlr_screencopy_manager_v1_interface,
+            self->m_managerVersion));
+    } else if (strcmp(interface, wl_output_interface.name) == 0) {
+        static const wl_output_listener outputListener = {
+            &WlrScreencopy::handleOutputGeometry,
+            &WlrScreencopy::handleOutputMode,
+            &WlrScreencopy::handleOutputDone,
+            &WlrScreencopy::handleOutputScale,
+            &WlrScreencopy::handleOutputName,
+            &WlrScreencopy::handleOutputDescription,
+        };
+        auto* output = new Output;
+        output->globalName = name;
+        output->output = static_cast<wl_output*>(wl_registry_bind(
+          registry, name, &wl_output_interface, qMin(version, 4u)));
+        wl_output_add_listener(output->output, &outputListener, output);
+        self->m_outputs.append(output);
+    }
+}
+
+void WlrScreencopy::handleGlobalRemove(void* data,
+                                       wl_registry* registry,
+                                       uint32_t name)
+{
+    Q_UNUSED(registry);
+    auto* self = static_cast<WlrScreencopy*>(data);
+    for (auto it = self->m_outputs.begin(); it != self->m_outputs.end(); ++it) {
+        if ((*it)->globalName == name) {
+            wl_output_destroy((*it)->output);
+            delete *it;
+            self->m_outputs.erase(it);
+            return;
+        }
+    }
+}
+
+void WlrScreencopy::handleOutputGeometry(void* data,
+                                         wl_output* output,
+                                         int32_t x,
+                                         int32_t y,
+                                         int32_t physicalWidth,
+                                         int32_t physicalHeight,
+                                         int32_t subpixel,
+                                         const char* make,
+                                         const char* model,
+                                         int32_t transform)
+{
+    Q_UNUSED(output);
+    Q_UNUSED(physicalWidth);
+    Q_UNUSED(physicalHeight);
+    Q_UNUSED(subpixel);
+    Q_UNUSED(make);
+    Q_UNUSED(model);
+    auto* self = static_cast<Output*>(data);
+    self->position = QPoint(x, y);
+    self->transform = transform;
+}
+
+void WlrScreencopy::handleOutputMode(void* data,
+                                     wl_output* output,
+                                     uint32_t flags,
+                                     int32_t width,
+                                     int32_t height,
+                                     int32_t refresh)
+{
+    Q_UNUSED(output);
+    Q_UNUSED(refresh);
+    if (flags & WL_OUTPUT_MODE_CURRENT) {
+        static_cast<Output*>(data)->modeSize = QSize(width, height);
+    }
+}
+
+void WlrScreencopy::handleOutputDone(void* data, wl_output* output)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(output);
+}
+
+void WlrScreencopy::handleOutputScale(void* data,
+                                      wl_output* output,
+                                      int32_t scale)
+{
+    Q_UNUSED(output);
+    static_cast<Output*>(data)->scale = scale;
+}
+
+void WlrScreencopy::handleOutputName(void* data,
+                                     wl_output* output,
+                                     const char* name)
+{
+    Q_UNUSED(output);
+    static_cast<Output*>(data)->name = QString::fromUtf8(name);
+}
+
+void WlrScreencopy::handleOutputDescription(void* data,
+                                            wl_output* output,
+                                            const char* description)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(output);
+    Q_UNUSED(description);
+}
+
+void WlrScreencopy::handleFrameBuffer(void* data,
+                                      zwlr_screencopy_frame_v1* frame,
+                                      uint32_t format,
+                                      uint32_t width,
+                                      uint32_t height,
+                                      uint32_t stride)
+{
+    Q_UNUSED(frame);
+    auto* self = static_cast<Frame*>(data);
+    if (self->hasShmInfo) {
+        return;
+    }
+    if (imageFormat(format) != QImage::Format_Invalid) {
+        self->hasShmInfo = true;
+        self->format = format;
+        self->width = static_cast<int>(width);
+        self->height = static_cast<int>(height);
+        self->stride = static_cast<int>(stride);
+    }
+    // Version 3 announces the end of the buffer list with buffer_done, older
+    // versions only offer a single wl_shm buffer. Without a format that can
+    // be read the copy fails right away instead of waiting for the timeout.
+    if (self->owner->m_managerVersion < 3) {
+        self->owner->startCopy(self);
+    }
+}
+
+void WlrScreencopy::handleFrameFlags(void* data,
+                                     zwlr_screencopy_frame_v1* frame,
+                                     uint32_t flags)
+{
+    Q_UNUSED(frame);
+    static_cast<Frame*>(data)->flags = flags;
+}
+
+void WlrScreencopy::handleFrameReady(void* data,
+                                     zwlr_screencopy_frame_v1* frame,
+                                     uint32_t tvSecHi,
+                                     uint32_t tvSecLo,
+                                     uint32_t tvNsec)
+{
+    Q_UNUSED(frame);
+    Q_UNUSED(tvSecHi);
+    Q_UNUSED(tvSecLo);
+    Q_UNUSED(tvNsec);
+    static_cast<Frame*>(data)->state = Frame::READY;
+}
+
+void WlrScreencopy::handleFrameFailed(void* data,
+                                      zwlr_screencopy_frame_v1* frame)
+{
+    Q_UNUSED(frame);
+    static_cast<Frame*>(data)->state = Frame::FAILED;
+}
+
+void WlrScreencopy::handleFrameDamage(void* data,
+                                      zwlr_screencopy_frame_v1* frame,
+                                      uint32_t x,
+                                      uint32_t y,
+                                      uint32_t width,
+                                      uint32_t height)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(frame);
+    Q_UNUSED(x);
+    Q_UNUSED(y);
+    Q_UNUSED(width);
+    Q_UNUSED(height);
+}
+
+void WlrScreencopy::handleFrameLinuxDmabuf(void* data,
+                                           zwlr_screencopy_frame_v1* frame,
+                                           uint32_t format,
+                                           uint32_t width,
+                                           uint32_t height)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(frame);
+    Q_UNUSED(format);
+    Q_UNUSED(width);
+    Q_UNUSED(height);
+}
+
+void WlrScreencopy::handleFrameBufferDone(void* data,
+                                          zwlr_screencopy_frame_v1* frame)
+{
+    Q_UNUSED(frame);
+    auto* self = static_cast<Frame*>(data);
+    self->owner->startCopy(self);
+}
@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QImage>
+#include <QList>
+#include <QObject>
+#include <QPoint>
+#include <QRect>
+#include <QSize>
+#include <QString>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+struct wl_buffer;
+struct wl_display;
+struct wl_output;
+struct wl_registry;
+struct wl_shm;
+struct zwlr_screencopy_frame_v1;
+struct zwlr_screencopy_manager_v1;
+
+/**
+ * @brief Native screen capture for wlroots based compositors.
+ *
+ * Talks `zwlr_screencopy_manager_v1` directly on a private Wayland connection
+ * instead of spawning `grim`. The connection and the `wl_shm` buffers the
+ * compositor copies into are kept alive and reused by the following captures,
+ * so a capture costs one copy from shared memory into the resulting image.
+ */
+class WlrScreencopy : public QObject
+{
+    Q_OBJECT
+
+public:
+    static WlrScreencopy* instance();
+    ~WlrScreencopy() override;
+
+    bool isAvailable();
+    // Capture the area covered by all outputs
+    QImage grabDesktop(bool& ok);
+    // Capture `region`, given in logical compositor coordinates
+    QImage grabRegion(const QRect& region, bool& ok);
+
+public slots:
+    void releaseBuffers();
+
+private:
+    struct Output
+    {
+        uint32_t globalName = 0;
+        wl_output* output = nullptr;
+        QString name;
+        QPoint position;
+        QSize modeSize;
+        int32_t transform = 0;
+        int32_t scale = 1;
+    };
+
+    struct ShmBuffer
+    {
+        wl_buffer* buffer = nullptr;
+        void* data = nullptr;
+        size_t size = 0;
+        uint32_t format = 0;
+        int width = 0;
+        int height = 0;
+        int stride = 0;
+        bool busy = false;
+    };
+
+    struct Frame
+    {
+        enum State
+        {
+            PENDING,
+            READY,
+            FAILED
+        };
+
+        WlrScreencopy* owner = nullptr;
+        zwlr_screencopy_frame_v1* frame = nullptr;
+        // wl_output transform of the captured output
+        int32_t transform = 0;
+        // Captured area in logical compositor coordinates
+        QRect logicalRect;
+        ShmBuffer* buffer = nullptr;
+        uint32_t format = 0;
+        int width = 0;
+        int height = 0;
+        int stride = 0;
+        bool hasShmInfo = false;
+        bool copyRequested = false;
+        uint32_t flags = 0;
+        State state = PENDING;
+    };
+
+    explicit WlrScreencopy(QObject* parent);
+
+    bool connectToDisplay();
+    void disconnectFromDisplay();
+    bool dispatchUntil(const std::function<bool()>& done, int timeoutMs);
+    QRect logicalGeometry(const Output* output) const;
+    ShmBuffer* acquireBuffer(const Frame& frame);
+    ShmBuffer* createBuffer(const Frame& frame);
+    void destroyBuffer(ShmBuffer* buffer);
+    void startCopy(Frame* frame);
+    QImage assemble(const QList<Frame*>& frames, const QRect& region);
+
+    static QImage::Format imageFormat(uint32_t shmFormat);
+
+    static void handleGlobal(void* data,
+                             wl_registry* registry,
+                             uint32_t name,
+                             const char* interface,
+                             uint32_t version);
+    static void handleGlobalRemove(void* data,
+                                   wl_registry* registry,
+                                   uint32_t name);
+    static void handleOutputGeometry(void* data,
+                                     wl_output* output,
+                                     int32_t x,
+                                     int32_t y,
+                                     int32_t physicalWidth,
+                                     int32_t physicalHeight,
+                                     int32_t subpixel,
+                                     const char* make,
+                                     const char* model,
+                                     int32_t transform);
+    static void handleOutputMode(void* data,
+                                 wl_output* output,
+                                 uint32_t flags,
+                                 int32_t width,
+                                 int32_t height,
+                                 int32_t refresh);
+    static void handleOutputDone(void* data, wl_output* output);
+    static void handleOutputScale(void* data, wl_output* output, int32_t scale);
+    static void handleOutputName(void* data,
+                                 wl_output* output,
+                                 const char* name);
+    static void handleOutputDescription(void* data,
+                                        wl_output* output,
+                                        const char* description);
+    static void handleFrameBuffer(void* data,
+                                  zwlr_screencopy_frame_v1* frame,
+                                  uint32_t format,
+                                  uint32_t width,
+                                  uint32_t height,
+                                  uint32_t stride);
+    static void handleFrameFlags(void* data,
+                                 zwlr_screencopy_frame_v1* frame,
+                                 uint32_t flags);
+    static void handleFrameReady(void* data,
+                                 zwlr_screencopy_frame_v1* frame,
+                                 uint32_t tvSecHi,
+                                 uint32_t tvSecLo,
+                                 uint32_t tvNsec);
+    static void handleFrameFailed(void* data, zwlr_screencopy_frame_v1* frame);
+    static void handleFrameDamage(void* data,
+                                  zwlr_screencopy_frame_v1* frame,
+                                  uint32_t x,
+                                  uint32_t y,
+                                  uint32_t width,
+                                  uint32_t height);
+    static void handleFrameLinuxDmabuf(void* data,
+                                       zwlr_screencopy_frame_v1* frame,
+                                       uint32_t format,
+                                       uint32_t width,
+                                       uint32_t height);
+    static void handleFrameBufferDone(void* data,
+                                      zwlr_screencopy_frame_v1* frame);
+
+    wl_display* m_display;
+    wl_registry* m_registry;
+    wl_shm* m_shm;
+    zwlr_screencopy_manager_v1* m_manager;
+    uint32_t m_managerVersion;
+    QList<Output*> m_outputs;
+    QList<ShmBuffer*> m_buffers;
+};
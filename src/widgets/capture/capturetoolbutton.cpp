@@ -3,6 +3,7 @@
 
 #include "capturetoolbutton.h"
 #include "src/tools/capturetool.h"
+#include "src/tools/iconatlas.h"
 #include "src/tools/toolfactory.h"
 #include "src/utils/colorutils.h"
 #include "src/utils/confighandler.h"
@@ -78,7 +79,8 @@ void CaptureToolButton::initButton()
 void CaptureToolButton::updateIcon()
 {
     setIcon(icon());
-    setIconSize(size() * 0.6);
+    setIconSize(
+      QSize(IconAtlas::buttonIconSize(), IconAtlas::buttonIconSize()));
 }
 
 const QList<CaptureTool::Type>& CaptureToolButton::getIterableButtonTypes()
@@ -89,7 +91,8 @@ const QList<CaptureTool::Type>& CaptureToolButton::getIterableButtonTypes()
 // get icon returns the icon for the type of button
 QIcon CaptureToolButton::icon() const
 {
-    return m_tool->icon(m_mainColor, true);
+    return IconAtlas::instance()->icon(
+      m_tool, m_mainColor, IconAtlas::buttonIconSize(), devicePixelRatioF());
 }
 
 void CaptureToolButton::mousePressEvent(QMouseEvent* e)
@@ -154,6 +157,7 @@ static std::map<CaptureTool::Type, int> buttonTypeOrder
 
       { CaptureTool::TYPE_SIZEINCREASE, 22 },
       { CaptureTool::TYPE_SIZEDECREASE, 23 },
+      { CaptureTool::TYPE_SCROLLCAPTURE, 24 },
 };
 
 int CaptureToolButton::getPriorityByButton(CaptureTool::Type b)
@@ -181,4 +185,5 @@ QList<CaptureTool::Type> CaptureToolButton::iterableButtonTypes = {
 #endif
     CaptureTool::TYPE_PIN,           CaptureTool::TYPE_SIZEINCREASE,
     CaptureTool::TYPE_SIZEDECREASE,  CaptureTool::TYPE_ACCEPT,
+    CaptureTool::TYPE_SCROLLCAPTURE,
 };
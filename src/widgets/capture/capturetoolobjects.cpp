@@ -2,6 +2,8 @@
 // SPDX-FileCopyrightText: 2021 Yurii Puchkov & Contributors
 
 #include "capturetoolobjects.h"
+#include "src/tools/annotationrenderer.h"
+#include "src/tools/toolfactory.h"
 
 #define SEARCH_RADIUS_NEAR 3
 #define SEARCH_RADIUS_FAR 5
@@ -14,8 +16,10 @@ CaptureToolObjects::CaptureToolObjects(QObject* parent)
 void CaptureToolObjects::append(const QPointer<CaptureTool>& captureTool)
 {
     if (!captureTool.isNull()) {
-        m_captureToolObjects.append(captureTool->copy(captureTool->parent()));
-        m_imageCache.clear();
+        auto annotation = captureTool->annotation();
+        if (annotation) {
+            m_annotations.append(*annotation);
+        }
     }
 }
 
@@ -23,94 +27,156 @@ void CaptureToolObjects::insert(int index,
                                 const QPointer<CaptureTool>& captureTool)
 {
     if (!captureTool.isNull() && index >= 0 &&
-        index <= m_captureToolObjects.size()) {
-        m_captureToolObjects.insert(index,
-                                    captureTool->copy(captureTool->parent()));
-        m_imageCache.clear();
+        index <= m_annotations.size()) {
+        auto annotation = captureTool->annotation();
+        if (annotation) {
+            syncEditors();
+            m_annotations.insert(index, *annotation);
+            for (Binding* binding : { &m_lent, &m_edited }) {
+                if (binding->index >= index) {
+                    ++binding->index;
+                }
+            }
+        }
+    }
+}
+
+void CaptureToolObjects::move(int from, int to)
+{
+    if (from < 0 || from >= m_annotations.size() || to < 0 ||
+        to >= m_annotations.size() || from == to) {
+        return;
+    }
+    syncEditors();
+    m_annotations.move(from, to);
+    // the bound editors follow their elements
+    for (Binding* binding : { &m_lent, &m_edited }) {
+        if (binding->index == from) {
+            binding->index = to;
+        } else if (from < binding->index && binding->index <= to) {
+            --binding->index;
+        } else if (to <= binding->index && binding->index < from) {
+            ++binding->index;
+        }
     }
 }
 
 QPointer<CaptureTool> CaptureToolObjects::at(int index)
 {
-    if (index >= 0 && index < m_captureToolObjects.size()) {
-        return m_captureToolObjects[index];
+    if (index < 0 || index >= m_annotations.size()) {
+        return nullptr;
+    }
+    if (!m_edited.tool.isNull() && m_edited.index == index) {
+        return m_edited.tool;
+    }
+    if (!m_lent.tool.isNull() && m_lent.index == index) {
+        return m_lent.tool;
+    }
+    syncEditors();
+    releaseLent();
+    const Annotation& annotation = m_annotations.at(index);
+    m_lent.tool =
+      ToolFactory().CreateTool(AnnotationRenderer::toolType(annotation), this);
+    if (!m_lent.tool.isNull()) {
+        m_lent.tool->setAnnotation(annotation);
+        m_lent.index = index;
     }
-    return nullptr;
+    return m_lent.tool;
+}
+
+CaptureTool* CaptureToolObjects::edit(int index, QObject* owner)
+{
+    finishEdit();
+    if (at(index).isNull()) {
+        return nullptr;
+    }
+    m_edited = m_lent;
+    m_lent = Binding();
+    m_edited.tool->setParent(owner);
+    return m_edited.tool;
+}
+
+void CaptureToolObjects::finishEdit()
+{
+    syncEditors();
+    m_edited = Binding();
 }
 
 void CaptureToolObjects::clear()
 {
-    m_captureToolObjects.clear();
+    releaseLent();
+    m_edited = Binding();
+    m_annotations.clear();
 }
 
-QList<QPointer<CaptureTool>> CaptureToolObjects::captureToolObjects()
+QList<Annotation> CaptureToolObjects::annotations() const
 {
-    return m_captureToolObjects;
+    syncEditors();
+    return m_annotations;
 }
 
 int CaptureToolObjects::size()
 {
-    return m_captureToolObjects.size();
+    return m_annotations.size();
 }
 
 void CaptureToolObjects::removeAt(int index)
 {
-    if (index >= 0 && index < m_captureToolObjects.size()) {
-        m_captureToolObjects.removeAt(index);
-        m_imageCache.clear();
+    if (index >= 0 && index < m_annotations.size()) {
+        syncEditors();
+        if (m_lent.index == index) {
+            releaseLent();
+        }
+        if (m_edited.index == index) {
+            // still owned by the caller, it just isn't written back anymore
+            m_edited = Binding();
+        }
+        for (Binding* binding : { &m_lent, &m_edited }) {
+            if (binding->index > index) {
+                --binding->index;
+            }
+        }
+        m_annotations.removeAt(index);
     }
 }
 
-int CaptureToolObjects::find(const QPoint& pos, QSize captureSize)
+void CaptureToolObjects::renumberCircleCounts(int removedCount)
 {
-    if (m_captureToolObjects.empty()) {
+    syncEditors();
+    for (auto& annotation : m_annotations) {
+        auto* circle = std::get_if<CircleCountAnnotation>(&annotation);
+        if (circle != nullptr && circle->count >= removedCount) {
+            --circle->count;
+        }
+    }
+    for (const Binding* binding : { &m_lent, &m_edited }) {
+        if (!binding->tool.isNull()) {
+            binding->tool->setAnnotation(m_annotations.at(binding->index));
+        }
+    }
+}
+
+int CaptureToolObjects::find(const QPoint& pos)
+{
+    if (m_annotations.empty()) {
         return -1;
     }
-    QPixmap pixmap(captureSize);
-    pixmap.fill(Qt::transparent);
-    QPainter painter(&pixmap);
+    syncEditors();
     // first attempt to find at exact position
-    int radius = SEARCH_RADIUS_NEAR;
-    int index = findWithRadius(painter, pixmap, pos, radius);
+    int index = findWithRadius(pos, SEARCH_RADIUS_NEAR);
     if (-1 == index) {
         // second attempt to find at position with radius
-        radius = SEARCH_RADIUS_FAR;
-        pixmap.fill(Qt::transparent);
-        index = findWithRadius(painter, pixmap, pos, radius);
+        index = findWithRadius(pos, SEARCH_RADIUS_FAR);
     }
     return index;
 }
 
-int CaptureToolObjects::findWithRadius(QPainter& painter,
-                                       QPixmap& pixmap,
-                                       const QPoint& pos,
-                                       int radius)
+int CaptureToolObjects::findWithRadius(const QPoint& pos, int radius)
 {
-    int index = m_captureToolObjects.size() - 1;
-    bool useCache = true;
-    m_imageCache.clear();
-    if (m_imageCache.size() != m_captureToolObjects.size() && index >= 0) {
-        // TODO - is not optimal and cache will be used just after first tool
-        // object selecting
-        m_imageCache.clear();
-        useCache = false;
-    }
-    for (; index >= 0; --index) {
+    for (int index = m_annotations.size() - 1; index >= 0; --index) {
         int currentRadius = radius;
-        QImage image;
-        auto toolItem = m_captureToolObjects.at(index);
-        if (useCache) {
-            image = m_imageCache.at(index);
-        } else {
-            // create transparent image in memory and draw toolItem on it
-            toolItem->drawSearchArea(painter, pixmap);
-
-            // get color at mouse clicked position in area +/- currentRadius
-            image = pixmap.toImage();
-            m_imageCache.insert(0, image);
-        }
-
-        if (toolItem->type() == CaptureTool::TYPE_TEXT) {
+        const Annotation& annotation = m_annotations.at(index);
+        if (std::holds_alternative<TextAnnotation>(annotation)) {
             if (currentRadius > SEARCH_RADIUS_NEAR) {
                 // Text already has a big currentRadius and no need to search
                 // with a bit bigger currentRadius than
@@ -122,41 +188,43 @@ int CaptureToolObjects::findWithRadius(QPainter& painter,
             // text objects search
             currentRadius += SEARCH_RADIUS_TEXT_HANDICAP;
         }
-
-        for (int x = pos.x() - currentRadius; x <= pos.x() + currentRadius;
-             ++x) {
-            for (int y = pos.y() - currentRadius; y <= pos.y() + currentRadius;
-                 ++y) {
-                QRgb rgb = image.pixel(x, y);
-                if (rgb != 0) {
-                    // object was found, return it index (layer index)
-                    return index;
-                }
-            }
+        if (AnnotationRenderer::hitTest(annotation, pos, currentRadius)) {
+            // object was found, return it index (layer index)
+            return index;
         }
     }
     // no object at current pos found
     return -1;
 }
 
-CaptureToolObjects& CaptureToolObjects::operator=(
-  const CaptureToolObjects& other)
+void CaptureToolObjects::syncEditors() const
 {
-    // remove extra items for this if size is bigger
-    while (this->m_captureToolObjects.size() >
-           other.m_captureToolObjects.size()) {
-        this->m_captureToolObjects.removeLast();
+    for (const Binding* binding : { &m_lent, &m_edited }) {
+        if (binding->tool.isNull() || binding->index < 0 ||
+            binding->index >= m_annotations.size()) {
+            continue;
+        }
+        auto annotation = binding->tool->annotation();
+        if (annotation) {
+            m_annotations[binding->index] = *annotation;
+        }
     }
+}
 
-    int count = 0;
-    for (const auto& item : other.m_captureToolObjects) {
-        QPointer<CaptureTool> itemCopy = item->copy(item->parent());
-        if (count < this->m_captureToolObjects.size()) {
-            this->m_captureToolObjects[count] = itemCopy;
-        } else {
-            this->m_captureToolObjects.append(itemCopy);
-        }
-        count++;
+void CaptureToolObjects::releaseLent()
+{
+    // Deleted right away, at() doesn't let the callers keep it
+    delete m_lent.tool;
+    m_lent = Binding();
+}
+
+CaptureToolObjects& CaptureToolObjects::operator=(
+  const CaptureToolObjects& other)
+{
+    if (this != &other) {
+        m_annotations = other.annotations();
+        releaseLent();
+        m_edited = Binding();
     }
     return *this;
 }
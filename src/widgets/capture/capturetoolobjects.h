@@ -4,33 +4,54 @@
 #ifndef FLAMESHOT_CAPTURETOOLOBJECTS_H
 #define FLAMESHOT_CAPTURETOOLOBJECTS_H
 
+#include "src/tools/annotation.h"
 #include "src/tools/capturetool.h"
 #include <QList>
 #include <QPointer>
 
+// Layers drawn on the capture, stored as plain annotation values so that
+// copies (e.g. for the undo stack) only share the underlying list. Tools
+// editing an element are bound to it and write their changes back to it.
 class CaptureToolObjects : public QObject
 {
 public:
     explicit CaptureToolObjects(QObject* parent = nullptr);
-    QList<QPointer<CaptureTool>> captureToolObjects();
+    QList<Annotation> annotations() const;
     void append(const QPointer<CaptureTool>& captureTool);
     void insert(int index, const QPointer<CaptureTool>& captureTool);
+    void move(int from, int to);
     void removeAt(int index);
     void clear();
     int size();
-    int find(const QPoint& pos, QSize captureSize);
+    int find(const QPoint& pos);
+    // The tool is owned by the list and deleted when another element is
+    // bound or the list changes, it must not be kept.
     QPointer<CaptureTool> at(int index);
+    // The tool is handed over to `owner`, which deletes it. It writes its
+    // changes to the element until finishEdit() or the element is removed.
+    CaptureTool* edit(int index, QObject* owner);
+    void finishEdit();
+    // Decrement the circle counters numbered after a removed one
+    void renumberCircleCounts(int removedCount);
     CaptureToolObjects& operator=(const CaptureToolObjects& other);
 
 private:
-    int findWithRadius(QPainter& painter,
-                       QPixmap& pixmap,
-                       const QPoint& pos,
-                       int radius = 0);
+    struct Binding
+    {
+        QPointer<CaptureTool> tool;
+        int index = -1;
+    };
+
+    int findWithRadius(const QPoint& pos, int radius);
+    void syncEditors() const;
+    void releaseLent();
 
     // class members
-    QList<QPointer<CaptureTool>> m_captureToolObjects;
-    QVector<QImage> m_imageCache;
+    mutable QList<Annotation> m_annotations;
+    // Handed out by at(), owned by the list
+    Binding m_lent;
+    // Handed out by edit(), owned by the caller
+    Binding m_edited;
 };
 
 #endif // FLAMESHOT_CAPTURETOOLOBJECTS_H
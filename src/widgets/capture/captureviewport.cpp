@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "captureviewport.h"
+#include <QRectF>
+#include <QtMath>
+
+namespace {
+
+// Zooming through 100% snaps to it, it is the only scale without resampling
+const qreal SNAP_DISTANCE = 0.02;
+
+} // unnamed namespace
+
+qreal CaptureViewport::zoom() const
+{
+    return m_zoom;
+}
+
+QPointF CaptureViewport::pan() const
+{
+    return m_pan;
+}
+
+bool CaptureViewport::isIdentity() const
+{
+    return m_zoom == 1.0 && m_pan.isNull();
+}
+
+QTransform CaptureViewport::transform() const
+{
+    return QTransform(m_zoom, 0, 0, m_zoom, m_pan.x(), m_pan.y());
+}
+
+QPoint CaptureViewport::toImage(const QPoint& point) const
+{
+    if (isIdentity()) {
+        return point;
+    }
+    return ((QPointF(point) - m_pan) / m_zoom).toPoint();
+}
+
+QRect CaptureViewport::toImage(const QRect& rect) const
+{
+    if (isIdentity() || rect.isNull()) {
+        return rect;
+    }
+    return QRectF((QPointF(rect.topLeft()) - m_pan) / m_zoom,
+                  QSizeF(rect.size()) / m_zoom)
+      .toAlignedRect();
+}
+
+QPoint CaptureViewport::toWidget(const QPoint& point) const
+{
+    if (isIdentity()) {
+        return point;
+    }
+    return (QPointF(point) * m_zoom + m_pan).toPoint();
+}
+
+QRect CaptureViewport::toWidget(const QRect& rect) const
+{
+    if (isIdentity() || rect.isNull()) {
+        return rect;
+    }
+    return QRectF(QPointF(rect.topLeft()) * m_zoom + m_pan,
+                  QSizeF(rect.size()) * m_zoom)
+      .toAlignedRect();
+}
+
+QRegion CaptureViewport::toWidget(const QRegion& region) const
+{
+    if (isIdentity()) {
+        return region;
+    }
+    QRegion mapped;
+    for (const QRect& rect : region) {
+        mapped += toWidget(rect);
+    }
+    return mapped;
+}
+
+void CaptureViewport::zoomAt(const QPointF& anchor, qreal factor)
+{
+    qreal zoom = qBound(MIN_ZOOM, m_zoom * factor, MAX_ZOOM);
+    if ((m_zoom - 1.0) * (zoom - 1.0) <= 0 ||
+        qAbs(zoom - 1.0) < SNAP_DISTANCE) {
+        zoom = m_zoom == 1.0 ? zoom : 1.0;
+    }
+    const QPointF imagePoint = (anchor - m_pan) / m_zoom;
+    m_zoom = zoom;
+    m_pan = anchor - imagePoint * m_zoom;
+}
+
+void CaptureViewport::panBy(const QPointF& delta)
+{
+    m_pan += delta;
+}
+
+void CaptureViewport::reset()
+{
+    m_zoom = 1.0;
+    m_pan = QPointF();
+}
+
+void CaptureViewport::constrain(const QSizeF& image, const QSizeF& widget)
+{
+    const qreal width = image.width() * m_zoom;
+    const qreal height = image.height() * m_zoom;
+    m_pan.setX(width >= widget.width()
+                 ? qBound(widget.width() - width, m_pan.x(), 0.0)
+                 : qBound(0.0, m_pan.x(), widget.width() - width));
+    m_pan.setY(height >= widget.height()
+                 ? qBound(widget.height() - height, m_pan.y(), 0.0)
+                 : qBound(0.0, m_pan.y(), widget.height() - height));
+    // Rounding of the bounds must not keep a pan at 100%
+    if (m_zoom == 1.0 && qAbs(m_pan.x()) < 0.5 && qAbs(m_pan.y()) < 0.5) {
+        m_pan = QPointF();
+    }
+}
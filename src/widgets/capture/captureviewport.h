@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QPoint>
+#include <QPointF>
+#include <QRect>
+#include <QRegion>
+#include <QSize>
+#include <QTransform>
+
+/**
+ * @brief Zoom and pan of the capture in CaptureWidget.
+ *
+ * Maps the image space, the logical coordinates of the capture that the
+ * tools and annotations use, to the widget space where the capture is shown
+ * and the mouse events come from. At 100% without pan both are the same.
+ */
+class CaptureViewport
+{
+public:
+    static constexpr qreal MIN_ZOOM = 0.25;
+    static constexpr qreal MAX_ZOOM = 8.0;
+
+    qreal zoom() const;
+    QPointF pan() const;
+    bool isIdentity() const;
+
+    // From image to widget space
+    QTransform transform() const;
+
+    QPoint toImage(const QPoint& point) const;
+    QRect toImage(const QRect& rect) const;
+    QPoint toWidget(const QPoint& point) const;
+    QRect toWidget(const QRect& rect) const;
+    QRegion toWidget(const QRegion& region) const;
+
+    // Zoom by `factor`, the image point under `anchor` stays in place
+    void zoomAt(const QPointF& anchor, qreal factor);
+    void panBy(const QPointF& delta);
+    void reset();
+    // Keeps the image covering the widget, or within it when smaller
+    void constrain(const QSizeF& image, const QSizeF& widget);
+
+private:
+    qreal m_zoom = 1.0;
+    QPointF m_pan;
+};
@@ -14,11 +14,17 @@
 #include "copytool.h"
 #include "src/config/cacheutils.h"
 #include "src/core/flameshot.h"
+#include "src/core/metrics.h"
 #include "src/core/qguiappcurrentscreen.h"
+#include "src/tools/annotationrenderer.h"
+#include "src/utils/blendkernels.h"
+#include "src/utils/bufferpool.h"
 #include "src/utils/screengrabber.h"
 #include "src/utils/screenshotsaver.h"
 #include "src/utils/systemnotification.h"
+#include "src/utils/textregions.h"
 #include "src/widgets/capture/colorpicker.h"
+#include "src/widgets/capture/framecompositor.h"
 #include "src/widgets/capture/hovereventfilter.h"
 #include "src/widgets/capture/modificationcommand.h"
 #include "src/widgets/capture/notifierbox.h"
@@ -35,6 +41,10 @@
 #include <QPainter>
 #include <QScreen>
 #include <QShortcut>
+#include <QThreadPool>
+#include <cmath>
+#include <cstring>
+#include <utility>
 #include <draggablewidgetmaker.h>
 
 #if !defined(DISABLE_UPDATE_CHECKER)
@@ -42,6 +52,10 @@
 #endif
 
 #define MOUSE_DISTANCE_TO_START_MOVING 3
+// Time the search for text may take, the rest of the capture is skipped
+#define TEXT_DETECTION_BUDGET_MS 250
+// Zoom factor of a notch of the mouse wheel with Ctrl held
+#define ZOOM_STEP 1.25
 
 // CaptureWidget is the main component used to capture the screen. It contains
 // an area of selection with its respective buttons.
@@ -81,6 +95,12 @@ CaptureWidget::CaptureWidget(const CaptureRequest& req,
     m_undoStack.setUndoLimit(ConfigHandler().undoLimit());
     m_context.circleCount = 1;
 
+    m_compositor = new FrameCompositor(this);
+    connect(m_compositor,
+            &FrameCompositor::frameReady,
+            this,
+            &CaptureWidget::applyFrame);
+
     // Base config of the widget
     m_eventFilter = new HoverEventFilter(this);
     connect(m_eventFilter,
@@ -108,7 +128,10 @@ CaptureWidget::CaptureWidget(const CaptureRequest& req,
     if (fullScreen) {
         // Grab Screenshot
         bool ok = true;
-        m_context.screenshot = ScreenGrabber().grabEntireDesktop(ok);
+        {
+            Metrics::Timer timer(Metrics::GRAB);
+            m_context.screenshot = ScreenGrabber().grabEntireDesktop(ok);
+        }
         if (!ok) {
             AbstractLogger::error() << tr("Unable to capture screen");
             this->close();
@@ -230,7 +253,8 @@ CaptureWidget::CaptureWidget(const CaptureRequest& req,
             &ColorPicker::colorSelected,
             this,
             [this](const QColor& c) {
-                m_context.mousePos = mapFromGlobal(QCursor::pos());
+                m_context.mousePos =
+                  m_viewport.toImage(mapFromGlobal(QCursor::pos()));
                 setDrawColor(c);
             });
     m_colorPicker->hide();
@@ -286,6 +310,10 @@ CaptureWidget::CaptureWidget(const CaptureRequest& req,
 
     initQuitPrompt();
 
+    if (m_context.fullscreen && m_config.suggestRedactions()) {
+        startTextDetection();
+    }
+
     updateCursor();
 }
 
@@ -302,15 +330,28 @@ CaptureWidget::~CaptureWidget()
         }
     }
 #endif
-    if (m_captureDone) {
-        auto lastRegion = m_selection->geometry();
+    if (m_captureDone && !m_regions.isEmpty()) {
+        if (m_selection->isVisibleTo(this)) {
+            m_regions.append(selectionRect().normalized());
+        }
+        QList<QRect> regions;
+        for (const QRect& region : std::as_const(m_regions)) {
+            regions.append(extendedRect(region.intersected(imageRect())));
+        }
+        QRect geometry(regions.first());
+        geometry.moveTopLeft(geometry.topLeft() + m_context.widgetOffset);
+        syncFrame();
+        Flameshot::instance()->exportRegions(
+          m_context.screenshot, regions, geometry, m_context.request);
+    } else if (m_captureDone) {
+        auto lastRegion = selectionRect();
         setLastRegion(lastRegion);
         QRect geometry(m_context.selection);
         geometry.setTopLeft(geometry.topLeft() + m_context.widgetOffset);
         Flameshot::instance()->exportCapture(
           pixmap(), geometry, m_context.request);
     } else {
-        emit Flameshot::instance()->captureFailed();
+        Flameshot::instance()->reportCaptureFailed(m_context.request);
     }
 }
 
@@ -472,6 +513,10 @@ void CaptureWidget::initHelpMessage()
     keyMap << std::pair(tr("Right Click"), tr("Show color picker"));
     keyMap << std::pair(ConfigHandler().shortcut("TYPE_TOGGLE_PANEL"),
                         tr("Open side panel"));
+    QString addRegionShortcut = ConfigHandler().shortcut("TYPE_ADD_REGION");
+    if (!addRegionShortcut.isEmpty()) {
+        keyMap << std::pair(addRegionShortcut, tr("Select another region"));
+    }
     keyMap << std::pair(tr("Esc"), tr("Exit"));
 
     m_helpMessage = OverlayMessage::compileFromKeyMap(keyMap);
@@ -479,6 +524,7 @@ void CaptureWidget::initHelpMessage()
 
 QPixmap CaptureWidget::pixmap()
 {
+    syncFrame();
     return m_context.selectedScreenshotArea();
 }
 
@@ -487,7 +533,6 @@ QPixmap CaptureWidget::pixmap()
 bool CaptureWidget::commitCurrentTool()
 {
     if (m_activeTool) {
-        processPixmapWithTool(&m_context.screenshot, m_activeTool);
         if (m_activeTool->isValid() && !m_activeTool->editMode() &&
             m_toolWidget) {
             pushToolToStack();
@@ -575,15 +620,14 @@ void CaptureWidget::releaseActiveTool()
 {
     if (m_activeTool) {
         if (m_activeTool->editMode()) {
-            // Object shouldn't be deleted here because it is in the undo/redo
-            // stack, just set current pointer to null
+            // The edited object writes its last changes back to its layer
             m_activeTool->setEditMode(false);
+            m_captureToolObjects.finishEdit();
             if (m_activeTool->isChanged()) {
                 pushObjectsStateToUndoStack();
             }
-        } else {
-            delete m_activeTool;
         }
+        delete m_activeTool;
         m_activeTool = nullptr;
     }
     if (m_toolWidget) {
@@ -642,8 +686,13 @@ void CaptureWidget::closeEvent(QCloseEvent* event)
 
 void CaptureWidget::paintEvent(QPaintEvent* paintEvent)
 {
-    Q_UNUSED(paintEvent)
     QPainter painter(this);
+    if (!m_viewport.isIdentity()) {
+        // Around a zoomed out capture
+        painter.fillRect(paintEvent->rect(), Qt::black);
+        // From here on everything is drawn in image space
+        painter.setTransform(m_viewport.transform());
+    }
     GeneralConf::xywh_position position =
       static_cast<GeneralConf::xywh_position>(m_config.showSelectionGeometry());
     /* QPainter::save and restore is somewhat costly so we try to guess
@@ -656,15 +705,22 @@ void CaptureWidget::paintEvent(QPaintEvent* paintEvent)
     bool save = false;
     if (m_xywhDisplay ||                           // clause 1: xywh display
         m_displayGrid ||                           // clause 2: display grid
-        (m_activeTool && m_mouseIsClicked) ||      // clause 3: tool/click
-        (m_previewEnabled && activeButtonTool() && // clause 4: mouse preview
+        (m_previewEnabled && activeButtonTool() && // clause 3: mouse preview
          m_activeButton->tool()->showMousePreview())) {
         painter.save();
         save = true;
     }
-    painter.drawPixmap(0, 0, m_context.screenshot);
+    if (m_viewport.isIdentity()) {
+        painter.drawPixmap(0, 0, m_context.screenshot);
+    } else {
+        m_mipTiles.setSource(m_context.screenshot);
+        m_mipTiles.draw(painter,
+                        m_viewport.toImage(paintEvent->rect()),
+                        m_viewport.zoom() * devicePixelRatioF() /
+                          m_context.screenshot.devicePixelRatio());
+    }
     if (m_selection && m_xywhDisplay) {
-        const QRect& selection = m_selection->geometry().normalized();
+        const QRect selection = selectionRect().normalized();
         const qreal scale = m_context.screenshot.devicePixelRatio();
         QRect xybox;
         QFontMetrics fm = painter.fontMetrics();
@@ -747,17 +803,19 @@ void CaptureWidget::paintEvent(QPaintEvent* paintEvent)
         }
     }
 
-    if (m_activeTool && m_mouseIsClicked) {
-        m_activeTool->process(painter, m_context.screenshot);
-    } else if (m_previewEnabled && activeButtonTool() &&
-               m_activeButton->tool()->showMousePreview()) {
+    // The object being drawn is part of the frame, see drawActiveTool()
+    if (!(m_activeTool && m_mouseIsClicked) && m_previewEnabled &&
+        activeButtonTool() && m_activeButton->tool()->showMousePreview()) {
         m_activeButton->tool()->paintMousePreview(painter, m_context);
     }
     if (save)
         painter.restore();
     // draw inactive region
     drawInactiveRegion(&painter);
+    drawRegions(&painter);
+    drawRedactionSuggestion(&painter);
 
+    painter.resetTransform();
     if (!isActiveWindow()) {
         drawErrorMessage(
           tr("Flameshot has lost focus. Keyboard shortcuts won't "
@@ -774,10 +832,11 @@ void CaptureWidget::paintEvent(QPaintEvent* paintEvent)
 
 void CaptureWidget::showColorPicker(const QPoint& pos)
 {
+    const QPoint widgetPos = m_viewport.toWidget(pos);
     // Try to select new object if current pos out of active object
     auto toolItem = activeToolObject();
     if (!toolItem || (toolItem && !toolItem->boundingRect().contains(pos))) {
-        selectToolItemAtPos(pos);
+        selectToolItemAtPos(widgetPos);
     }
 
     // save current state for undo/redo stack
@@ -786,8 +845,8 @@ void CaptureWidget::showColorPicker(const QPoint& pos)
     }
 
     // Call color picker
-    m_colorPicker->move(pos.x() - m_colorPicker->width() / 2,
-                        pos.y() - m_colorPicker->height() / 2);
+    m_colorPicker->move(widgetPos.x() - m_colorPicker->width() / 2,
+                        widgetPos.y() - m_colorPicker->height() / 2);
     m_colorPicker->raise();
     m_colorPicker->show();
 }
@@ -816,6 +875,7 @@ bool CaptureWidget::startDrawObjectTool(const QPoint& pos)
 
         m_context.mousePos = m_displayGrid ? snapToGrid(pos) : pos;
         m_activeTool->drawStart(m_context);
+        drawActiveTool();
         // TODO this is the wrong place to do this
 
         if (m_activeTool->type() == CaptureTool::TYPE_CIRCLECOUNT) {
@@ -834,19 +894,21 @@ void CaptureWidget::pushObjectsStateToUndoStack()
     m_captureToolObjectsBackup.clear();
 }
 
-int CaptureWidget::selectToolItemAtPos(const QPoint& pos)
+int CaptureWidget::selectToolItemAtPos(const QPoint& widgetPos)
 {
     // Try to select existing tool, "-1" - no active tool
     int activeLayerIndex = -1;
-    auto selectionMouseSide = m_selection->getMouseSide(pos);
+    // The selection widget works in widget space, the objects in image space
+    auto selectionMouseSide = m_selection->getMouseSide(widgetPos);
+    const QPoint pos = m_viewport.toImage(widgetPos);
     if (m_activeButton.isNull() &&
-        m_captureToolObjects.captureToolObjects().size() > 0 &&
+        m_captureToolObjects.size() > 0 &&
         (selectionMouseSide == SelectionWidget::NO_SIDE ||
          selectionMouseSide == SelectionWidget::CENTER)) {
         auto toolItem = activeToolObject();
         if (!toolItem ||
             (toolItem && !toolItem->boundingRect().contains(pos))) {
-            activeLayerIndex = m_captureToolObjects.find(pos, size());
+            activeLayerIndex = m_captureToolObjects.find(pos);
             int oldToolSize = m_context.toolSize;
             m_panel->setActiveLayer(activeLayerIndex);
             drawObjectSelection();
@@ -861,9 +923,16 @@ int CaptureWidget::selectToolItemAtPos(const QPoint& pos)
 void CaptureWidget::mousePressEvent(QMouseEvent* e)
 {
     activateWindow();
+    if (e->button() == Qt::MiddleButton) {
+        // Pan the zoomed capture
+        m_panning = true;
+        m_panLastPos = e->pos();
+        setCursor(Qt::ClosedHandCursor);
+        return;
+    }
     m_startMove = false;
     m_startMovePos = QPoint();
-    m_mousePressedPos = e->pos();
+    m_mousePressedPos = m_viewport.toImage(e->pos());
     m_activeToolOffsetToMouseOnStart = QPoint();
     if (m_colorPicker->isVisible()) {
         updateCursor();
@@ -898,7 +967,7 @@ void CaptureWidget::mousePressEvent(QMouseEvent* e)
         updateLayersPanel();
     }
 
-    selectToolItemAtPos(m_mousePressedPos);
+    selectToolItemAtPos(e->pos());
     updateSelectionState();
     updateCursor();
 }
@@ -910,7 +979,8 @@ void CaptureWidget::mouseDoubleClickEvent(QMouseEvent* event)
         // Start object editing
         auto activeTool = m_captureToolObjects.at(activeLayerIndex);
         if (activeTool && activeTool->type() == CaptureTool::TYPE_TEXT) {
-            m_activeTool = activeTool;
+            // The text being typed in belongs to this widget, like a new tool
+            m_activeTool = m_captureToolObjects.edit(activeLayerIndex, this);
             m_mouseIsClicked = false;
             m_context.mousePos = *m_activeTool->pos();
             m_captureToolObjectsBackup = m_captureToolObjects;
@@ -925,13 +995,16 @@ void CaptureWidget::mouseDoubleClickEvent(QMouseEvent* event)
     } else if (m_selection->geometry().contains(event->pos())) {
         if ((event->button() == Qt::LeftButton) &&
             (m_config.copyOnDoubleClick())) {
-            CopyTool copyTool;
-            connect(&copyTool,
-                    &CopyTool::requestAction,
-                    this,
-                    &CaptureWidget::handleToolSignal);
-            copyTool.pressed(m_context);
-            qApp->processEvents(QEventLoop::ExcludeUserInputEvents);
+            // Copies the capture with all the objects on it
+            afterFrame([this]() {
+                CopyTool copyTool;
+                connect(&copyTool,
+                        &CopyTool::requestAction,
+                        this,
+                        &CaptureWidget::handleToolSignal);
+                copyTool.pressed(m_context);
+                qApp->processEvents(QEventLoop::ExcludeUserInputEvents);
+            });
         }
     }
 }
@@ -947,8 +1020,18 @@ void CaptureWidget::mouseMoveEvent(QMouseEvent* e)
         }
     }
 
-    m_context.mousePos = e->pos();
+    if (m_panning) {
+        CaptureViewport viewport = m_viewport;
+        viewport.panBy(e->pos() - m_panLastPos);
+        m_panLastPos = e->pos();
+        setViewport(viewport);
+        return;
+    }
+
+    const QPoint pos = m_viewport.toImage(e->pos());
+    m_context.mousePos = pos;
     if (e->buttons() != Qt::LeftButton) {
+        updateHoveredSuggestion(pos);
         updateTool(activeButtonTool());
         updateCursor();
         return;
@@ -960,9 +1043,9 @@ void CaptureWidget::mouseMoveEvent(QMouseEvent* e)
         if (!m_startMove) {
             // Check for the minimal offset to start moving an object
             if (m_startMovePos.isNull()) {
-                m_startMovePos = e->pos();
+                m_startMovePos = pos;
             }
-            if ((e->pos() - m_startMovePos).manhattanLength() >
+            if ((pos - m_startMovePos).manhattanLength() >
                 MOUSE_DISTANCE_TO_START_MOVING) {
                 m_startMove = true;
             }
@@ -972,8 +1055,7 @@ void CaptureWidget::mouseMoveEvent(QMouseEvent* e)
               m_captureToolObjects.at(m_panel->activeLayerIndex());
             if (m_activeToolOffsetToMouseOnStart.isNull()) {
                 setCursor(Qt::ClosedHandCursor);
-                m_activeToolOffsetToMouseOnStart =
-                  e->pos() - *activeTool->pos();
+                m_activeToolOffsetToMouseOnStart = pos - *activeTool->pos();
             }
             if (!m_activeToolIsMoved) {
                 // save state before movement for undo stack
@@ -982,25 +1064,24 @@ void CaptureWidget::mouseMoveEvent(QMouseEvent* e)
             m_activeToolIsMoved = true;
             // update the old region of the selection, margins are added to
             // ensure selection outline is updated too
-            update(paddedUpdateRect(activeTool->boundingRect()));
-            activeTool->move(e->pos() - m_activeToolOffsetToMouseOnStart);
+            updateImageRect(paddedUpdateRect(activeTool->boundingRect()));
+            activeTool->move(pos - m_activeToolOffsetToMouseOnStart);
             drawToolsData();
         }
     } else if (m_activeTool) {
         // drawing with a tool
         if (m_adjustmentButtonPressed) {
-            m_activeTool->drawMoveWithAdjustment(e->pos());
+            m_activeTool->drawMoveWithAdjustment(pos);
         } else {
-            m_activeTool->drawMove(m_displayGrid ? snapToGrid(e->pos())
-                                                 : e->pos());
+            m_activeTool->drawMove(m_displayGrid ? snapToGrid(pos) : pos);
         }
         // update drawing object
         updateTool(m_activeTool);
+        drawActiveTool();
         // Hides the buttons under the mouse. If the mouse leaves, it shows
         // them.
         if (m_buttonHandler->buttonsAreInside()) {
-            const bool containsMouse =
-              m_buttonHandler->contains(m_context.mousePos);
+            const bool containsMouse = m_buttonHandler->contains(e->pos());
             if (containsMouse) {
                 m_buttonHandler->hide();
             } else if (m_selection->isVisible()) {
@@ -1013,6 +1094,11 @@ void CaptureWidget::mouseMoveEvent(QMouseEvent* e)
 
 void CaptureWidget::mouseReleaseEvent(QMouseEvent* e)
 {
+    if (e->button() == Qt::MiddleButton && m_panning) {
+        m_panning = false;
+        updateCursor();
+        return;
+    }
     if (e->button() == Qt::LeftButton && m_colorPicker->isVisible()) {
         // Color picker
         if (m_colorPicker->isVisible() && m_panel->activeLayerIndex() >= 0 &&
@@ -1029,6 +1115,9 @@ void CaptureWidget::mouseReleaseEvent(QMouseEvent* e)
         if (m_activeTool) {
             // end draw/edit
             m_activeTool->drawEnd(m_context.mousePos);
+            if (!m_activeTool->isValid()) {
+                applyRedactionSuggestion();
+            }
             if (m_activeTool->isValid()) {
                 pushToolToStack();
             } else if (!m_toolWidget) {
@@ -1043,6 +1132,11 @@ void CaptureWidget::mouseReleaseEvent(QMouseEvent* e)
     }
     m_mouseIsClicked = false;
     m_activeToolIsMoved = false;
+    if (!m_activeArea.isNull()) {
+        // Still in the frame, but not committed to the objects: dropped, or
+        // text waiting to be typed in
+        drawActiveTool();
+    }
 
     updateSelectionState();
     updateCursor();
@@ -1073,6 +1167,12 @@ void CaptureWidget::setToolSize(int size)
 
 void CaptureWidget::keyPressEvent(QKeyEvent* e)
 {
+    if (e->key() == Qt::Key_0 && e->modifiers() == Qt::ControlModifier) {
+        // Back to the capture at 100%
+        setViewport(CaptureViewport());
+        return;
+    }
+
     // If the key is a digit, change the tool size
     bool ok;
     int digit = e->text().toInt(&ok);
@@ -1118,6 +1218,16 @@ void CaptureWidget::wheelEvent(QWheelEvent* e)
      * impossible to scroll. It's easier to calculate number of requests and do
      * not accept events faster that one in 200ms.
      * */
+    if (e->modifiers() & Qt::ControlModifier) {
+        // Zoom around the cursor, by a step for each notch of the wheel
+        const qreal notches = e->angleDelta().y() / 120.0;
+        if (notches != 0) {
+            CaptureViewport viewport = m_viewport;
+            viewport.zoomAt(e->position(), std::pow(ZOOM_STEP, notches));
+            setViewport(viewport);
+        }
+        return;
+    }
     int toolSizeOffset = 0;
     if (e->angleDelta().y() >= 60) {
         // mouse scroll (wheel) increment
@@ -1290,7 +1400,7 @@ void CaptureWidget::initPanel()
     m_panel->pushWidget(m_sidePanel);
 
     // Fill undo/redo/history list widget
-    m_panel->fillCaptureTools(m_captureToolObjects.captureToolObjects());
+    m_panel->fillCaptureTools(m_captureToolObjects.annotations());
 }
 
 #if !defined(DISABLE_UPDATE_CHECKER)
@@ -1331,7 +1441,7 @@ void CaptureWidget::initSelection()
     QRect initialSelection = m_context.request.initialSelection();
     connect(m_selection, &SelectionWidget::geometryChanged, this, [this]() {
         QRect constrainedToCaptureArea =
-          m_selection->geometry().intersected(rect());
+          selectionRect().intersected(imageRect());
         m_context.selection = extendedRect(constrainedToCaptureArea);
 
         m_buttonHandler->hide();
@@ -1390,12 +1500,20 @@ void CaptureWidget::setState(CaptureToolButton* b)
         }
     }
     if (m_activeButton != b) {
-        auto backup = m_activeTool;
-        // The tool is active during the pressed().
-        // This must be done in order to handle tool requests correctly.
-        m_activeTool = b->tool();
-        m_activeTool->pressed(m_context);
-        m_activeTool = backup;
+        // Action tools (copy, save...) read the composed capture, they are
+        // pressed once the frame of the current objects is shown
+        QPointer<CaptureToolButton> button = b;
+        afterFrame([this, button]() {
+            if (button.isNull()) {
+                return;
+            }
+            auto backup = m_activeTool;
+            // The tool is active during the pressed().
+            // This must be done in order to handle tool requests correctly.
+            m_activeTool = button->tool();
+            m_activeTool->pressed(m_context);
+            m_activeTool = backup;
+        });
     }
 
     if (b->tool()->isSelectable()) {
@@ -1459,7 +1577,7 @@ void CaptureWidget::handleToolSignal(CaptureTool::Request r)
             m_toolWidget = m_activeTool->widget();
             if (m_toolWidget) {
                 makeChild(m_toolWidget);
-                m_toolWidget->move(m_context.mousePos);
+                m_toolWidget->move(m_viewport.toWidget(m_context.mousePos));
                 m_toolWidget->show();
                 m_toolWidget->setFocus();
             }
@@ -1504,6 +1622,7 @@ void CaptureWidget::onToolSizeChanged(int t)
     // update tool size of object being drawn
     if (m_activeTool != nullptr) {
         updateTool(m_activeTool);
+        drawActiveTool();
     }
 
     // update tool size of selected object
@@ -1575,9 +1694,7 @@ void CaptureWidget::onMoveCaptureToolUp(int captureToolIndex)
 {
     m_captureToolObjectsBackup = m_captureToolObjects;
     pushObjectsStateToUndoStack();
-    auto tool = m_captureToolObjects.at(captureToolIndex);
-    m_captureToolObjects.removeAt(captureToolIndex);
-    m_captureToolObjects.insert(captureToolIndex - 1, tool);
+    m_captureToolObjects.move(captureToolIndex, captureToolIndex - 1);
     updateLayersPanel();
 }
 
@@ -1585,47 +1702,139 @@ void CaptureWidget::onMoveCaptureToolDown(int captureToolIndex)
 {
     m_captureToolObjectsBackup = m_captureToolObjects;
     pushObjectsStateToUndoStack();
-    auto tool = m_captureToolObjects.at(captureToolIndex);
-    m_captureToolObjects.removeAt(captureToolIndex);
-    m_captureToolObjects.insert(captureToolIndex + 1, tool);
+    m_captureToolObjects.move(captureToolIndex, captureToolIndex + 1);
     updateLayersPanel();
 }
 
 void CaptureWidget::selectAll()
 {
     m_selection->show();
-    m_selection->setGeometry(rect());
+    m_selection->setGeometry(m_viewport.toWidget(imageRect()));
     emit m_selection->geometrySettled();
     m_buttonHandler->show();
     updateSelectionState();
 }
 
+/**
+ * @brief Keep the current selection as a region of a multi-selection and
+ * clear it, so that the next region can be selected.
+ */
+void CaptureWidget::addRegion()
+{
+    const QRect region = selectionRect().normalized();
+    if (!m_selection->isVisible() ||
+        region.intersected(imageRect()).isEmpty()) {
+        return;
+    }
+    m_regions.append(region);
+    m_selection->hide();
+    emit m_selection->geometrySettled();
+    update();
+}
+
+/**
+ * @brief Look for text in the capture on the global thread pool. The areas
+ * found are suggested to the pixelate tool, a click pixelates a whole area.
+ */
+void CaptureWidget::startTextDetection()
+{
+    QPointer<CaptureWidget> widget(this);
+    QImage image = m_context.origScreenshot.toImage();
+    QThreadPool::globalInstance()->start([widget, image]() {
+        QList<QRect> areas =
+          TextRegions::detect(image, TEXT_DETECTION_BUDGET_MS);
+        QMetaObject::invokeMethod(
+          qApp,
+          [widget, areas]() {
+              if (widget) {
+                  widget->setRedactionSuggestions(areas);
+              }
+          },
+          Qt::QueuedConnection);
+    });
+}
+
+void CaptureWidget::setRedactionSuggestions(const QList<QRect>& areas)
+{
+    // The areas are in pixels of the capture
+    const qreal scale = m_context.origScreenshot.devicePixelRatio();
+    m_redactionSuggestions.clear();
+    for (const QRect& area : areas) {
+        m_redactionSuggestions << QRect(area.topLeft() / scale,
+                                        area.size() / scale);
+    }
+    m_hoveredSuggestion = -1;
+    updateHoveredSuggestion(m_context.mousePos);
+}
+
+void CaptureWidget::updateHoveredSuggestion(const QPoint& pos)
+{
+    int hovered = -1;
+    if (activeButtonToolType() == CaptureTool::TYPE_PIXELATE) {
+        for (int i = 0; i < m_redactionSuggestions.size(); ++i) {
+            if (m_redactionSuggestions[i].contains(pos)) {
+                hovered = i;
+                break;
+            }
+        }
+    }
+    if (hovered == m_hoveredSuggestion) {
+        return;
+    }
+    if (m_hoveredSuggestion >= 0) {
+        updateImageRect(
+          paddedUpdateRect(m_redactionSuggestions[m_hoveredSuggestion]));
+    }
+    m_hoveredSuggestion = hovered;
+    if (m_hoveredSuggestion >= 0) {
+        updateImageRect(
+          paddedUpdateRect(m_redactionSuggestions[m_hoveredSuggestion]));
+    }
+}
+
+/**
+ * @brief A click without dragging on a suggested area turns the pixelate tool
+ * into an object covering all of it.
+ */
+void CaptureWidget::applyRedactionSuggestion()
+{
+    if (m_hoveredSuggestion < 0 ||
+        m_activeTool->type() != CaptureTool::TYPE_PIXELATE ||
+        !m_redactionSuggestions[m_hoveredSuggestion].contains(
+          m_mousePressedPos)) {
+        return;
+    }
+    std::optional<Annotation> annotation = m_activeTool->annotation();
+    auto* shape =
+      annotation ? std::get_if<TwoPointAnnotation>(&*annotation) : nullptr;
+    if (shape == nullptr) {
+        return;
+    }
+    const QRect area = m_redactionSuggestions.takeAt(m_hoveredSuggestion);
+    m_hoveredSuggestion = -1;
+    shape->first = area.topLeft();
+    shape->second = area.bottomRight();
+    m_activeTool->setAnnotation(*annotation);
+    updateImageRect(paddedUpdateRect(area));
+}
+
 void CaptureWidget::removeToolObject(int index)
 {
     --index;
     if (index >= 0 && index < m_captureToolObjects.size()) {
-        // in case this tool is circle counter
-        const CaptureTool::Type currentToolType =
-          m_captureToolObjects.at(index)->type();
+        const Annotation annotation =
+          m_captureToolObjects.annotations().at(index);
         m_captureToolObjectsBackup = m_captureToolObjects;
-        update(
-          paddedUpdateRect(m_captureToolObjects.at(index)->boundingRect()));
-        if (currentToolType == CaptureTool::TYPE_CIRCLECOUNT) {
-            int removedCircleCount = m_captureToolObjects.at(index)->count();
+        updateImageRect(
+          paddedUpdateRect(AnnotationRenderer::boundingRect(annotation)));
+        m_captureToolObjects.removeAt(index);
+        // in case this tool is circle counter
+        const auto* circle = std::get_if<CircleCountAnnotation>(&annotation);
+        if (circle != nullptr) {
             --m_context.circleCount;
             // Decrement circle counter numbers starting from deleted circle
-            for (int cnt = 0; cnt < m_captureToolObjects.size(); cnt++) {
-                auto toolItem = m_captureToolObjects.at(cnt);
-                if (toolItem->type() != CaptureTool::TYPE_CIRCLECOUNT) {
-                    continue;
-                }
-                auto circleTool = m_captureToolObjects.at(cnt);
-                if (circleTool->count() >= removedCircleCount) {
-                    circleTool->setCount(circleTool->count() - 1);
-                }
-            }
+            m_captureToolObjects.renumberCircleCounts(circle->count);
         }
-        m_captureToolObjects.removeAt(index);
         pushObjectsStateToUndoStack();
         drawToolsData();
         updateLayersPanel();
@@ -1703,6 +1912,10 @@ void CaptureWidget::initShortcuts()
                 this,
                 SLOT(selectAll()));
 
+    newShortcut(QKeySequence(ConfigHandler().shortcut("TYPE_ADD_REGION")),
+                this,
+                SLOT(addRegion()));
+
     newShortcut(Qt::Key_Escape, this, SLOT(deleteToolWidgetOrClose()));
 }
 
@@ -1778,10 +1991,10 @@ void CaptureWidget::updateTool(CaptureTool* tool)
     QRect toolObjectRect = paddedUpdateRect(tool->boundingRect());
 
     // old rects are united with current rects to handle sudden mouse movement
-    update(previewRect);
-    update(toolObjectRect);
-    update(oldPreviewRect);
-    update(oldToolObjectRect);
+    updateImageRect(previewRect);
+    updateImageRect(toolObjectRect);
+    updateImageRect(oldPreviewRect);
+    updateImageRect(oldToolObjectRect);
 
     oldPreviewRect = previewRect;
     oldToolObjectRect = toolObjectRect;
@@ -1789,7 +2002,7 @@ void CaptureWidget::updateTool(CaptureTool* tool)
 
 void CaptureWidget::updateLayersPanel()
 {
-    m_panel->fillCaptureTools(m_captureToolObjects.captureToolObjects());
+    m_panel->fillCaptureTools(m_captureToolObjects.annotations());
 }
 
 void CaptureWidget::pushToolToStack()
@@ -1826,15 +2039,23 @@ void CaptureWidget::pushToolToStack()
 
 void CaptureWidget::drawToolsData(bool drawSelection)
 {
-    // TODO refactor this for performance. The objects should not all be updated
-    // at once every time
-    QPixmap pixmapItem = m_context.origScreenshot;
-    for (const auto& toolItem : m_captureToolObjects.captureToolObjects()) {
-        processPixmapWithTool(&pixmapItem, toolItem);
-        update(paddedUpdateRect(toolItem->boundingRect()));
-    }
-
-    m_context.screenshot = pixmapItem;
+    // The frame is composed on the compositor thread and shown by
+    // applyFrame(), a newer request replaces one that has not started yet
+    const QList<Annotation> annotations = m_captureToolObjects.annotations();
+    m_compositor->request(
+      m_context.origScreenshot, annotations, activeAnnotation());
+    m_frameRequested = true;
+    // Objects removed or moved since the last request change the frame too
+    m_frameDirty += m_requestedArea;
+    m_requestedArea = QRegion();
+    for (const auto& annotation : annotations) {
+        m_requestedArea +=
+          paddedUpdateRect(AnnotationRenderer::boundingRect(annotation));
+    }
+    m_frameDirty += m_requestedArea;
+    updateActiveArea();
+
+    m_frameSelection = false;
     if (drawSelection) {
         drawObjectSelection();
     }
@@ -1844,8 +2065,20 @@ void CaptureWidget::drawObjectSelection()
 {
     auto toolItem = activeToolObject();
     if (toolItem && !toolItem->editMode()) {
-        QPainter painter(&m_context.screenshot);
-        toolItem->drawObjectSelection(painter);
+        if (m_compositor->pending()) {
+            // Drawn when the frame is shown
+            m_frameSelection = true;
+        } else {
+            const qint64 previousKey = m_context.screenshot.cacheKey();
+            paintObjectSelection();
+            captureChanged(previousKey,
+                           paddedUpdateRect(toolItem->boundingRect()));
+            if (!m_viewport.isIdentity()) {
+                m_mipTiles.update(
+                  m_context.screenshot,
+                  paddedUpdateRect(toolItem->boundingRect()));
+            }
+        }
         // TODO move this elsewhere
         if (m_context.toolSize != toolItem->size()) {
             m_context.toolSize = toolItem->size();
@@ -1856,11 +2089,113 @@ void CaptureWidget::drawObjectSelection()
     }
 }
 
-void CaptureWidget::processPixmapWithTool(QPixmap* pixmap, CaptureTool* tool)
+void CaptureWidget::paintObjectSelection()
+{
+    auto toolItem = activeToolObject();
+    if (toolItem && !toolItem->editMode()) {
+        QPainter painter(&m_context.screenshot);
+        toolItem->drawObjectSelection(painter);
+    }
+}
+
+/**
+ * @brief Shows the last frame published by the compositor, if it wasn't
+ * shown yet.
+ */
+void CaptureWidget::applyFrame()
+{
+    quint64 generation = 0;
+    const QImage frame = m_compositor->frame(&generation);
+    if (generation <= m_shownGeneration) {
+        return;
+    }
+    m_shownGeneration = generation;
+    const qint64 previousKey = m_context.screenshot.cacheKey();
+    m_context.screenshot = QPixmap::fromImage(frame);
+    if (m_frameSelection) {
+        paintObjectSelection();
+    }
+    captureChanged(previousKey, m_frameDirty);
+    if (m_viewport.isIdentity()) {
+        update(m_frameDirty);
+    } else {
+        // Only the levels and tiles under the changes are made again
+        m_mipTiles.update(m_context.screenshot, m_frameDirty);
+        update(m_viewport.toWidget(m_frameDirty));
+    }
+    if (!m_compositor->pending()) {
+        m_frameDirty = QRegion();
+        // They may request new frames
+        const QList<std::function<void()>> actions =
+          std::exchange(m_frameActions, {});
+        for (const auto& action : actions) {
+            action();
+        }
+    }
+}
+
+/**
+ * @brief Waits for the frame of the current objects, before the capture is
+ * exported.
+ */
+void CaptureWidget::syncFrame()
 {
-    QPainter painter(pixmap);
-    painter.setRenderHint(QPainter::Antialiasing);
-    tool->process(painter, *pixmap);
+    m_compositor->wait();
+    applyFrame();
+}
+
+/**
+ * @brief Runs `action` once the frame of the current objects is shown, right
+ * away if it already is. Nothing waits for the compositor meanwhile.
+ */
+void CaptureWidget::afterFrame(const std::function<void()>& action)
+{
+    if (m_compositor->pending()) {
+        m_frameActions.append(action);
+        return;
+    }
+    // Published, but frameReady() may still be queued
+    applyFrame();
+    action();
+}
+
+/**
+ * @brief Requests a frame with the object being drawn over the objects of
+ * the last request, which are not composed again.
+ */
+void CaptureWidget::drawActiveTool()
+{
+    if (!m_frameRequested) {
+        drawToolsData(false);
+        return;
+    }
+    m_compositor->requestActive(activeAnnotation());
+    updateActiveArea();
+}
+
+std::optional<Annotation> CaptureWidget::activeAnnotation() const
+{
+    if (m_activeTool && m_mouseIsClicked) {
+        return m_activeTool->annotation();
+    }
+    return std::nullopt;
+}
+
+// Repaints the old and the new area of the object being drawn with the
+// requested frame
+void CaptureWidget::updateActiveArea()
+{
+    m_frameDirty += m_activeArea;
+    m_activeArea = QRect();
+    if (m_activeTool && m_mouseIsClicked) {
+        m_activeArea = paddedUpdateRect(m_activeTool->boundingRect());
+        if (m_activeArea.isNull()) {
+            // Nothing spanned yet, a dot may still be drawn
+            m_activeArea = paddedUpdateRect(
+              m_activeTool->mousePreviewRect(m_context));
+        }
+    }
+    m_frameDirty += m_activeArea;
 }
 
 CaptureTool* CaptureWidget::activeButtonTool() const
@@ -1906,13 +2241,10 @@ void CaptureWidget::makeChild(QWidget* w)
 void CaptureWidget::restoreCircleCountState()
 {
     int largest = 0;
-    for (int cnt = 0; cnt < m_captureToolObjects.size(); cnt++) {
-        auto toolItem = m_captureToolObjects.at(cnt);
-        if (toolItem->type() != CaptureTool::TYPE_CIRCLECOUNT) {
-            continue;
-        }
-        if (toolItem->count() > largest) {
-            largest = toolItem->count();
+    for (const auto& annotation : m_captureToolObjects.annotations()) {
+        const auto* circle = std::get_if<CircleCountAnnotation>(&annotation);
+        if (circle != nullptr && circle->count > largest) {
+            largest = circle->count;
         }
     }
     m_context.circleCount = largest + 1;
@@ -2010,6 +2342,12 @@ void CaptureWidget::cancel()
         delete m_toolWidget;
         m_toolWidget = nullptr;
     }
+    if (!m_selection->isVisible() && !m_regions.isEmpty()) {
+        // Nothing selected, drop the last region of a multi-selection
+        m_regions.removeLast();
+        update();
+        return;
+    }
     m_selection->hide();
     emit m_selection->geometrySettled();
 }
@@ -2019,7 +2357,7 @@ QRect CaptureWidget::extendedSelection() const
     if (m_selection == nullptr) {
         return {};
     }
-    QRect r = m_selection->geometry();
+    QRect r = selectionRect();
     return extendedRect(r);
 }
 
@@ -2041,6 +2379,71 @@ QRect CaptureWidget::paddedUpdateRect(const QRect& r) const
     }
 }
 
+/**
+ * @brief The capture in image space. At 100% it covers the widget.
+ */
+QRect CaptureWidget::imageRect() const
+{
+    if (m_viewport.isIdentity()) {
+        return rect();
+    }
+    return QRect(QPoint(0, 0),
+                 m_context.screenshot.deviceIndependentSize().toSize());
+}
+
+/**
+ * @brief The selection in image space. The selection widget is a child
+ * widget, its geometry is in widget space.
+ */
+QRect CaptureWidget::selectionRect() const
+{
+    const QRect geometry = m_selection->geometry();
+    if (m_viewport.isIdentity()) {
+        return geometry;
+    }
+    // Mapping back from a zoomed out widget geometry would round the
+    // selection, so it is kept until the selection is changed
+    if (geometry == m_viewportSelectionWidget) {
+        return m_viewportSelection;
+    }
+    return m_viewport.toImage(geometry);
+}
+
+void CaptureWidget::updateImageRect(const QRect& r)
+{
+    if (m_viewport.isIdentity()) {
+        update(r);
+    } else {
+        // The mapping rounds, a pixel more on each side
+        update(m_viewport.toWidget(r) + QMargins(1, 1, 1, 1));
+    }
+}
+
+/**
+ * @brief Zoom or pan the capture. The selection widget and its buttons move
+ * along, the selection stays the same in image space.
+ */
+void CaptureWidget::setViewport(const CaptureViewport& viewport)
+{
+    const QRect selection = selectionRect();
+    m_viewport = viewport;
+    m_viewport.constrain(m_context.screenshot.deviceIndependentSize(),
+                         QSizeF(size()));
+    if (m_viewport.isIdentity()) {
+        // The levels and tiles are only drawn while zoomed
+        m_mipTiles.setSource(QPixmap());
+    }
+
+    m_viewportSelection = selection;
+    m_viewportSelectionWidget = m_viewport.toWidget(selection);
+    m_selection->setGeometry(m_viewportSelectionWidget);
+    emit m_selection->geometrySettled();
+    if (m_toolWidget && m_activeTool) {
+        m_toolWidget->move(m_viewport.toWidget(*m_activeTool->pos()));
+    }
+    update();
+}
+
 void CaptureWidget::drawErrorMessage(const QString& msg, QPainter* painter)
 {
     auto textRect = painter->fontMetrics().boundingRect(msg);
@@ -2063,11 +2466,144 @@ void CaptureWidget::drawInactiveRegion(QPainter* painter)
     painter->setBrush(overlayColor);
     QRect r;
     if (m_selection->isVisible()) {
-        r = m_selection->geometry().normalized();
+        r = selectionRect().normalized();
     }
-    QRegion grey(rect());
+    // The part of the capture in view
+    QRegion grey(m_viewport.toImage(rect()));
     grey = grey.subtracted(r);
+    for (const QRect& region : std::as_const(m_regions)) {
+        grey = grey.subtracted(region);
+    }
+
+    // Where nothing was painted over the capture yet, the dimmed capture is
+    // copied instead of blending the overlay on every repaint
+    if (m_viewport.isIdentity() && !m_context.screenshot.hasAlphaChannel()) {
+        QRegion painted;
+        if (m_xywhDisplay) {
+            painted = grey;
+        } else if (m_displayGrid) {
+            painted =
+              r + QMargins(m_gridSize, m_gridSize, m_gridSize, m_gridSize);
+        }
+        QRect toolRect;
+        if (!(m_activeTool && m_mouseIsClicked) && m_previewEnabled &&
+            activeButtonTool() && m_activeButton->tool()->showMousePreview()) {
+            toolRect = m_activeButton->tool()->mousePreviewRect(m_context);
+            toolRect += QMargins(toolRect.width(),
+                                 toolRect.height(),
+                                 toolRect.width(),
+                                 toolRect.height());
+        }
+        painted = painted.united(toolRect).intersected(grey);
+
+        painter->setClipRegion(grey.subtracted(painted));
+        painter->drawImage(0, 0, dimmedScreenshot());
+        painter->setClipRegion(painted);
+        painter->drawRect(-1, -1, rect().width() + 1, rect().height() + 1);
+        painter->setClipRegion(grey);
+        return;
+    }
 
     painter->setClipRegion(grey);
-    painter->drawRect(-1, -1, rect().width() + 1, rect().height() + 1);
+    painter->drawRect(grey.boundingRect() + QMargins(1, 1, 1, 1));
+}
+
+const QImage& CaptureWidget::dimmedScreenshot()
+{
+    const QPixmap& screenshot = m_context.screenshot;
+    QImage image = screenshot.toImage();
+    if (screenshot.cacheKey() != m_dimmedKey || m_opacity != m_dimmedOpacity ||
+        image.size() != m_dimmedScreenshot.size() ||
+        image.format() != m_dimmedScreenshot.format()) {
+        if (BlendKernels::canBlend(image)) {
+            image = BufferPool::instance()->copy(image);
+        } else {
+            image = image.convertToFormat(QImage::Format_RGB32);
+        }
+        // Free the previous copy first, its buffer goes back to the pool
+        m_dimmedScreenshot = QImage();
+        BlendKernels::dim(image, m_opacity);
+        m_dimmedScreenshot = std::move(image);
+        m_dimmedKey = screenshot.cacheKey();
+        m_dimmedOpacity = m_opacity;
+        m_dimmedDirty = QRegion();
+        return m_dimmedScreenshot;
+    }
+
+    // Only the changes of the frames shown since are dimmed again
+    const qreal scale = screenshot.devicePixelRatio();
+    for (const QRect& dirty : std::as_const(m_dimmedDirty)) {
+        const QRect area = QRectF(QPointF(dirty.topLeft()) * scale,
+                                  QSizeF(dirty.size()) * scale)
+                             .toAlignedRect()
+                             .intersected(image.rect());
+        for (int y = area.top(); y <= area.bottom(); ++y) {
+            const auto* from =
+              reinterpret_cast<const quint32*>(image.constScanLine(y));
+            auto* to =
+              reinterpret_cast<quint32*>(m_dimmedScreenshot.scanLine(y));
+            std::memcpy(to + area.left(),
+                        from + area.left(),
+                        area.width() * sizeof(quint32));
+            BlendKernels::dim(to + area.left(), area.width(), m_opacity);
+        }
+    }
+    m_dimmedDirty = QRegion();
+    return m_dimmedScreenshot;
+}
+
+/**
+ * @brief Notes that the pixels of the capture changed only inside `dirty`,
+ * in image space, so that the dimmed copy is not made again whole.
+ * @param previousKey Cache key of the capture before the change
+ */
+void CaptureWidget::captureChanged(qint64 previousKey, const QRegion& dirty)
+{
+    if (m_dimmedKey == previousKey && !m_dimmedScreenshot.isNull()) {
+        m_dimmedDirty += dirty;
+        m_dimmedKey = m_context.screenshot.cacheKey();
+    }
+}
+
+void CaptureWidget::drawRedactionSuggestion(QPainter* painter)
+{
+    if (m_hoveredSuggestion < 0) {
+        return;
+    }
+    const QRect& area = m_redactionSuggestions[m_hoveredSuggestion];
+    QColor fill = m_uiColor;
+    fill.setAlpha(60);
+    painter->save();
+    painter->setClipping(false);
+    painter->fillRect(area, fill);
+    painter->setPen(QPen(m_uiColor, 1, Qt::DashLine));
+    painter->setBrush(Qt::NoBrush);
+    painter->drawRect(area);
+    painter->restore();
+}
+
+void CaptureWidget::drawRegions(QPainter* painter)
+{
+    if (m_regions.isEmpty()) {
+        return;
+    }
+    painter->save();
+    painter->setClipping(false);
+    painter->setBrush(Qt::NoBrush);
+    QFontMetrics fm = painter->fontMetrics();
+    for (int i = 0; i < m_regions.size(); ++i) {
+        const QRect& region = m_regions[i];
+        painter->setPen(QPen(m_uiColor, 2, Qt::DashLine));
+        painter->drawRect(region);
+
+        // Number of the region, as in the saved file names
+        const QString index = QString::number(i + 1);
+        QRect label = fm.boundingRect(index).adjusted(-4, -2, 4, 2);
+        label.moveTopLeft(region.topLeft());
+        painter->fillRect(label, m_uiColor);
+        painter->setPen(ColorUtils::colorIsDark(m_uiColor) ? Qt::white
+                                                           : Qt::black);
+        painter->drawText(label, Qt::AlignCenter, index);
+    }
+    painter->restore();
 }
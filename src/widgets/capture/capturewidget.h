@@ -18,13 +18,18 @@
 #include "src/tools/capturecontext.h"
 #include "src/tools/capturetool.h"
 #include "src/utils/confighandler.h"
+#include "src/widgets/capture/captureviewport.h"
 #include "src/widgets/capture/magnifierwidget.h"
+#include "src/widgets/capture/miptilecache.h"
 #include "src/widgets/capture/selectionwidget.h"
 #include <QMessageBox>
 #include <QPointer>
+#include <QRegion>
 #include <QTimer>
 #include <QUndoStack>
 #include <QWidget>
+#include <functional>
+#include <optional>
 
 class QLabel;
 class QPaintEvent;
@@ -34,6 +39,7 @@ class QShortcut;
 class QNetworkAccessManager;
 class QNetworkReply;
 class ColorPicker;
+class FrameCompositor;
 class NotifierBox;
 class HoverEventFilter;
 #if !defined(DISABLE_UPDATE_CHECKER)
@@ -88,6 +94,7 @@ private slots:
     void onMoveCaptureToolUp(int captureToolIndex);
     void onMoveCaptureToolDown(int captureToolIndex);
     void selectAll();
+    void addRegion();
     void xywhTick();
     void onDisplayGridChanged(bool display);
     void onGridSizeChanged(int size);
@@ -116,7 +123,7 @@ private:
     void pushObjectsStateToUndoStack();
     void releaseActiveTool();
     void uncheckActiveTool();
-    int selectToolItemAtPos(const QPoint& pos);
+    int selectToolItemAtPos(const QPoint& widgetPos);
     void showColorPicker(const QPoint& pos);
     bool startDrawObjectTool(const QPoint& pos);
     QPointer<CaptureTool> activeToolObject();
@@ -146,18 +153,36 @@ private:
     QRect extendedSelection() const;
     QRect extendedRect(const QRect& r) const;
     QRect paddedUpdateRect(const QRect& r) const;
+    QRect imageRect() const;
+    QRect selectionRect() const;
+    void updateImageRect(const QRect& r);
+    void setViewport(const CaptureViewport& viewport);
     void drawErrorMessage(const QString& msg, QPainter* painter);
     void drawInactiveRegion(QPainter* painter);
+    const QImage& dimmedScreenshot();
+    void captureChanged(qint64 previousKey, const QRegion& dirty);
+    void drawRegions(QPainter* painter);
+    void drawRedactionSuggestion(QPainter* painter);
     void drawToolsData(bool drawSelection = true);
     void drawObjectSelection();
-
-    void processPixmapWithTool(QPixmap* pixmap, CaptureTool* tool);
+    void paintObjectSelection();
+    void applyFrame();
+    void syncFrame();
+    void afterFrame(const std::function<void()>& action);
+    void drawActiveTool();
+    std::optional<Annotation> activeAnnotation() const;
+    void updateActiveArea();
 
     CaptureTool* activeButtonTool() const;
     CaptureTool::Type activeButtonToolType() const;
 
     QPoint snapToGrid(const QPoint& point) const;
 
+    void startTextDetection();
+    void setRedactionSuggestions(const QList<QRect>& areas);
+    void updateHoveredSuggestion(const QPoint& pos);
+    void applyRedactionSuggestion();
+
     ////////////////////////////////////////
     // Class members
 
@@ -171,6 +196,12 @@ private:
 
     // Outside selection opacity
     int m_opacity;
+    // The capture with the outside selection overlay applied, for the
+    // screenshot of the cache key and opacity, except in m_dimmedDirty
+    QImage m_dimmedScreenshot;
+    qint64 m_dimmedKey{ 0 };
+    int m_dimmedOpacity{ -1 };
+    QRegion m_dimmedDirty;
     int m_toolSizeByKeyboard;
 
     // utility flags
@@ -203,6 +234,11 @@ private:
     NotifierBox* m_notifierBox;
     HoverEventFilter* m_eventFilter;
     SelectionWidget* m_selection;
+    // Earlier selections of a multi-selection, exported with the current one
+    QList<QRect> m_regions;
+    // Text found in the capture, offered to the pixelate tool
+    QList<QRect> m_redactionSuggestions;
+    int m_hoveredSuggestion{ -1 };
     MagnifierWidget* m_magnifier;
     QString m_helpMessage;
 
@@ -212,6 +248,33 @@ private:
     CaptureToolObjects m_captureToolObjects;
     CaptureToolObjects m_captureToolObjectsBackup;
 
+    // Composes m_captureToolObjects over origScreenshot off the GUI thread
+    FrameCompositor* m_compositor;
+    // Generation of the frame shown in m_context.screenshot
+    quint64 m_shownGeneration{ 0 };
+    // Areas to repaint when the requested frame is shown
+    QRegion m_frameDirty;
+    // Areas of the objects of the last request
+    QRegion m_requestedArea;
+    // Area of the object being drawn in the last request
+    QRect m_activeArea;
+    bool m_frameRequested{ false };
+    // Waiting for the requested frame, see afterFrame()
+    QList<std::function<void()>> m_frameActions;
+    // Whether the selected object is drawn over the requested frame
+    bool m_frameSelection{ false };
+
+    // Zoom and pan of the capture. The tools and annotations work in image
+    // space, the mouse events and child widgets in widget space.
+    CaptureViewport m_viewport;
+    MipTileCache m_mipTiles;
+    // The selection in image space, kept exact while the selection widget
+    // has the geometry setViewport() gave it
+    QRect m_viewportSelection;
+    QRect m_viewportSelectionWidget;
+    bool m_panning{ false };
+    QPoint m_panLastPos;
+
     QPoint m_mousePressedPos;
     QPoint m_activeToolOffsetToMouseOnStart;
 
@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "framecompositor.h"
+#include "src/tools/annotationrenderer.h"
+#include "src/utils/bufferpool.h"
+#include "src/widgets/capture/tilecompositor.h"
+#include <QMutexLocker>
+#include <QPainter>
+
+FrameCompositor::FrameCompositor(QObject* parent)
+  : QObject(parent)
+  , m_baseKey(0)
+  , m_annotationsChanged(false)
+  , m_scheduled(false)
+  , m_requestedGeneration(0)
+  , m_publishedGeneration(0)
+{
+    m_thread.setObjectName(QStringLiteral("FrameCompositor"));
+    m_worker.moveToThread(&m_thread);
+    m_thread.start();
+}
+
+FrameCompositor::~FrameCompositor()
+{
+    // A running composition finishes, the queued ones are dropped
+    m_thread.quit();
+    m_thread.wait();
+}
+
+quint64 FrameCompositor::request(const QPixmap& base,
+                                 const QList<Annotation>& annotations,
+                                 const std::optional<Annotation>& active)
+{
+    QMutexLocker locker(&m_mutex);
+    // QPixmap is only converted here, on the GUI thread
+    if (base.cacheKey() != m_baseKey) {
+        m_base = base.toImage();
+        if (m_base.format() != QImage::Format_RGB32 &&
+            m_base.format() != QImage::Format_ARGB32_Premultiplied) {
+            m_base = m_base.convertToFormat(
+              m_base.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied
+                                       : QImage::Format_RGB32);
+        }
+        m_baseKey = base.cacheKey();
+    }
+    m_annotations = annotations;
+    m_annotationsChanged = true;
+    m_active = active;
+    return schedule();
+}
+
+quint64 FrameCompositor::requestActive(const std::optional<Annotation>& active)
+{
+    QMutexLocker locker(&m_mutex);
+    m_active = active;
+    return schedule();
+}
+
+quint64 FrameCompositor::schedule()
+{
+    const quint64 generation = ++m_requestedGeneration;
+    if (!m_scheduled) {
+        m_scheduled = true;
+        QMetaObject::invokeMethod(
+          &m_worker, [this]() { compose(); }, Qt::QueuedConnection);
+    }
+    return generation;
+}
+
+bool FrameCompositor::pending() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_publishedGeneration < m_requestedGeneration;
+}
+
+void FrameCompositor::wait()
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_publishedGeneration < m_requestedGeneration) {
+        m_published.wait(&m_mutex);
+    }
+}
+
+QImage FrameCompositor::frame(quint64* generation) const
+{
+    QMutexLocker locker(&m_mutex);
+    if (generation != nullptr) {
+        *generation = m_publishedGeneration;
+    }
+    return m_frame;
+}
+
+void FrameCompositor::compose()
+{
+    // Compose the latest request until no newer one came in meanwhile
+    while (true) {
+        QMutexLocker locker(&m_mutex);
+        if (m_publishedGeneration == m_requestedGeneration) {
+            m_scheduled = false;
+            return;
+        }
+        const QImage base = m_base;
+        const QList<Annotation> annotations = m_annotations;
+        const bool annotationsChanged = m_annotationsChanged;
+        const std::optional<Annotation> active = m_active;
+        const quint64 generation = m_requestedGeneration;
+        m_annotationsChanged = false;
+        locker.unlock();
+
+        if (annotationsChanged || m_composed.isNull()) {
+            m_composed = TileCompositor::compose(base, annotations);
+        }
+        QImage frame = m_composed;
+        if (active && !frame.isNull()) {
+            // Drawn on a copy, it reads the composed annotations under it
+            frame = BufferPool::instance()->copy(m_composed);
+            if (!AnnotationRenderer::renderInPlace(frame, *active)) {
+                QPainter painter(&frame);
+                painter.setRenderHint(QPainter::Antialiasing);
+                AnnotationRenderer::render(painter, m_composed, *active);
+            }
+        }
+
+        locker.relock();
+        m_frame = frame;
+        m_publishedGeneration = generation;
+        m_published.wakeAll();
+        locker.unlock();
+        emit frameReady();
+    }
+}
@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "src/tools/annotation.h"
+#include <QImage>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QPixmap>
+#include <QThread>
+#include <QWaitCondition>
+#include <optional>
+
+/**
+ * @brief Composes the annotated capture on its own thread, so that slow
+ * effects don't hold up the input of CaptureWidget.
+ *
+ * Each request is an immutable copy of the annotation list. A request that
+ * has not started yet is replaced by the next one, the frames in between are
+ * never drawn. Finished frames are published whole under a lock, frame()
+ * always returns a complete image.
+ *
+ * The object being drawn changes on every mouse move. It is drawn over the
+ * composed annotations, which are kept and only composed again when they
+ * change.
+ */
+class FrameCompositor : public QObject
+{
+    Q_OBJECT
+public:
+    explicit FrameCompositor(QObject* parent = nullptr);
+    ~FrameCompositor();
+
+    // Returns the generation of the requested frame. `active` is the object
+    // being drawn, if any.
+    quint64 request(const QPixmap& base,
+                    const QList<Annotation>& annotations,
+                    const std::optional<Annotation>& active = std::nullopt);
+    // Same annotations as the last request, only the object being drawn
+    // changed
+    quint64 requestActive(const std::optional<Annotation>& active);
+    // Whether the last requested frame is not published yet
+    bool pending() const;
+    // Blocks until the last requested frame is published
+    void wait();
+
+    // The last published frame and its generation
+    QImage frame(quint64* generation = nullptr) const;
+
+signals:
+    // Emitted from the compositor thread
+    void frameReady();
+
+private:
+    // Called with m_mutex locked
+    quint64 schedule();
+    void compose();
+
+    QThread m_thread;
+    // Lives in m_thread, the compositions are queued to it
+    QObject m_worker;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_published;
+    // The base converted once for every capture
+    QImage m_base;
+    qint64 m_baseKey;
+    QList<Annotation> m_annotations;
+    std::optional<Annotation> m_active;
+    // Whether m_annotations changed since they were composed
+    bool m_annotationsChanged;
+    // Whether a composition is queued to the thread or running
+    bool m_scheduled;
+    quint64 m_requestedGeneration;
+    quint64 m_publishedGeneration;
+    QImage m_frame;
+    // Only used by the compositor thread: the composed annotations, without
+    // the object being drawn
+    QImage m_composed;
+};
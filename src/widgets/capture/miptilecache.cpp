@@ -0,0 +1,242 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "miptilecache.h"
+#include "src/utils/resampler.h"
+#include <QPainter>
+#include <QRectF>
+#include <cstring>
+
+namespace {
+
+// In pixels of the level
+const int TILE_SIZE = 256;
+// Down to 1/128, beyond the smallest zoom on any capture
+const int MAX_LEVELS = 8;
+// Cost of the cached tiles in KiB, about eight 4K screens
+const int MAX_TILE_KIB = 256 * 1024;
+// Pixels of a level resampled around a tile and thrown away, wider than the
+// reach of the filter
+const int FILTER_MARGIN = 4;
+
+quint64 tileKey(int level, int column, int row)
+{
+    return (quint64(level) << 48) | (quint64(column) << 24) | quint64(row);
+}
+
+} // unnamed namespace
+
+MipTileCache::MipTileCache()
+  : m_tiles(MAX_TILE_KIB)
+{}
+
+void MipTileCache::setSource(const QPixmap& capture)
+{
+    if (capture.cacheKey() == m_source.cacheKey()) {
+        return;
+    }
+    m_source = capture;
+    m_levels.clear();
+    m_made.clear();
+    m_tiles.clear();
+}
+
+void MipTileCache::update(const QPixmap& capture, const QRegion& dirty)
+{
+    if (m_levels.isEmpty() || capture.size() != m_source.size() ||
+        capture.devicePixelRatio() != m_source.devicePixelRatio()) {
+        setSource(capture);
+        return;
+    }
+    m_source = capture;
+    m_levels[0] = capture.toImage();
+    m_made[0] = QRegion(m_levels[0].rect());
+    const qreal dpr = capture.devicePixelRatio();
+    for (const QRect& rect : dirty) {
+        // In pixels of the level
+        QRect area = QRectF(QPointF(rect.topLeft()) * dpr,
+                            QSizeF(rect.size()) * dpr)
+                       .toAlignedRect()
+                       .intersected(m_levels[0].rect());
+        for (int index = 0; index < m_levels.size() && !area.isEmpty();
+             ++index) {
+            if (index > 0) {
+                area = invalidate(index, area);
+            }
+            dropTiles(index, area);
+        }
+    }
+}
+
+void MipTileCache::draw(QPainter& painter, const QRectF& visible, qreal scale)
+{
+    if (m_source.isNull()) {
+        return;
+    }
+    // The smallest level with no more than one of its pixels per pixel of
+    // the screen
+    int index = 0;
+    while (index + 1 < MAX_LEVELS && scale * (2 << index) <= 1.0 &&
+           level(index).width() > 1 && level(index).height() > 1) {
+        ++index;
+    }
+    const QImage& image = level(index);
+
+    // Logical size of a pixel of the level
+    const qreal dpr = m_source.devicePixelRatio();
+    const qreal pixelWidth = m_source.width() / dpr / image.width();
+    const qreal pixelHeight = m_source.height() / dpr / image.height();
+    const QRect pixels = QRectF(visible.x() / pixelWidth,
+                                visible.y() / pixelHeight,
+                                visible.width() / pixelWidth,
+                                visible.height() / pixelHeight)
+                           .toAlignedRect()
+                           .intersected(image.rect());
+    if (pixels.isEmpty()) {
+        return;
+    }
+
+    // Zoomed in the pixels stay sharp, to place the tools precisely
+    const bool smooth = painter.testRenderHint(QPainter::SmoothPixmapTransform);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, scale < 1.0);
+    for (int row = pixels.top() / TILE_SIZE; row <= pixels.bottom() / TILE_SIZE;
+         ++row) {
+        for (int column = pixels.left() / TILE_SIZE;
+             column <= pixels.right() / TILE_SIZE;
+             ++column) {
+            // Drawn right away, the next tile may evict it from the cache
+            const QPixmap* pixmap = tile(index, column, row);
+            if (pixmap == nullptr) {
+                continue;
+            }
+            const QRectF target(column * TILE_SIZE * pixelWidth,
+                                row * TILE_SIZE * pixelHeight,
+                                pixmap->width() * pixelWidth,
+                                pixmap->height() * pixelHeight);
+            painter.drawPixmap(target, *pixmap, QRectF(pixmap->rect()));
+        }
+    }
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, smooth);
+}
+
+const QImage& MipTileCache::level(int index)
+{
+    if (m_levels.isEmpty()) {
+        m_levels << m_source.toImage();
+        m_made << QRegion(m_levels[0].rect());
+    }
+    while (m_levels.size() <= index) {
+        const QImage& previous = m_levels.last();
+        const QSize size(qMax(1, (previous.width() + 1) / 2),
+                         qMax(1, (previous.height() + 1) / 2));
+        // Same format as the resampler gives, filled in by make()
+        m_levels << QImage(size,
+                           previous.hasAlphaChannel()
+                             ? QImage::Format_ARGB32_Premultiplied
+                             : QImage::Format_RGB32);
+        m_made << QRegion();
+    }
+    return m_levels[index];
+}
+
+/**
+ * @brief Resamples the parts of `area` of level `index` that are not made
+ * yet, and the parts of the levels before it they come from.
+ */
+void MipTileCache::make(int index, const QRect& area)
+{
+    const QRegion missing =
+      QRegion(area.intersected(level(index).rect())) - m_made[index];
+    if (missing.isEmpty()) {
+        return;
+    }
+    for (const QRect& target : missing) {
+        resample(index, target);
+    }
+    m_made[index] += missing;
+}
+
+/**
+ * @brief Resamples `target` of level `index` from the level before it.
+ */
+void MipTileCache::resample(int index, const QRect& target)
+{
+    const QRect padded =
+      target
+        .adjusted(-FILTER_MARGIN, -FILTER_MARGIN, FILTER_MARGIN, FILTER_MARGIN)
+        .intersected(m_levels[index].rect());
+    const QRect source = QRect(padded.topLeft() * 2, padded.size() * 2)
+                           .intersected(m_levels[index - 1].rect());
+    make(index - 1, source);
+
+    const QImage& previous = m_levels[index - 1];
+    QImage& image = m_levels[index];
+    // Same format as the level, both come from the resampler
+    const QImage resampled =
+      Resampler::resize(previous.copy(source), padded.size())
+        .convertToFormat(image.format());
+
+    // Copied row by row, a painter would apply the device pixel ratio
+    const int offsetX = target.left() - padded.left();
+    const int offsetY = target.top() - padded.top();
+    for (int y = 0; y < target.height(); ++y) {
+        const auto* from =
+          reinterpret_cast<const QRgb*>(resampled.constScanLine(offsetY + y));
+        auto* to = reinterpret_cast<QRgb*>(image.scanLine(target.top() + y));
+        std::memcpy(to + target.left(),
+                    from + offsetX,
+                    target.width() * sizeof(QRgb));
+    }
+}
+
+/**
+ * @brief Marks the part of level `index` made from `area` of the level
+ * before it to be resampled again.
+ * @return The part, in pixels of level `index`
+ */
+QRect MipTileCache::invalidate(int index, const QRect& area)
+{
+    // The filter reaches a few pixels past the halved area
+    const QRect target =
+      QRect(QPoint(area.left() / 2, area.top() / 2),
+            QPoint(area.right() / 2, area.bottom() / 2))
+        .adjusted(-FILTER_MARGIN, -FILTER_MARGIN, FILTER_MARGIN, FILTER_MARGIN)
+        .intersected(m_levels[index].rect());
+    m_made[index] -= target;
+    return target;
+}
+
+const QPixmap* MipTileCache::tile(int level, int column, int row)
+{
+    const quint64 key = tileKey(level, column, row);
+    if (const QPixmap* cached = m_tiles.object(key)) {
+        return cached;
+    }
+    const QImage& image = this->level(level);
+    const QRect area =
+      QRect(column * TILE_SIZE, row * TILE_SIZE, TILE_SIZE, TILE_SIZE)
+        .intersected(image.rect());
+    if (area.isEmpty()) {
+        return nullptr;
+    }
+    make(level, area);
+    auto* pixmap = new QPixmap(QPixmap::fromImage(image.copy(area)));
+    const int cost = qMax(1, area.width() * area.height() * 4 / 1024);
+    // On failure the cache deletes the pixmap
+    if (!m_tiles.insert(key, pixmap, cost)) {
+        return nullptr;
+    }
+    return pixmap;
+}
+
+void MipTileCache::dropTiles(int level, const QRect& area)
+{
+    for (int row = area.top() / TILE_SIZE; row <= area.bottom() / TILE_SIZE;
+         ++row) {
+        for (int column = area.left() / TILE_SIZE;
+             column <= area.right() / TILE_SIZE;
+             ++column) {
+            m_tiles.remove(tileKey(level, column, row));
+        }
+    }
+}
@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QCache>
+#include <QImage>
+#include <QList>
+#include <QPixmap>
+#include <QRegion>
+
+class QPainter;
+class QRectF;
+
+/**
+ * @brief Draws the composed capture at any zoom of the viewport.
+ *
+ * The capture is split in tiles of a mip chain, each level half the size of
+ * the one before. A zoomed out view draws the tiles of the level closest to
+ * its scale instead of resampling the whole capture, a zoomed in one only
+ * the tiles it shows. The levels are resampled a tile at a time, when the
+ * tile is first drawn, so the first zoom out doesn't stall on a whole level.
+ * A new frame of the same capture only drops what lies under its changes.
+ */
+class MipTileCache
+{
+public:
+    MipTileCache();
+
+    // Drops the levels and tiles, unless `capture` is the current source
+    void setSource(const QPixmap& capture);
+    // New frame of the source, whose pixels only changed inside `dirty`, in
+    // logical coordinates of the capture
+    void update(const QPixmap& capture, const QRegion& dirty);
+    // Draws the part of the capture inside `visible`, in logical coordinates
+    // of the capture. `scale` is the number of device pixels a pixel of the
+    // capture covers on the screen.
+    void draw(QPainter& painter, const QRectF& visible, qreal scale);
+
+private:
+    const QImage& level(int index);
+    void make(int index, const QRect& area);
+    void resample(int index, const QRect& target);
+    QRect invalidate(int index, const QRect& area);
+    const QPixmap* tile(int level, int column, int row);
+    void dropTiles(int level, const QRect& area);
+
+    QPixmap m_source;
+    // Level 0 is the capture, the others are allocated on first use and
+    // resampled by make()
+    QList<QImage> m_levels;
+    // The resampled parts of each level
+    QList<QRegion> m_made;
+    QCache<quint64, QPixmap> m_tiles;
+};
@@ -0,0 +1,247 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "tilecompositor.h"
+#include "src/tools/annotationrenderer.h"
+#include "src/utils/bufferpool.h"
+#include <QMargins>
+#include <QPainter>
+#include <QSemaphore>
+#include <QThreadPool>
+#include <QVector>
+#include <atomic>
+#include <cstring>
+
+namespace {
+
+// In device pixels, 135 tiles on a 4K capture
+const int TILE_SIZE = 256;
+// Antialiasing and pen joins may reach a little past the bounding rects, same
+// margin as the updates of CaptureWidget
+const int TILE_MARGIN = 20;
+// Pixels around its bounding rect an effect may read, in device pixels
+const int EFFECT_FRINGE = 2;
+
+// Paints a run of annotations without effects, tile by tile. Each thread
+// takes the next tile until none is left.
+class Job
+{
+public:
+    Job(QImage& canvas,
+        const QList<Annotation>& annotations,
+        int begin,
+        int end)
+      : m_annotations(annotations)
+      , m_bits(canvas.bits())
+      , m_bytesPerLine(canvas.bytesPerLine())
+      , m_format(canvas.format())
+      , m_ratio(canvas.devicePixelRatio())
+      , m_width(canvas.width())
+      , m_height(canvas.height())
+      , m_columns((m_width + TILE_SIZE - 1) / TILE_SIZE)
+      , m_rows((m_height + TILE_SIZE - 1) / TILE_SIZE)
+      , m_bins(m_columns * m_rows)
+    {
+        for (int i = begin; i < end; ++i) {
+            bin(i);
+        }
+    }
+
+    int tileCount() const { return m_bins.size(); }
+
+    void work()
+    {
+        for (int t = m_nextTile++; t < m_bins.size(); t = m_nextTile++) {
+            paintTile(t);
+        }
+    }
+
+private:
+    void bin(int index)
+    {
+        const QRect bounds =
+          AnnotationRenderer::boundingRect(m_annotations.at(index));
+        // What has no size may still paint a dot, it goes everywhere
+        QRect area(0, 0, m_width, m_height);
+        if (!bounds.isEmpty()) {
+            const QRect padded = bounds + QMargins(TILE_MARGIN,
+                                                   TILE_MARGIN,
+                                                   TILE_MARGIN,
+                                                   TILE_MARGIN);
+            area = QRectF(QPointF(padded.topLeft()) * m_ratio,
+                          QSizeF(padded.size()) * m_ratio)
+                     .toAlignedRect()
+                     .intersected(area);
+        }
+        if (area.isEmpty()) {
+            return;
+        }
+        for (int row = area.top() / TILE_SIZE;
+             row <= area.bottom() / TILE_SIZE;
+             ++row) {
+            for (int column = area.left() / TILE_SIZE;
+                 column <= area.right() / TILE_SIZE;
+                 ++column) {
+                m_bins[row * m_columns + column].append(index);
+            }
+        }
+    }
+
+    void paintTile(int t)
+    {
+        const QVector<int>& bin = m_bins.at(t);
+        if (bin.isEmpty()) {
+            return;
+        }
+        const int x = (t % m_columns) * TILE_SIZE;
+        const int y = (t / m_columns) * TILE_SIZE;
+        const int width = qMin(TILE_SIZE, m_width - x);
+        const int height = qMin(TILE_SIZE, m_height - y);
+
+        // A view on the pixels of the tile, the tiles don't overlap so the
+        // threads never write the same pixel. QImage::scanLine() would
+        // detach.
+        QImage tile(m_bits + y * m_bytesPerLine + x * 4,
+                    width,
+                    height,
+                    m_bytesPerLine,
+                    m_format);
+        tile.setDevicePixelRatio(m_ratio);
+
+        QPainter painter(&tile);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.translate(-x / m_ratio, -y / m_ratio);
+        for (const int index : bin) {
+            AnnotationRenderer::render(
+              painter, QImage(), m_annotations.at(index));
+        }
+    }
+
+    const QList<Annotation>& m_annotations;
+    uchar* m_bits;
+    qsizetype m_bytesPerLine;
+    QImage::Format m_format;
+    qreal m_ratio;
+    int m_width;
+    int m_height;
+    int m_columns;
+    int m_rows;
+    // Indexes of the annotations touching each tile, in order
+    QVector<QVector<int>> m_bins;
+    std::atomic<int> m_nextTile{ 0 };
+};
+
+void composeRun(QImage& canvas,
+                const QList<Annotation>& annotations,
+                int begin,
+                int end,
+                int threads)
+{
+    Job job(canvas, annotations, begin, end);
+
+    // Same scheme as the resampler: helpers only start on idle threads and
+    // this thread works too
+    QThreadPool* pool = QThreadPool::globalInstance();
+    QSemaphore finished;
+    int helpers = 0;
+    const int maxThreads = threads > 0 ? qMin(threads, pool->maxThreadCount())
+                                       : pool->maxThreadCount();
+    const int wanted = qMin(maxThreads, job.tileCount()) - 1;
+    for (int i = 0; i < wanted; ++i) {
+        const bool started = pool->tryStart([&job, &finished]() {
+            job.work();
+            finished.release();
+        });
+        if (!started) {
+            break;
+        }
+        ++helpers;
+    }
+    job.work();
+    finished.acquire(helpers);
+}
+
+// The pixels an effect reads, copied out of the canvas. Only its area and a
+// margin for the fringe it samples are copied, the rest of the image is left
+// uninitialized.
+QImage effectInput(const QImage& canvas, const Annotation& annotation)
+{
+    QImage input =
+      BufferPool::instance()->image(canvas.size(), canvas.format());
+    input.setDevicePixelRatio(canvas.devicePixelRatio());
+    const QRect bounds = AnnotationRenderer::boundingRect(annotation);
+    const QRect area =
+      QRectF(QPointF(bounds.topLeft()) * canvas.devicePixelRatio(),
+             QSizeF(bounds.size()) * canvas.devicePixelRatio())
+        .toAlignedRect()
+        .adjusted(-EFFECT_FRINGE, -EFFECT_FRINGE, EFFECT_FRINGE, EFFECT_FRINGE)
+        .intersected(canvas.rect());
+    for (int y = area.top(); y <= area.bottom(); ++y) {
+        std::memcpy(input.scanLine(y) + area.x() * 4,
+                    canvas.constScanLine(y) + area.x() * 4,
+                    size_t(area.width()) * 4);
+    }
+    return input;
+}
+
+} // unnamed namespace
+
+namespace TileCompositor {
+
+QImage compose(const QImage& base,
+               const QList<Annotation>& annotations,
+               int threads)
+{
+    // The tiles are painted through views on 32-bit pixels
+    QImage canvas = base;
+    const bool converted =
+      canvas.format() != QImage::Format_RGB32 &&
+      canvas.format() != QImage::Format_ARGB32_Premultiplied;
+    if (converted) {
+        canvas = canvas.convertToFormat(canvas.hasAlphaChannel()
+                                          ? QImage::Format_ARGB32_Premultiplied
+                                          : QImage::Format_RGB32);
+    }
+    if (annotations.isEmpty() || canvas.isNull()) {
+        return canvas;
+    }
+    // The jobs write through the raw pixels of an unshared canvas. Every
+    // frame takes one, the pool reuses the buffers of the previous frames.
+    if (!converted) {
+        canvas = BufferPool::instance()->copy(canvas);
+    }
+
+    int begin = 0;
+    for (int i = 0; i <= annotations.size(); ++i) {
+        const bool effect = i < annotations.size() &&
+                            AnnotationRenderer::readsBackground(annotations[i]);
+        if (i < annotations.size() && !effect) {
+            continue;
+        }
+        if (begin < i) {
+            composeRun(canvas, annotations, begin, i, threads);
+        }
+        if (effect &&
+            !AnnotationRenderer::renderInPlace(canvas, annotations[i])) {
+            // The painter must not write the pixels the effect reads
+            const QImage input = effectInput(canvas, annotations[i]);
+            QPainter painter(&canvas);
+            painter.setRenderHint(QPainter::Antialiasing);
+            AnnotationRenderer::render(painter, input, annotations[i]);
+        }
+        begin = i + 1;
+    }
+    return canvas;
+}
+
+QPixmap compose(const QPixmap& base,
+                const QList<Annotation>& annotations,
+                int threads)
+{
+    if (annotations.isEmpty()) {
+        return base;
+    }
+    return QPixmap::fromImage(compose(base.toImage(), annotations, threads));
+}
+
+} // namespace TileCompositor
@@ -0,0 +1,31 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "src/tools/annotation.h"
+#include <QImage>
+#include <QList>
+#include <QPixmap>
+
+// Draws all the annotations of a capture at once, for the full recomposites
+// after undo, redo or a change of the objects. The canvas is split into fixed
+// tiles, each annotation is binned into the tiles its bounding rect touches,
+// and the tiles are painted in parallel on the global thread pool, keeping the
+// order of the annotations within each tile.
+//
+// Effects reading what is under them (AnnotationRenderer::readsBackground)
+// are drawn on the whole canvas in between, once the annotations before them
+// are drawn in every tile.
+namespace TileCompositor {
+
+// `threads` limits the number of threads painting tiles, all the idle
+// threads of the pool are used when it is 0
+QImage compose(const QImage& base,
+               const QList<Annotation>& annotations,
+               int threads = 0);
+QPixmap compose(const QPixmap& base,
+                const QList<Annotation>& annotations,
+                int threads = 0);
+
+} // namespace TileCompositor
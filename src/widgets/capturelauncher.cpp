@@ -11,6 +11,12 @@
 #include "src/utils/screenshotsaver.h"
 #include "src/widgets/imagelabel.h"
 #include <QMimeData>
+#include <QTimer>
+
+namespace {
+// Time for the compositor to drop the launcher from the screen
+constexpr int PREVIEW_HIDE_DELAY_MS = 100;
+} // unnamed namespace
 
 // https://github.com/KDE/spectacle/blob/941c1a517be82bed25d1254ebd735c29b0d2951c/src/Gui/KSWidget.cpp
 // https://github.com/KDE/spectacle/blob/941c1a517be82bed25d1254ebd735c29b0d2951c/src/Gui/KSMainWindow.cpp
@@ -23,9 +29,10 @@ CaptureLauncher::CaptureLauncher(QDialog* parent)
     ui->setupUi(this);
     setAttribute(Qt::WA_DeleteOnClose);
     setWindowIcon(QIcon(GlobalValues::iconPath()));
-    bool ok;
 
-    ui->imagePreview->setScreenshot(ScreenGrabber().grabEntireDesktop(ok));
+    // The preview is only a thumbnail, a new capture is taken anyway
+    ui->imagePreview->setKeepFullResolution(false);
+    ui->imagePreview->setText(tr("Taking a screenshot..."));
     ui->imagePreview->setSizePolicy(QSizePolicy::Expanding,
                                     QSizePolicy::Expanding);
 
@@ -93,6 +100,22 @@ CaptureLauncher::CaptureLauncher(QDialog* parent)
     QScreen* screen = QGuiAppCurrentScreen().currentScreen();
     position.moveCenter(screen->availableGeometry().center());
     move(position.topLeft());
+
+    // Grab the preview once the window is up instead of delaying it. The
+    // launcher is made transparent for the grab so it isn't in the preview.
+    QTimer::singleShot(0, this, [this]() {
+        setWindowOpacity(0.0);
+        QTimer::singleShot(PREVIEW_HIDE_DELAY_MS, this, [this]() {
+            bool ok = true;
+            QPixmap screenshot = ScreenGrabber().grabEntireDesktop(ok);
+            setWindowOpacity(1.0);
+            if (ok) {
+                ui->imagePreview->setScreenshot(screenshot);
+            } else {
+                ui->imagePreview->setText(tr("Preview unavailable"));
+            }
+        });
+    });
 }
 
 // HACK:
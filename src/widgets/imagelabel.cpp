@@ -5,10 +5,70 @@
 // /src/Gui/KSImageWidget.cpp commit cbbd6d45f6426ccbf1a82b15fdf98613ccccbbe9
 
 #include "imagelabel.h"
+#include "src/utils/resampler.h"
+#include <QMetaObject>
+#include <QPointer>
+#include <QThreadPool>
+
+namespace {
+// The chain stops once a level is about the size of a thumbnail
+constexpr int MIN_MIP_SIZE = 128;
+
+// Average 2x2 blocks of premultiplied pixels. The channels are summed two at
+// a time inside a 32 bit word, which the compiler turns into vector code.
+QImage halveImage(const QImage& src)
+{
+    const int width = qMax(1, src.width() / 2);
+    const int height = qMax(1, src.height() / 2);
+    QImage dst(width, height, QImage::Format_ARGB32_Premultiplied);
+    const int lastX = src.width() - 1;
+    const int lastY = src.height() - 1;
+
+    for (int y = 0; y < height; ++y) {
+        const auto* row0 =
+          reinterpret_cast<const quint32*>(src.constScanLine(2 * y));
+        const auto* row1 = reinterpret_cast<const quint32*>(
+          src.constScanLine(qMin(2 * y + 1, lastY)));
+        auto* out = reinterpret_cast<quint32*>(dst.scanLine(y));
+        for (int x = 0; x < width; ++x) {
+            const int x0 = 2 * x;
+            const int x1 = qMin(x0 + 1, lastX);
+            const quint32 p[4] = { row0[x0], row0[x1], row1[x0], row1[x1] };
+            quint32 rb = 0x00020002;
+            quint32 ag = 0x00020002;
+            for (quint32 pixel : p) {
+                rb += pixel & 0x00ff00ff;
+                ag += (pixel >> 8) & 0x00ff00ff;
+            }
+            out[x] = ((rb >> 2) & 0x00ff00ff) | (((ag >> 2) & 0x00ff00ff) << 8);
+        }
+    }
+    return dst;
+}
+
+QList<QImage> buildMipChain(const QImage& image, bool keepFullResolution)
+{
+    QList<QImage> mips;
+    QImage level = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    if (keepFullResolution) {
+        mips.append(level);
+    }
+    while (qMax(level.width(), level.height()) > MIN_MIP_SIZE) {
+        level = halveImage(level);
+        mips.append(level);
+    }
+    if (mips.isEmpty()) {
+        // Too small to be downscaled at all
+        mips.append(level);
+    }
+    return mips;
+}
+} // unnamed namespace
 
 ImageLabel::ImageLabel(QWidget* parent)
   : QLabel(parent)
-  , m_pixmap(QPixmap())
+  , m_generation(0)
+  , m_keepFullResolution(true)
 {
     m_DSEffect = new QGraphicsDropShadowEffect(this);
 
@@ -22,20 +82,76 @@ ImageLabel::ImageLabel(QWidget* parent)
     setMinimumSize(size());
 }
 
+/**
+ * @brief Show a screenshot. The previews are computed in the background, the
+ * label keeps its current content until they are ready.
+ */
 void ImageLabel::setScreenshot(const QPixmap& pixmap)
 {
-    m_pixmap = pixmap;
-    const QString tooltip =
-      QStringLiteral("%1x%2 px").arg(m_pixmap.width(), m_pixmap.height());
+    m_sourceSize = pixmap.size();
+    const QString tooltip = QStringLiteral("%1x%2 px")
+                              .arg(m_sourceSize.width())
+                              .arg(m_sourceSize.height());
     setToolTip(tooltip);
+
+    const quint64 generation = ++m_generation;
+    const bool keepFullResolution = m_keepFullResolution;
+    QPointer<ImageLabel> label(this);
+    QImage image = pixmap.toImage();
+    QThreadPool::globalInstance()->start(
+      [label, image, generation, keepFullResolution]() {
+          QList<QImage> mips = buildMipChain(image, keepFullResolution);
+          QMetaObject::invokeMethod(
+            qApp,
+            [label, mips, generation]() {
+                if (label) {
+                    label->setMipChain(mips, generation);
+                }
+            },
+            Qt::QueuedConnection);
+      });
+}
+
+/**
+ * @brief Whether the screenshot is kept at full resolution. Without it the
+ * preview never goes above half the size of the screenshot, which is enough
+ * when the label is smaller than a screen.
+ */
+void ImageLabel::setKeepFullResolution(bool keep)
+{
+    m_keepFullResolution = keep;
+}
+
+void ImageLabel::setMipChain(const QList<QImage>& mips, quint64 generation)
+{
+    if (generation != m_generation) {
+        return;
+    }
+    m_mips = mips;
     setScaledPixmap();
 }
 
 void ImageLabel::setScaledPixmap()
 {
-    const qreal scale = qApp->devicePixelRatio();
-    QPixmap scaledPixmap = m_pixmap.scaled(
-      size() * scale, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    if (m_mips.isEmpty()) {
+        return;
+    }
+    const qreal scale = devicePixelRatioF();
+    const QSize target =
+      m_sourceSize.scaled(size() * scale, Qt::KeepAspectRatio);
+
+    // Scale down from the smallest level that is still large enough
+    const QImage* source = &m_mips.first();
+    for (const QImage& level : m_mips) {
+        if (level.width() < target.width() ||
+            level.height() < target.height()) {
+            break;
+        }
+        source = &level;
+    }
+
+    QPixmap scaledPixmap =
+      QPixmap::fromImage(Resampler::resize(*source, target));
     scaledPixmap.setDevicePixelRatio(scale);
     setPixmap(scaledPixmap);
 }
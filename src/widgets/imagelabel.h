@@ -9,10 +9,13 @@
 #include <QColor>
 #include <QGraphicsDropShadowEffect>
 #include <QGuiApplication>
+#include <QImage>
 #include <QLabel>
+#include <QList>
 #include <QMouseEvent>
 #include <QPixmap>
 #include <QPoint>
+#include <QSize>
 #include <QStyleHints>
 
 class ImageLabel : public QLabel
@@ -22,6 +25,7 @@ class ImageLabel : public QLabel
 public:
     explicit ImageLabel(QWidget* parent = nullptr);
     void setScreenshot(const QPixmap& pixmap);
+    void setKeepFullResolution(bool keep);
 
 signals:
     void dragInitiated();
@@ -33,9 +37,17 @@ protected:
     void resizeEvent(QResizeEvent* event) Q_DECL_OVERRIDE;
 
 private:
+    void setMipChain(const QList<QImage>& mips, quint64 generation);
     void setScaledPixmap();
 
     QGraphicsDropShadowEffect* m_DSEffect;
-    QPixmap m_pixmap;
+    // Downscaled copies of the screenshot, each half the size of the
+    // previous one. The first level is the screenshot itself unless
+    // m_keepFullResolution is false.
+    QList<QImage> m_mips;
+    QSize m_sourceSize;
+    // Incremented by setScreenshot() so that stale mip chains are dropped
+    quint64 m_generation;
+    bool m_keepFullResolution;
     QPoint m_dragStartPosition;
 };
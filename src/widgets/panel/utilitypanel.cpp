@@ -3,6 +3,8 @@
 
 #include "utilitypanel.h"
 #include "capturewidget.h"
+#include "src/tools/annotationrenderer.h"
+#include "src/tools/iconatlas.h"
 #include <QHBoxLayout>
 #include <QListWidget>
 #include <QPropertyAnimation>
@@ -198,16 +200,20 @@ void UtilityPanel::initInternalPanel()
     m_bottomLayout->addWidget(closeButton);
 }
 
-void UtilityPanel::fillCaptureTools(
-  const QList<QPointer<CaptureTool>>& captureToolObjects)
+void UtilityPanel::fillCaptureTools(const QList<Annotation>& annotations)
 {
     int currentSelection = m_captureTools->currentRow();
     m_captureTools->clear();
     m_captureTools->addItem(tr("<Empty>"));
 
-    for (auto toolItem : captureToolObjects) {
-        auto* item = new QListWidgetItem(
-          toolItem->icon(QColor(Qt::white), false), toolItem->info());
+    for (const auto& annotation : annotations) {
+        QIcon icon =
+          IconAtlas::instance()->icon(AnnotationRenderer::toolType(annotation),
+                                      QColor(Qt::white),
+                                      IconAtlas::panelIconSize(),
+                                      devicePixelRatioF());
+        auto* item =
+          new QListWidgetItem(icon, AnnotationRenderer::label(annotation));
         m_captureTools->addItem(item);
     }
     if (currentSelection >= 0 && currentSelection < m_captureTools->count()) {
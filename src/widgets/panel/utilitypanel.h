@@ -3,7 +3,7 @@
 
 #pragma once
 
-#include "src/tools/capturetool.h"
+#include "src/tools/annotation.h"
 #include <QPointer>
 #include <QWidget>
 
@@ -25,8 +25,7 @@ public:
     void setToolWidget(QWidget* weight);
     void clearToolWidget();
     void pushWidget(QWidget* widget);
-    void fillCaptureTools(
-      const QList<QPointer<CaptureTool>>& captureToolObjectsHistory);
+    void fillCaptureTools(const QList<Annotation>& annotations);
     void setActiveLayer(int index);
     int activeLayerIndex();
     bool isVisible() const;
@@ -0,0 +1,202 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "scrollcapturewidget.h"
+#include "src/utils/abstractlogger.h"
+#include "src/utils/confighandler.h"
+#include "src/utils/globalvalues.h"
+#include "src/utils/screengrabber.h"
+#include <QCloseEvent>
+#include <QGuiApplication>
+#include <QHBoxLayout>
+#include <QKeyEvent>
+#include <QLabel>
+#include <QPushButton>
+#include <QScreen>
+#include <QTimer>
+
+namespace {
+// ~30 frames per second
+const int GRAB_INTERVAL_MS = 33;
+// Let the capture window disappear before the first frame
+const int FIRST_GRAB_DELAY_MS = 250;
+const int OUTLINE_WIDTH = 2;
+const int CONTROLS_SPACING = 8;
+} // unnamed namespace
+
+ScrollCaptureWidget::ScrollCaptureWidget(const QRect& region, QWidget* parent)
+  : QWidget(parent)
+  , m_region(region)
+  , m_grabber(new ScreenGrabber(this))
+  , m_devicePixelRatio(1.0)
+  , m_done(false)
+  , m_timer(new QTimer(this))
+  , m_status(new QLabel(this))
+{
+    setAttribute(Qt::WA_DeleteOnClose);
+    setWindowFlags(Qt::Window | Qt::WindowStaysOnTopHint);
+    setWindowIcon(QIcon(GlobalValues::iconPath()));
+    setWindowTitle(tr("Scrolling Capture"));
+
+    auto* layout = new QHBoxLayout(this);
+    m_status->setText(tr("Scroll the content of the selection"));
+    layout->addWidget(m_status);
+
+    auto* doneButton = new QPushButton(tr("Done"), this);
+    doneButton->setDefault(true);
+    connect(
+      doneButton, &QPushButton::clicked, this, &ScrollCaptureWidget::finish);
+    layout->addWidget(doneButton);
+
+    auto* cancelButton = new QPushButton(tr("Cancel"), this);
+    connect(cancelButton, &QPushButton::clicked, this, &QWidget::close);
+    layout->addWidget(cancelButton);
+
+    initOutline();
+    adjustSize();
+    placeControls();
+
+    m_timer->setInterval(GRAB_INTERVAL_MS);
+    connect(m_timer, &QTimer::timeout, this, &ScrollCaptureWidget::grabFrame);
+    QTimer::singleShot(FIRST_GRAB_DELAY_MS, m_timer, [this]() {
+        if (!m_done) {
+            m_timer->start();
+        }
+    });
+}
+
+ScrollCaptureWidget::~ScrollCaptureWidget()
+{
+    delete m_outline;
+}
+
+void ScrollCaptureWidget::keyPressEvent(QKeyEvent* event)
+{
+    if (event->key() == Qt::Key_Escape) {
+        close();
+    } else if (event->key() == Qt::Key_Return ||
+               event->key() == Qt::Key_Enter) {
+        finish();
+    } else {
+        QWidget::keyPressEvent(event);
+    }
+}
+
+void ScrollCaptureWidget::closeEvent(QCloseEvent* event)
+{
+    m_timer->stop();
+    if (!m_done) {
+        m_done = true;
+        emit canceled();
+    }
+    QWidget::closeEvent(event);
+}
+
+void ScrollCaptureWidget::grabFrame()
+{
+    bool ok = true;
+    QPixmap frame = m_grabber->grabRegion(m_region, ok);
+    if (!ok) {
+        m_timer->stop();
+        AbstractLogger::error()
+          << tr("Scrolling capture is not supported on this platform");
+        close();
+        return;
+    }
+
+    switch (m_stitcher.append(frame.toImage())) {
+        case ScrollStitcher::FIRST_FRAME:
+            m_devicePixelRatio = frame.devicePixelRatio();
+            [[fallthrough]];
+        case ScrollStitcher::APPENDED:
+            m_status->setText(tr("Captured %1 rows, keep scrolling")
+                                .arg(m_stitcher.image().height()));
+            break;
+        case ScrollStitcher::NO_MATCH:
+            m_status->setText(tr("Scrolled too fast, scroll back up a little"));
+            break;
+        case ScrollStitcher::NO_MOVEMENT:
+            break;
+    }
+}
+
+void ScrollCaptureWidget::finish()
+{
+    if (m_done) {
+        return;
+    }
+    m_timer->stop();
+    const TiledImage& stitched = m_stitcher.image();
+    if (stitched.isEmpty()) {
+        close();
+        return;
+    }
+
+    int height = stitched.height();
+    if (height > stitched.maxImageHeight()) {
+        height = stitched.maxImageHeight();
+        AbstractLogger::warning()
+          << tr("The scrolling capture is too long to be saved as one image, "
+                "it was cut after %1 rows")
+               .arg(height);
+    }
+    QPixmap capture = QPixmap::fromImage(stitched.copy(0, height));
+    capture.setDevicePixelRatio(m_devicePixelRatio);
+
+    m_done = true;
+    hide();
+    if (m_outline) {
+        m_outline->hide();
+    }
+    emit finished(capture);
+    close();
+}
+
+/**
+ * @brief Show a border around the region. The window is transparent to the
+ * mouse so the content below can be scrolled.
+ */
+void ScrollCaptureWidget::initOutline()
+{
+    m_outline = new QWidget(nullptr,
+                            Qt::FramelessWindowHint | Qt::Tool |
+                              Qt::WindowStaysOnTopHint |
+                              Qt::WindowTransparentForInput |
+                              Qt::WindowDoesNotAcceptFocus);
+    const QRect outer = m_region.adjusted(
+      -OUTLINE_WIDTH, -OUTLINE_WIDTH, OUTLINE_WIDTH, OUTLINE_WIDTH);
+    m_outline->setGeometry(outer);
+    m_outline->setStyleSheet(
+      QStringLiteral("background-color: %1")
+        .arg(ConfigHandler().uiColor().name()));
+    // Only the border is part of the window, it must not be captured
+    QRegion border(QRect(QPoint(0, 0), outer.size()));
+    border -= QRegion(
+      QRect(OUTLINE_WIDTH, OUTLINE_WIDTH, m_region.width(), m_region.height()));
+    m_outline->setMask(border);
+    m_outline->show();
+}
+
+void ScrollCaptureWidget::placeControls()
+{
+    QScreen* screen = QGuiApplication::screenAt(m_region.center());
+    if (screen == nullptr) {
+        screen = QGuiApplication::primaryScreen();
+    }
+    const QRect available = screen->availableGeometry();
+    const QSize size = frameGeometry().size();
+
+    // Below the region, else above it, else in the corner of the screen
+    QPoint pos(m_region.left(),
+               m_region.bottom() + OUTLINE_WIDTH + CONTROLS_SPACING);
+    if (pos.y() + size.height() > available.bottom()) {
+        pos.setY(m_region.top() - OUTLINE_WIDTH - CONTROLS_SPACING -
+                 size.height());
+    }
+    if (pos.y() < available.top()) {
+        pos = available.topLeft();
+    }
+    pos.setX(
+      qBound(available.left(), pos.x(), available.right() - size.width()));
+    move(pos);
+}
@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "src/utils/scrollstitcher.h"
+#include <QPixmap>
+#include <QPointer>
+#include <QWidget>
+
+class QLabel;
+class QTimer;
+class ScreenGrabber;
+
+/**
+ * @brief Controls of a scrolling capture.
+ *
+ * Grabs the region repeatedly while the user scrolls the content under it
+ * and stitches the frames into one long capture. The region is outlined by
+ * a window that lets the input through; the controls are placed next to it
+ * so they are not captured.
+ */
+class ScrollCaptureWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit ScrollCaptureWidget(const QRect& region,
+                                 QWidget* parent = nullptr);
+    ~ScrollCaptureWidget() override;
+
+signals:
+    void finished(const QPixmap& capture);
+    void canceled();
+
+protected:
+    void keyPressEvent(QKeyEvent* event) override;
+    void closeEvent(QCloseEvent* event) override;
+
+private slots:
+    void grabFrame();
+    void finish();
+
+private:
+    void initOutline();
+    void placeControls();
+
+    QRect m_region;
+    ScreenGrabber* m_grabber;
+    ScrollStitcher m_stitcher;
+    qreal m_devicePixelRatio;
+    bool m_done;
+
+    QTimer* m_timer;
+    QLabel* m_status;
+    QPointer<QWidget> m_outline;
+};
@@ -73,9 +73,9 @@ void UploadHistory::addLine(const QString& path, const QString& fileName)
 
     QString url = ImgUploaderManager(this).url() + unpackFileName.file;
 
-    // load pixmap
+    // load pixmap, the format is detected as the cache has QOI and PNG files
     QPixmap pixmap;
-    pixmap.load(fullFileName, "png");
+    pixmap.load(fullFileName);
     scaleThumbnail(pixmap);
 
     // get file info
@@ -81,6 +81,10 @@ do
     cmd flameshot "$subcommand" --path /tmp/
     cmd flameshot "$subcommand" --clipboard
     cmd command "$FLAMESHOT" "$subcommand" --raw | display_img
+    for format in ppm pam farbfeld
+    do
+        cmd command "$FLAMESHOT" "$subcommand" --raw-format "$format" | display_img
+    done
     [ "$subcommand" = "full" ] && sleep 1
     echo
 done
@@ -0,0 +1,47 @@
+#!/usr/bin/env sh
+
+# Benchmark of the palette PNG output (savePalettePng)
+# Arguments:
+# 1. path to tested flameshot executable
+# 2. number of captures per setting (default 5)
+
+# Dependencies:
+# - a running graphical session, without a flameshot daemon
+# - identify command (imagemagick)
+
+# HOW TO USE:
+# - Show something with few colors (a terminal, a dialog...) and start the
+#   script. The screen is captured with the option disabled then enabled,
+#   using a temporary configuration.
+#
+# - The time of each capture, the file size and the PNG color type are
+#   printed. Color type 3 is a palette PNG, 2 and 6 are RGB(A).
+
+FLAMESHOT="$1"
+[ -z "$FLAMESHOT" ] && FLAMESHOT="flameshot"
+RUNS="$2"
+[ -z "$RUNS" ] && RUNS=5
+
+OUT=/tmp/flameshot_palette_test
+rm -rf "$OUT" 2>/dev/null
+mkdir -p "$OUT/config/flameshot"
+export XDG_CONFIG_HOME="$OUT/config"
+
+bench() {
+    setting="$1"
+    printf '[General]\nsavePalettePng=%s\n' "$setting" \
+        >"$OUT/config/flameshot/flameshot.ini"
+    echo ">> savePalettePng=$setting"
+    for run in $(seq "$RUNS"); do
+        file="$OUT/$setting-$run.png"
+        start=$(date +%s%N)
+        "$FLAMESHOT" screen -p "$file"
+        end=$(date +%s%N)
+        bytes=$(wc -c <"$file" 2>/dev/null)
+        type=$(identify -format '%[png:IHDR.color-type-orig]' "$file" 2>/dev/null)
+        echo "   $(( (end - start) / 1000000 )) ms, $bytes bytes, color type $type"
+    done
+}
+
+bench false
+bench true
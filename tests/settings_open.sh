@@ -0,0 +1,46 @@
+#!/usr/bin/env sh
+
+# Benchmark of opening the configuration window (flameshot config)
+# Arguments:
+# 1. path to tested flameshot executable
+# 2. number of runs (default 5)
+
+# Dependencies:
+# - a running X11 session (or XWayland), without a flameshot daemon
+# - xdotool
+
+# HOW TO USE:
+# - Start the script. The configuration window is opened and closed once per
+#   run, using a temporary configuration.
+#
+# - The time from starting the process until the window is visible is
+#   printed. The pages of the window are built when their tab is first shown,
+#   so this includes building the General page only.
+#
+# - A daemon started with the metricsSocket option also records the time
+#   from construction of the window until its first page is painted, as
+#   flameshot_stage_duration_seconds{stage="settings_open"}.
+
+FLAMESHOT="$1"
+[ -z "$FLAMESHOT" ] && FLAMESHOT="flameshot"
+RUNS="$2"
+[ -z "$RUNS" ] && RUNS=5
+
+OUT=/tmp/flameshot_settings_test
+rm -rf "$OUT" 2>/dev/null
+mkdir -p "$OUT/config/flameshot"
+export XDG_CONFIG_HOME="$OUT/config"
+printf '[General]\nshowStartupLaunchMessage=false\n' \
+    >"$OUT/config/flameshot/flameshot.ini"
+
+for run in $(seq "$RUNS"); do
+    start=$(date +%s%N)
+    "$FLAMESHOT" config &
+    pid=$!
+    window=$(xdotool search --sync --onlyvisible --pid "$pid" \
+        --name "Configuration" | head -n 1)
+    end=$(date +%s%N)
+    echo "   $(( (end - start) / 1000000 )) ms"
+    xdotool windowclose "$window" 2>/dev/null || kill "$pid"
+    wait "$pid"
+done
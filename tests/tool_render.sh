@@ -0,0 +1,58 @@
+#!/usr/bin/env sh
+
+# Golden image check of the drawing tools
+# Arguments:
+# 1. path to tested flameshot executable, built with
+#    -DFLAMESHOT_RENDER_CHECK=ON (or -DFLAMESHOT_DEBUG_CAPTURE=ON)
+# 2. "--update" to write the reference images instead of comparing them
+
+# Dependencies:
+# - the DejaVu Sans font, used by the text tool
+
+# HOW TO USE:
+# - Start the script with path to tested flameshot executable as the first
+#   argument, or run ctest in a build with -DFLAMESHOT_RENDER_CHECK=ON. No
+#   graphical session is needed, Qt renders offscreen.
+#
+# - Every tool is drawn with fixed parameters at a device pixel ratio of 1,
+#   1.25 and 2, and compared with the images in tests/golden/tools. Each line
+#   gives the result and the median time of the render. Images of the failed
+#   checks are written to the temporary directory for a visual comparison.
+#
+# - A full recomposite of a 4K capture with 200 objects is then compared
+#   between the serial painter and the tile compositor, which is timed with a
+#   growing number of threads.
+#
+# - Last, each blend kernel is run on a 4K frame with every instruction set
+#   the CPU supports. The results must equal the scalar one exactly.
+#
+# - After an intended change of the output, run the script with --update on
+#   the reference build and commit the new images. Without any reference
+#   image the renders are only timed, the composition and the kernels are
+#   still checked.
+
+FLAMESHOT="$1"
+[ -z "$FLAMESHOT" ] && FLAMESHOT="flameshot"
+GOLDEN="$(dirname "$0")/golden/tools"
+
+OUT=/tmp/flameshot_render_test
+rm -rf "$OUT" 2>/dev/null
+mkdir -p "$OUT/config"
+
+# Default settings, whatever the user configured
+export XDG_CONFIG_HOME="$OUT/config"
+export QT_QPA_PLATFORM=offscreen
+
+if [ "$2" = "--update" ]; then
+    "$FLAMESHOT" render-check "$GOLDEN" --update
+else
+    "$FLAMESHOT" render-check "$GOLDEN"
+fi
+STATUS=$?
+
+if [ $STATUS -eq 0 ]; then
+    echo "All checks passed"
+else
+    echo "Some renders or checks failed"
+fi
+exit $STATUS
@@ -0,0 +1,88 @@
+#!/usr/bin/env sh
+
+# Tests for the native wlr-screencopy capture backend
+# Arguments:
+# 1. path to tested flameshot executable, built with -DUSE_WLR_SCREENCOPY=ON
+
+# Dependencies:
+# - sway (started with the headless wlroots backend)
+# - identify command (imagemagick)
+
+# HOW TO USE:
+# - Start the script with path to tested flameshot executable as the first
+#   argument. No running graphical session is needed, the script starts its
+#   own headless sway instance with two outputs of different scale.
+#
+# - Each capture is checked for the expected image size and the time it took
+#   is printed. Without grim installed the captures can only succeed through
+#   the native backend.
+
+FLAMESHOT="$1"
+[ -z "$FLAMESHOT" ] && FLAMESHOT="flameshot"
+
+OUT=/tmp/flameshot_wlr_test
+rm -rf "$OUT" 2>/dev/null
+mkdir -p "$OUT"
+
+export XDG_RUNTIME_DIR="$OUT/runtime"
+mkdir -p -m 0700 "$XDG_RUNTIME_DIR"
+export WLR_BACKENDS=headless
+export WLR_LIBINPUT_NO_DEVICES=1
+export WLR_HEADLESS_OUTPUTS=2
+export XDG_CURRENT_DESKTOP=sway
+export XDG_SESSION_TYPE=wayland
+export QT_QPA_PLATFORM=wayland
+
+cat >"$OUT/sway.conf" <<SWAYCONF
+output HEADLESS-1 resolution 1920x1080 position 0 0 scale 1
+output HEADLESS-2 resolution 1920x1080 position 1920 0 scale 2
+SWAYCONF
+
+sway -c "$OUT/sway.conf" >"$OUT/sway.log" 2>&1 &
+SWAY_PID=$!
+trap 'kill $SWAY_PID 2>/dev/null' EXIT
+
+# Wait for the compositor socket
+for _ in $(seq 50); do
+    WAYLAND_DISPLAY=$(find "$XDG_RUNTIME_DIR" -maxdepth 1 -name 'wayland-*' \
+        ! -name '*.lock' -printf '%f\n' | head -n 1)
+    [ -n "$WAYLAND_DISPLAY" ] && break
+    sleep 0.1
+done
+if [ -z "$WAYLAND_DISPLAY" ]; then
+    echo "!! sway did not start, see $OUT/sway.log"
+    exit 1
+fi
+export WAYLAND_DISPLAY
+
+"$FLAMESHOT" &
+sleep 2
+
+FAILED=0
+
+# Print the given command, run it and report how long it took
+capture() {
+    expected="$1"
+    shift
+    echo ">> $*"
+    start=$(date +%s%N)
+    "$FLAMESHOT" "$@"
+    end=$(date +%s%N)
+    file=$(ls -t "$OUT"/*.png 2>/dev/null | head -n 1)
+    size=$(identify -format '%wx%h' "$file" 2>/dev/null)
+    echo "   $(( (end - start) / 1000000 )) ms, $size"
+    if [ "$size" != "$expected" ]; then
+        echo "!! expected $expected"
+        FAILED=1
+    fi
+    rm -f "$OUT"/*.png
+}
+
+# The desktop is 1920 + 960 logical pixels wide, captured at the density of
+# the scale 2 output
+capture 5760x2160 full -p "$OUT"
+capture 1920x1080 screen -n 0 -p "$OUT"
+capture 1920x1080 screen -n 1 -p "$OUT"
+
+pkill -f "$FLAMESHOT" 2>/dev/null
+exit $FAILED